@@ -67,18 +67,30 @@ set(SUNSHINE_TARGET_FILES
         "${CMAKE_SOURCE_DIR}/src/config.cpp"
         "${CMAKE_SOURCE_DIR}/src/display_device.h"
         "${CMAKE_SOURCE_DIR}/src/display_device.cpp"
+        "${CMAKE_SOURCE_DIR}/src/encoder_probe_cache.cpp"
+        "${CMAKE_SOURCE_DIR}/src/encoder_probe_cache.h"
         "${CMAKE_SOURCE_DIR}/src/entry_handler.cpp"
         "${CMAKE_SOURCE_DIR}/src/entry_handler.h"
+        "${CMAKE_SOURCE_DIR}/src/events.cpp"
+        "${CMAKE_SOURCE_DIR}/src/events.h"
         "${CMAKE_SOURCE_DIR}/src/file_handler.cpp"
         "${CMAKE_SOURCE_DIR}/src/file_handler.h"
         "${CMAKE_SOURCE_DIR}/src/globals.cpp"
         "${CMAKE_SOURCE_DIR}/src/globals.h"
+        "${CMAKE_SOURCE_DIR}/src/image_pool.cpp"
+        "${CMAKE_SOURCE_DIR}/src/image_pool.h"
         "${CMAKE_SOURCE_DIR}/src/logging.cpp"
         "${CMAKE_SOURCE_DIR}/src/logging.h"
         "${CMAKE_SOURCE_DIR}/src/main.cpp"
         "${CMAKE_SOURCE_DIR}/src/main.h"
         "${CMAKE_SOURCE_DIR}/src/crypto.cpp"
         "${CMAKE_SOURCE_DIR}/src/crypto.h"
+        "${CMAKE_SOURCE_DIR}/src/app_catalog.cpp"
+        "${CMAKE_SOURCE_DIR}/src/app_catalog.h"
+        "${CMAKE_SOURCE_DIR}/src/asset_cache.cpp"
+        "${CMAKE_SOURCE_DIR}/src/asset_cache.h"
+        "${CMAKE_SOURCE_DIR}/src/thumbnail.cpp"
+        "${CMAKE_SOURCE_DIR}/src/thumbnail.h"
         "${CMAKE_SOURCE_DIR}/src/nvhttp.cpp"
         "${CMAKE_SOURCE_DIR}/src/nvhttp.h"
         "${CMAKE_SOURCE_DIR}/src/httpcommon.cpp"
@@ -88,6 +100,8 @@ set(SUNSHINE_TARGET_FILES
         "${CMAKE_SOURCE_DIR}/src/confighttp.h"
         "${CMAKE_SOURCE_DIR}/src/rtsp.cpp"
         "${CMAKE_SOURCE_DIR}/src/rtsp.h"
+        "${CMAKE_SOURCE_DIR}/src/sse.cpp"
+        "${CMAKE_SOURCE_DIR}/src/sse.h"
         "${CMAKE_SOURCE_DIR}/src/stream.cpp"
         "${CMAKE_SOURCE_DIR}/src/stream.h"
         "${CMAKE_SOURCE_DIR}/src/video.cpp"
@@ -98,6 +112,10 @@ set(SUNSHINE_TARGET_FILES
         "${CMAKE_SOURCE_DIR}/src/input.h"
         "${CMAKE_SOURCE_DIR}/src/audio.cpp"
         "${CMAKE_SOURCE_DIR}/src/audio.h"
+        "${CMAKE_SOURCE_DIR}/src/audio_buffers.cpp"
+        "${CMAKE_SOURCE_DIR}/src/audio_buffers.h"
+        "${CMAKE_SOURCE_DIR}/src/audio_drift.cpp"
+        "${CMAKE_SOURCE_DIR}/src/audio_drift.h"
         "${CMAKE_SOURCE_DIR}/src/platform/common.h"
         "${CMAKE_SOURCE_DIR}/src/process.cpp"
         "${CMAKE_SOURCE_DIR}/src/process.h"
@@ -234,6 +234,8 @@ endif ()
 
 list(APPEND PLATFORM_TARGET_FILES
         "${CMAKE_SOURCE_DIR}/src/platform/linux/publish.cpp"
+        "${CMAKE_SOURCE_DIR}/src/platform/linux/cursor_compositor.h"
+        "${CMAKE_SOURCE_DIR}/src/platform/linux/cursor_compositor.cpp"
         "${CMAKE_SOURCE_DIR}/src/platform/linux/graphics.h"
         "${CMAKE_SOURCE_DIR}/src/platform/linux/graphics.cpp"
         "${CMAKE_SOURCE_DIR}/src/platform/linux/misc.h"
@@ -0,0 +1,153 @@
+/**
+ * @file src/app_catalog.cpp
+ * @brief Definitions for the in-memory copy of the app list and the files it refers to.
+ */
+// standard includes
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+// local includes
+#include "app_catalog.h"
+#include "crypto.h"
+#include "file_handler.h"
+
+namespace app_catalog {
+  namespace fs = std::filesystem;
+
+  namespace {
+    struct hash_entry_t {
+      file_stamp_t stamp;
+      std::string hash;
+      std::uint64_t generation;
+    };
+
+    std::mutex hash_lock;
+    std::unordered_map<std::string, hash_entry_t> hashes;
+    // Incremented by prune_hashes(), entries not used during the current generation are dropped
+    std::uint64_t hash_generation = 0;
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+
+    std::mutex apps_lock;
+    std::string apps_file_name;
+    std::string apps_content;
+    std::shared_ptr<const nlohmann::json> apps_tree;
+
+    std::optional<std::string> sha256(const std::string &path) {
+      crypto::md_ctx_t ctx {EVP_MD_CTX_create()};
+      if (!ctx || !EVP_DigestInit_ex(ctx.get(), EVP_sha256(), nullptr)) {
+        return std::nullopt;
+      }
+
+      std::ifstream file(path, std::ifstream::binary);
+      char buf[1024 * 16];
+      while (file.good()) {
+        file.read(buf, sizeof(buf));
+        if (!EVP_DigestUpdate(ctx.get(), buf, file.gcount())) {
+          return std::nullopt;
+        }
+      }
+
+      crypto::sha256_t result;
+      if (!EVP_DigestFinal_ex(ctx.get(), result.data(), nullptr)) {
+        return std::nullopt;
+      }
+
+      // Lowercase, app ids are derived from it and must not change
+      static constexpr char digits[] = "0123456789abcdef";
+      std::string hex;
+      hex.reserve(result.size() * 2);
+      for (auto byte : result) {
+        hex += digits[byte >> 4];
+        hex += digits[byte & 0xF];
+      }
+
+      return hex;
+    }
+  }  // namespace
+
+  std::optional<file_stamp_t> stamp(const fs::path &path) {
+    std::error_code ec;
+    auto size = fs::file_size(path, ec);
+    if (ec) {
+      return std::nullopt;
+    }
+
+    auto mtime = fs::last_write_time(path, ec);
+    if (ec) {
+      return std::nullopt;
+    }
+
+    return file_stamp_t {size, mtime};
+  }
+
+  std::optional<std::string> file_sha256(const std::string &path) {
+    auto current = stamp(path);
+    if (!current) {
+      return sha256(path);
+    }
+
+    {
+      std::lock_guard lg(hash_lock);
+
+      auto it = hashes.find(path);
+      if (it != std::end(hashes) && it->second.stamp == *current) {
+        it->second.generation = hash_generation;
+        ++hits;
+        return it->second.hash;
+      }
+
+      ++misses;
+    }
+
+    // Hash without holding the lock, the file may be large
+    auto hash = sha256(path);
+    if (!hash) {
+      return std::nullopt;
+    }
+
+    std::lock_guard lg(hash_lock);
+    hashes[path] = hash_entry_t {*current, *hash, hash_generation};
+
+    return hash;
+  }
+
+  void prune_hashes() {
+    std::lock_guard lg(hash_lock);
+
+    std::erase_if(hashes, [](const auto &entry) {
+      return entry.second.generation != hash_generation;
+    });
+    ++hash_generation;
+  }
+
+  std::shared_ptr<const nlohmann::json> apps(const std::string &file_name) {
+    // Reading the file is cheap next to parsing it, and unlike the modification time
+    // it can't miss two saves in quick succession
+    auto content = file_handler::read_file(file_name.c_str());
+
+    std::lock_guard lg(apps_lock);
+    if (apps_tree && file_name == apps_file_name && content == apps_content) {
+      return apps_tree;
+    }
+
+    auto tree = std::make_shared<const nlohmann::json>(nlohmann::json::parse(content));
+
+    apps_file_name = file_name;
+    apps_content = std::move(content);
+    apps_tree = tree;
+
+    return tree;
+  }
+
+  std::uint64_t hash_hits() {
+    std::lock_guard lg(hash_lock);
+    return hits;
+  }
+
+  std::uint64_t hash_misses() {
+    std::lock_guard lg(hash_lock);
+    return misses;
+  }
+}  // namespace app_catalog
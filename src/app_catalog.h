@@ -0,0 +1,71 @@
+/**
+ * @file src/app_catalog.h
+ * @brief Declarations for the in-memory copy of the app list and the files it refers to.
+ */
+#pragma once
+
+// standard includes
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+
+// lib includes
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Keeps apps.json and the hashes of app images in memory, so large libraries aren't
+ *        read and hashed again every time the app list is saved or requested.
+ */
+namespace app_catalog {
+  /**
+   * @brief Identifies a version of a file without reading it.
+   */
+  struct file_stamp_t {
+    std::uintmax_t size;
+    std::filesystem::file_time_type mtime;
+
+    bool operator==(const file_stamp_t &) const = default;
+  };
+
+  /**
+   * @brief Get the size and modification time of a file.
+   * @return The stamp, or `std::nullopt` if the file doesn't exist.
+   */
+  std::optional<file_stamp_t> stamp(const std::filesystem::path &path);
+
+  /**
+   * @brief Get the SHA-256 of a file as a hex string.
+   * @details Hashes are kept by path and only computed again when the size or modification
+   *          time of the file changed.
+   * @param path The file to hash.
+   * @return The hash, or `std::nullopt` if the file couldn't be read.
+   */
+  std::optional<std::string> file_sha256(const std::string &path);
+
+  /**
+   * @brief Forget the hashes of files that weren't requested since the previous call.
+   * @details Called after the app list was parsed, so images of removed apps don't stay cached.
+   */
+  void prune_hashes();
+
+  /**
+   * @brief Get the parsed contents of apps.json.
+   * @details The file is only parsed again when its contents changed.
+   * @param file_name The path of apps.json.
+   * @return The shared, read-only document. Callers that need to modify it make a copy.
+   * @throws nlohmann::json::exception or std::exception if the file can't be read or parsed.
+   */
+  std::shared_ptr<const nlohmann::json> apps(const std::string &file_name);
+
+  /**
+   * @brief Number of `file_sha256` calls answered without reading the file.
+   */
+  std::uint64_t hash_hits();
+
+  /**
+   * @brief Number of `file_sha256` calls that had to read the file.
+   */
+  std::uint64_t hash_misses();
+}  // namespace app_catalog
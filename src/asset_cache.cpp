@@ -0,0 +1,192 @@
+/**
+ * @file src/asset_cache.cpp
+ * @brief Definitions for the in-memory cache of files served over HTTP.
+ */
+// standard includes
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+#include <optional>
+
+// lib includes
+#include <boost/algorithm/string/predicate.hpp>
+
+// local includes
+#include "asset_cache.h"
+#include "crypto.h"
+#include "utility.h"
+
+namespace http {
+  namespace fs = std::filesystem;
+
+  namespace {
+    std::string_view trim(std::string_view value) {
+      while (!value.empty() && value.front() == ' ') {
+        value.remove_prefix(1);
+      }
+      while (!value.empty() && value.back() == ' ') {
+        value.remove_suffix(1);
+      }
+
+      return value;
+    }
+  }  // namespace
+
+  asset_cache_t::asset_cache_t(std::size_t max_bytes):
+      max_bytes {max_bytes} {
+  }
+
+  std::shared_ptr<const asset_t> asset_cache_t::get(const fs::path &path) {
+    std::error_code ec;
+    auto mtime = fs::last_write_time(path, ec);
+    if (ec) {
+      return nullptr;
+    }
+
+    auto size = fs::file_size(path, ec);
+    if (ec) {
+      return nullptr;
+    }
+
+    auto key = path.string();
+    {
+      std::lock_guard lg(lock);
+
+      auto it = index.find(key);
+      if (it != std::end(index) && it->second->size == size && it->second->asset->mtime == mtime) {
+        ++hit_count;
+        entries.splice(std::begin(entries), entries, it->second);
+
+        return it->second->asset;
+      }
+
+      ++miss_count;
+    }
+
+    // Read without holding the lock, other files can be served meanwhile
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+      return nullptr;
+    }
+
+    auto asset = std::make_shared<asset_t>();
+    asset->data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    asset->etag = '"' + util::hex(crypto::hash(asset->data)).to_string() + '"';
+    asset->mtime = mtime;
+
+    if (asset->data.size() > max_bytes / 4) {
+      return asset;
+    }
+
+    std::lock_guard lg(lock);
+
+    if (auto it = index.find(key); it != std::end(index)) {
+      cached_bytes -= it->second->asset->data.size();
+      entries.erase(it->second);
+      index.erase(it);
+    }
+
+    entries.push_front(entry_t {key, size, asset});
+    index.emplace(std::move(key), std::begin(entries));
+    cached_bytes += asset->data.size();
+
+    while (cached_bytes > max_bytes) {
+      auto &oldest = entries.back();
+      cached_bytes -= oldest.asset->data.size();
+      index.erase(oldest.path);
+      entries.pop_back();
+    }
+
+    return asset;
+  }
+
+  std::uint64_t asset_cache_t::hits() const {
+    std::lock_guard lg(lock);
+    return hit_count;
+  }
+
+  std::uint64_t asset_cache_t::misses() const {
+    std::lock_guard lg(lock);
+    return miss_count;
+  }
+
+  std::size_t asset_cache_t::bytes() const {
+    std::lock_guard lg(lock);
+    return cached_bytes;
+  }
+
+  bool etag_matches(std::string_view if_none_match, std::string_view etag) {
+    while (!if_none_match.empty()) {
+      auto end = if_none_match.find(',');
+      auto candidate = if_none_match.substr(0, end);
+      if_none_match.remove_prefix(end == std::string_view::npos ? if_none_match.size() : end + 1);
+
+      candidate = trim(candidate);
+
+      // If-None-Match uses the weak comparison, a weak validator matches too
+      if (candidate.starts_with("W/")) {
+        candidate.remove_prefix(2);
+      }
+
+      if (candidate == "*" || candidate == etag) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  bool accepts_encoding(std::string_view accept_encoding, std::string_view coding) {
+    std::optional<bool> listed;
+    std::optional<bool> wildcard;
+
+    while (!accept_encoding.empty()) {
+      auto end = accept_encoding.find(',');
+      auto item = accept_encoding.substr(0, end);
+      accept_encoding.remove_prefix(end == std::string_view::npos ? accept_encoding.size() : end + 1);
+
+      auto params = item.find(';');
+      auto name = trim(item.substr(0, params));
+
+      // Only q=0 refuses a coding, any other weight still allows it
+      bool allowed = true;
+      if (params != std::string_view::npos) {
+        auto q = trim(item.substr(params + 1));
+        if (q.starts_with("q=") || q.starts_with("Q=")) {
+          q.remove_prefix(2);
+          allowed = q.find_first_not_of("0.") != std::string_view::npos;
+        }
+      }
+
+      if (boost::iequals(name, coding)) {
+        listed = allowed;
+      } else if (name == "*") {
+        wildcard = allowed;
+      }
+    }
+
+    return listed.value_or(wildcard.value_or(false));
+  }
+
+  bool is_hashed_name(std::string_view filename) {
+    // Vite names built files [name]-[hash].[ext], with 8 characters of base64url for the hash
+    constexpr std::size_t hash_length = 8;
+
+    auto stem = filename.substr(0, filename.rfind('.'));
+    if (stem.size() <= hash_length || stem[stem.size() - hash_length - 1] != '-') {
+      return false;
+    }
+
+    auto hash = stem.substr(stem.size() - hash_length);
+    auto is_base64url = [](char c) {
+      return std::isalnum((unsigned char) c) || c == '-' || c == '_';
+    };
+    auto is_word = [](char c) {
+      return std::islower((unsigned char) c);
+    };
+
+    // A hash practically always has a digit or capital, words such as "settings" don't
+    return std::ranges::all_of(hash, is_base64url) && !std::ranges::all_of(hash, is_word);
+  }
+}  // namespace http
@@ -0,0 +1,99 @@
+/**
+ * @file src/asset_cache.h
+ * @brief Declarations for the in-memory cache of files served over HTTP.
+ */
+#pragma once
+
+// standard includes
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace http {
+
+  /**
+   * @brief The contents of a file, as it was when it was read.
+   */
+  struct asset_t {
+    std::string data;
+
+    /**
+     * @brief Strong ETag, including the quotes.
+     */
+    std::string etag;
+
+    std::filesystem::file_time_type mtime;
+  };
+
+  /**
+   * @brief Least recently used cache of small files, like app covers.
+   * @details Every lookup checks the modification time and size of the file, so an edited
+   *          file is read again on the next request. Files larger than a quarter of the
+   *          cache are read every time.
+   */
+  class asset_cache_t {
+  public:
+    explicit asset_cache_t(std::size_t max_bytes);
+
+    /**
+     * @brief Get a file from the cache, reading it if it isn't cached or changed on disk.
+     * @param path The file.
+     * @return The file contents, or `nullptr` if the file couldn't be read.
+     */
+    std::shared_ptr<const asset_t> get(const std::filesystem::path &path);
+
+    std::uint64_t hits() const;
+    std::uint64_t misses() const;
+
+    /**
+     * @brief Size of all cached files.
+     */
+    std::size_t bytes() const;
+
+  private:
+    struct entry_t {
+      std::string path;
+      std::uintmax_t size;
+      std::shared_ptr<const asset_t> asset;
+    };
+
+    std::size_t max_bytes;
+
+    mutable std::mutex lock;
+
+    // Most recently used first
+    std::list<entry_t> entries;
+    std::unordered_map<std::string, std::list<entry_t>::iterator> index;
+    std::size_t cached_bytes = 0;
+
+    std::uint64_t hit_count = 0;
+    std::uint64_t miss_count = 0;
+  };
+
+  /**
+   * @brief Check whether an `If-None-Match` request header matches an ETag.
+   * @param if_none_match The header value, a list of ETags or `*`.
+   * @param etag The current ETag of the resource.
+   * @return `true` if the client's copy is current and a 304 can be sent.
+   */
+  bool etag_matches(std::string_view if_none_match, std::string_view etag);
+
+  /**
+   * @brief Check whether an `Accept-Encoding` request header allows a content coding.
+   * @param accept_encoding The header value, e.g. `gzip, deflate, br;q=0.9`.
+   * @param coding The content coding, e.g. `br`.
+   * @return `true` if the coding, or `*`, is listed without being refused with `q=0`.
+   */
+  bool accepts_encoding(std::string_view accept_encoding, std::string_view coding);
+
+  /**
+   * @brief Check whether a file name carries a content hash, like `index-BdQq_4o1.js` from the web UI build.
+   * @details A hashed file never changes, a new build references files with new names instead.
+   */
+  bool is_hashed_name(std::string_view filename);
+}  // namespace http
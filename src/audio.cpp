@@ -3,6 +3,11 @@
  * @brief Definitions for audio capture and encoding.
  */
 // standard includes
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <mutex>
 #include <thread>
 
 // lib includes
@@ -10,6 +15,7 @@
 
 // local includes
 #include "audio.h"
+#include "audio_drift.h"
 #include "config.h"
 #include "globals.h"
 #include "logging.h"
@@ -19,8 +25,7 @@
 
 namespace audio {
   using namespace std::literals;
-  using opus_t = util::safe_ptr<OpusMSEncoder, opus_multistream_encoder_destroy>;
-  using sample_queue_t = std::shared_ptr<safe::queue_t<std::vector<float>>>;
+  using sample_queue_t = std::shared_ptr<sample_ring_t>;
 
   static int start_audio_control(audio_ctx_t &ctx);
   static void stop_audio_control(audio_ctx_t &);
@@ -30,6 +35,19 @@ namespace audio {
 
   constexpr auto SAMPLE_RATE = 48000;
 
+  // Number of captured frames buffered for the encoding thread
+  constexpr auto SAMPLE_FRAMES = 30;
+
+  // The packet queue holds up to 32 packets, plus one being sent and one being encoded
+  constexpr auto PACKET_SLOTS = 34;
+  constexpr auto PACKET_SLOT_SIZE = 1400;
+
+  // Anything quieter than the least significant bit of 16 bit audio is digital silence
+  constexpr float SILENCE_THRESHOLD = 1.0f / 32768;
+
+  // Keep encoding for a while after the audio went silent, so the tail of the sound is encoded
+  constexpr auto SILENCE_HANGOVER = 50ms;
+
   // NOTE: If you adjust the bitrates listed here, make sure to update the
   // corresponding bitrate adjustment logic in rtsp_stream::cmd_announce()
   opus_stream_config_t stream_configs[MAX_STREAM_CONFIG] {
@@ -83,48 +101,254 @@ namespace audio {
     },
   };
 
-  void encodeThread(sample_queue_t samples, config_t config, void *channel_data) {
-    auto packets = mail::man->queue<packet_t>(mail::audio_packets);
-    auto stream = stream_configs[map_stream(config.channels, config.flags[config_t::HIGH_QUALITY])];
-    if (config.flags[config_t::CUSTOM_SURROUND_PARAMS]) {
-      apply_surround_params(stream, config.customStreamParams);
+  /**
+   * @brief Everything that makes two sessions produce identical audio packets.
+   */
+  struct pipeline_key_t {
+    std::string sink;
+    int packet_duration;
+    int channel_count;
+    int streams;
+    int coupled_streams;
+    std::array<std::uint8_t, 8> mapping;
+    int bitrate;
+
+    auto operator<=>(const pipeline_key_t &) const = default;
+  };
+
+  /**
+   * @brief Captures and encodes audio once for all sessions streaming the same configuration.
+   * @details Every encoded packet is handed to the broadcast thread once per subscribed session,
+   *          the sessions only share a reference to the pooled packet.
+   */
+  class pipeline_t {
+  public:
+    pipeline_t(audio_ctx_ref_t ref, const pipeline_key_t &key):
+        ref {std::move(ref)},
+        key {key} {
+      stream = opus_stream_config_t {
+        SAMPLE_RATE,
+        key.channel_count,
+        key.streams,
+        key.coupled_streams,
+        this->key.mapping.data(),
+        key.bitrate,
+      };
+
+      frame_size = key.packet_duration * stream.sampleRate / 1000;
     }
 
-    // Encoding takes place on this thread
-    platf::adjust_thread_priority(platf::thread_priority_e::high);
+    ~pipeline_t() {
+      shutdown_event.raise(true);
+      if (capture_worker.joinable()) {
+        capture_worker.join();
+      }
 
-    opus_t opus {opus_multistream_encoder_create(
-      stream.sampleRate,
-      stream.channelCount,
-      stream.streams,
-      stream.coupledStreams,
-      stream.mapping,
-      OPUS_APPLICATION_RESTRICTED_LOWDELAY,
-      nullptr
-    )};
+      if (samples) {
+        samples->stop();
+      }
+      if (encode_worker.joinable()) {
+        encode_worker.join();
+      }
 
-    opus_multistream_encoder_ctl(opus.get(), OPUS_SET_BITRATE(stream.bitrate));
-    opus_multistream_encoder_ctl(opus.get(), OPUS_SET_VBR(0));
+      if (samples) {
+        BOOST_LOG(info) << "Audio device clock drift: "sv << drift_ppm << " ppm"sv;
 
-    BOOST_LOG(info) << "Opus initialized: "sv << stream.sampleRate / 1000 << " kHz, "sv
-                    << stream.channelCount << " channels, "sv
-                    << stream.bitrate / 1000 << " kbps (total), LOWDELAY"sv;
+        if (auto overruns = samples->overruns()) {
+          BOOST_LOG(warning) << "Dropped "sv << overruns << " audio frames, the encoder couldn't keep up"sv;
+        }
+      }
+    }
 
-    auto frame_size = config.packetDuration * stream.sampleRate / 1000;
-    while (auto sample = samples->pop()) {
-      buffer_t packet {1400};
+    /**
+     * @brief Open the microphone and start capturing.
+     * @return 0 on success, -1 if the microphone couldn't be opened.
+     */
+    int start() {
+      mic = ref->control->microphone(stream.mapping, stream.channelCount, stream.sampleRate, frame_size);
+      if (!mic) {
+        return -1;
+      }
 
-      int bytes = opus_multistream_encode_float(opus.get(), sample->data(), frame_size, std::begin(packet), packet.size());
-      if (bytes < 0) {
-        BOOST_LOG(error) << "Couldn't encode audio: "sv << opus_strerror(bytes);
+      samples = std::make_shared<sample_queue_t::element_type>(SAMPLE_FRAMES, frame_size * stream.channelCount);
+      encode_worker = std::thread {&pipeline_t::encode, this};
+      capture_worker = std::thread {&pipeline_t::capture, this};
+
+      return 0;
+    }
+
+    void subscribe(void *channel_data, safe::mail_raw_t::event_t<bool> session_shutdown) {
+      std::lock_guard lg {subscribers_lock};
+      subscribers.emplace_back(channel_data, std::move(session_shutdown));
+
+      if (subscribers.size() > 1) {
+        BOOST_LOG(info) << "Sharing audio capture and encoding between "sv << subscribers.size() << " sessions"sv;
+      }
+    }
+
+    void unsubscribe(void *channel_data) {
+      std::lock_guard lg {subscribers_lock};
+      std::erase_if(subscribers, [channel_data](auto &subscriber) {
+        return subscriber.first == channel_data;
+      });
+    }
+
+  private:
+    void encode() {
+      auto packets = mail::man->queue<packet_t>(mail::audio_packets);
+
+      // Encoding takes place on this thread
+      platf::adjust_thread_priority(platf::thread_priority_e::high);
+
+      packet_encoder_t encoder {stream, frame_size, key.packet_duration};
+
+      logging::time_delta_periodic_logger capture_latency_logger(debug, "Audio: capture to packet latency");
+
+      while (auto packet = encoder.encode(*samples)) {
+        if (!*packet) {
+          continue;
+        }
+
+        {
+          std::lock_guard lg {subscribers_lock};
+          for (auto &[channel_data, _] : subscribers) {
+            packets->raise(channel_data, *packet);
+          }
+        }
+
+        if (auto capture_time = packet->timestamp(); capture_time != std::chrono::steady_clock::time_point {}) {
+          capture_latency_logger.first_point(capture_time);
+          capture_latency_logger.second_point_now_and_log();
+        }
+      }
+
+      if (encoder.failed()) {
         packets->stop();
+      }
+
+      encoder.log_stats();
+    }
+
+    void capture() {
+      // Every session stops with the capture
+      auto fg = util::fail_guard([this]() {
+        std::lock_guard lg {subscribers_lock};
+        for (auto &[_, session_shutdown] : subscribers) {
+          session_shutdown->raise(true);
+        }
+      });
+
+      // Capture takes place on this thread
+      platf::adjust_thread_priority(platf::thread_priority_e::critical);
+
+      // The device clock never runs at exactly the rate of the host clock, resample to keep
+      // the audio timeline, and with it the latency, locked to the host clock
+      drift_tracker_t drift {(std::uint32_t) stream.sampleRate};
+      resampler_t resampler {stream.channelCount, (std::size_t) frame_size};
+      std::vector<float> sample_buffer(frame_size * stream.channelCount);
+
+      auto to_duration = [this](double frames) {
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(frames / stream.sampleRate));
+      };
+      auto drift_log_time = std::chrono::steady_clock::now();
+
+      while (!shutdown_event.peek()) {
+        auto status = mic->sample(sample_buffer);
+        switch (status) {
+          case platf::capture_e::ok:
+            break;
+          case platf::capture_e::timeout:
+            continue;
+          case platf::capture_e::reinit:
+            BOOST_LOG(info) << "Reinitializing audio capture"sv;
+            mic.reset();
+            do {
+              mic = ref->control->microphone(stream.mapping, stream.channelCount, stream.sampleRate, frame_size);
+              if (!mic) {
+                BOOST_LOG(warning) << "Couldn't re-initialize audio input"sv;
+              }
+            } while (!mic && !shutdown_event.view(5s));
+            drift.reset();
+            continue;
+          default:
+            return;
+        }
+
+        // Without capture times, the ratio stays at 1 and samples are passed through untouched
+        auto capture_time = mic->capture_time();
+        if (capture_time) {
+          drift.update(*capture_time, frame_size);
+          resampler.set_ratio(drift.ratio());
+          drift_ppm = drift.drift_ppm();
+
+          if (*capture_time - drift_log_time > 1min) {
+            BOOST_LOG(debug) << "Audio device clock drift: "sv << drift_ppm << " ppm"sv;
+            drift_log_time = *capture_time;
+          }
+        }
+
+        resampler.push(sample_buffer);
 
-        return;
+        while (true) {
+          auto pending = resampler.pending();
+          if (!resampler.pop(samples->write_frame())) {
+            break;
+          }
+
+          if (capture_time) {
+            samples->commit(*capture_time + to_duration(frame_size - pending));
+          } else {
+            samples->commit();
+          }
+        }
+      }
+
+      fg.disable();
+    }
+
+    audio_ctx_ref_t ref;
+    pipeline_key_t key;
+    opus_stream_config_t stream;
+    int frame_size;
+
+    std::unique_ptr<platf::mic_t> mic;
+    sample_queue_t samples;
+    std::atomic<double> drift_ppm {0};
+
+    safe::event_t<bool> shutdown_event;
+    std::thread capture_worker;
+    std::thread encode_worker;
+
+    std::mutex subscribers_lock;
+    std::vector<std::pair<void *, safe::mail_raw_t::event_t<bool>>> subscribers;
+  };
+
+  /**
+   * @brief Get the running pipeline for the key, or start a new one.
+   * @return The pipeline, or `nullptr` if capture couldn't be started.
+   */
+  static std::shared_ptr<pipeline_t> get_pipeline(const audio_ctx_ref_t &ref, const pipeline_key_t &key) {
+    static std::mutex pipelines_lock;
+    static std::map<pipeline_key_t, std::weak_ptr<pipeline_t>> pipelines;
+
+    std::lock_guard lg {pipelines_lock};
+    std::erase_if(pipelines, [](auto &pair) {
+      return pair.second.expired();
+    });
+
+    if (auto it = pipelines.find(key); it != std::end(pipelines)) {
+      if (auto pipeline = it->second.lock()) {
+        return pipeline;
       }
+    }
 
-      packet.fake_resize(bytes);
-      packets->raise(channel_data, std::move(packet));
+    auto pipeline = std::make_shared<pipeline_t>(ref, key);
+    if (pipeline->start()) {
+      return nullptr;
     }
+
+    pipelines.insert_or_assign(key, pipeline);
+    return pipeline;
   }
 
   void capture(safe::mail_t mail, config_t config, void *channel_data) {
@@ -192,55 +416,118 @@ namespace audio {
       }
     }
 
-    auto frame_size = config.packetDuration * stream.sampleRate / 1000;
-    auto mic = control->microphone(stream.mapping, stream.channelCount, stream.sampleRate, frame_size);
-    if (!mic) {
+    pipeline_key_t key {*sink, config.packetDuration, stream.channelCount, stream.streams, stream.coupledStreams, {}, stream.bitrate};
+    std::copy_n(stream.mapping, stream.channelCount, std::begin(key.mapping));
+
+    auto pipeline = get_pipeline(ref, key);
+    if (!pipeline) {
       return;
     }
 
     // Audio is initialized, so we don't want to print the failure message
     init_failure_fg.disable();
 
-    // Capture takes place on this thread
-    platf::adjust_thread_priority(platf::thread_priority_e::critical);
-
-    auto samples = std::make_shared<sample_queue_t::element_type>(30);
-    std::thread thread {encodeThread, samples, config, channel_data};
-
+    pipeline->subscribe(channel_data, shutdown_event);
     auto fg = util::fail_guard([&]() {
-      samples->stop();
-      thread.join();
+      pipeline->unsubscribe(channel_data);
+    });
 
-      shutdown_event->view();
+    shutdown_event->view();
+  }
+
+  bool is_silent(const std::vector<float> &samples) {
+    return std::ranges::all_of(samples, [](float sample) {
+      return std::abs(sample) < SILENCE_THRESHOLD;
     });
+  }
+
+  packet_encoder_t::packet_encoder_t(const opus_stream_config_t &stream, int frame_size, int packet_duration):
+      opus {
+        opus_multistream_encoder_create(
+          stream.sampleRate,
+          stream.channelCount,
+          stream.streams,
+          stream.coupledStreams,
+          stream.mapping,
+          OPUS_APPLICATION_RESTRICTED_LOWDELAY,
+          nullptr
+        ),
+        opus_multistream_encoder_destroy
+      },
+      frame_size {frame_size},
+      packet_pool {packet_pool_t::make(PACKET_SLOTS, PACKET_SLOT_SIZE)},
+      hangover_frames {SILENCE_HANGOVER / std::chrono::milliseconds(packet_duration)} {
+    opus_multistream_encoder_ctl(opus.get(), OPUS_SET_BITRATE(stream.bitrate));
+    opus_multistream_encoder_ctl(opus.get(), OPUS_SET_VBR(0));
+
+    BOOST_LOG(info) << "Opus initialized: "sv << stream.sampleRate / 1000 << " kHz, "sv
+                    << stream.channelCount << " channels, "sv
+                    << stream.bitrate / 1000 << " kbps (total), LOWDELAY"sv;
 
-    int samples_per_frame = frame_size * stream.channelCount;
+    // It has the same size as any other packet, as clients expect constant bitrate audio
+    silence_packet.reserve(PACKET_SLOT_SIZE);
+  }
 
-    while (!shutdown_event->peek()) {
-      std::vector<float> sample_buffer;
-      sample_buffer.resize(samples_per_frame);
+  std::optional<buffer_t> packet_encoder_t::encode(sample_ring_t &samples) {
+    auto sample = samples.read_frame();
+    if (!sample) {
+      return std::nullopt;
+    }
 
-      auto status = mic->sample(sample_buffer);
-      switch (status) {
-        case platf::capture_e::ok:
-          break;
-        case platf::capture_e::timeout:
-          continue;
-        case platf::capture_e::reinit:
-          BOOST_LOG(info) << "Reinitializing audio capture"sv;
-          mic.reset();
-          do {
-            mic = control->microphone(stream.mapping, stream.channelCount, stream.sampleRate, frame_size);
-            if (!mic) {
-              BOOST_LOG(warning) << "Couldn't re-initialize audio input"sv;
-            }
-          } while (!mic && !shutdown_event->view(5s));
-          continue;
-        default:
-          return;
+    auto packet = packet_pool->acquire();
+    if (!packet) {
+      // Every packet is still waiting to be sent
+      samples.release();
+      ++dropped_packets;
+      return packet;
+    }
+
+    auto capture_time = samples.read_time();
+    silent_frames = config::audio.silence_detection && is_silent(*sample) ? silent_frames + 1 : 0;
+
+    int bytes;
+    if (silent_frames > hangover_frames && !silence_packet.empty()) {
+      samples.release();
+
+      bytes = (int) silence_packet.size();
+      std::copy(std::begin(silence_packet), std::end(silence_packet), std::begin(packet));
+      packet.set_silent(true);
+      ++silent_packets;
+    } else {
+      bytes = opus_multistream_encode_float(opus.get(), sample->data(), frame_size, std::begin(packet), packet.size());
+      samples.release();
+
+      if (bytes < 0) {
+        BOOST_LOG(error) << "Couldn't encode audio: "sv << opus_strerror(bytes);
+        encode_failed = true;
+
+        return std::nullopt;
       }
 
-      samples->raise(std::move(sample_buffer));
+      if (silent_frames == hangover_frames) {
+        silence_packet.assign(std::begin(packet), std::begin(packet) + bytes);
+      }
+    }
+    ++total_packets;
+
+    packet.resize(bytes);
+    packet.set_timestamp(capture_time);
+
+    return packet;
+  }
+
+  bool packet_encoder_t::failed() const {
+    return encode_failed;
+  }
+
+  void packet_encoder_t::log_stats() const {
+    if (dropped_packets) {
+      BOOST_LOG(warning) << "Dropped "sv << dropped_packets << " audio packets waiting for the network"sv;
+    }
+
+    if (silent_packets) {
+      BOOST_LOG(info) << "Skipped encoding "sv << silent_packets << " of "sv << total_packets << " audio packets ("sv
+                      << silent_packets * 100 / total_packets << "%) holding digital silence"sv;
     }
   }
 
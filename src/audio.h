@@ -5,11 +5,15 @@
 #pragma once
 
 // local includes
+#include "audio_buffers.h"
 #include "platform/common.h"
 #include "thread_safe.h"
 #include "utility.h"
 
 #include <bitset>
+#include <optional>
+
+struct OpusMSEncoder;
 
 namespace audio {
   enum stream_config_e : int {
@@ -67,12 +71,68 @@ namespace audio {
     platf::sink_t sink;
   };
 
-  using buffer_t = util::buffer_t<std::uint8_t>;
+  using buffer_t = packet_buffer_t;
   using packet_t = std::pair<void *, buffer_t>;
   using audio_ctx_ref_t = safe::shared_t<audio_ctx_t>::ptr_t;
 
   void capture(safe::mail_t mail, config_t config, void *channel_data);
 
+  /**
+   * @brief Check if a frame holds nothing but digital silence.
+   * @param samples The captured samples.
+   * @return `true` if no sample is louder than the least significant bit of 16 bit audio.
+   */
+  bool is_silent(const std::vector<float> &samples);
+
+  /**
+   * @brief Encodes captured frames into pooled Opus packets, on the encoding thread of a capture.
+   * @details Once the audio has been silent for a while, the encoder only produces the same silent
+   *          packet over and over. That packet is kept and sent instead of encoding silence.
+   *          Once the packet pool is warm, encoding doesn't allocate.
+   */
+  class packet_encoder_t {
+  public:
+    /**
+     * @param stream The Opus stream configuration.
+     * @param frame_size Samples per channel in a frame.
+     * @param packet_duration Duration of a packet in milliseconds.
+     */
+    packet_encoder_t(const opus_stream_config_t &stream, int frame_size, int packet_duration);
+
+    /**
+     * @brief Wait for the next captured frame and encode it.
+     * @param samples The captured frames.
+     * @return The packet, an empty packet if every packet is still waiting to be sent,
+     *         or `std::nullopt` once capture stopped or the frame couldn't be encoded.
+     */
+    std::optional<buffer_t> encode(sample_ring_t &samples);
+
+    /**
+     * @brief Whether encoding stopped because a frame couldn't be encoded.
+     */
+    bool failed() const;
+
+    /**
+     * @brief Log how many packets were dropped and how many held silence.
+     */
+    void log_stats() const;
+
+  private:
+    std::unique_ptr<OpusMSEncoder, void (*)(OpusMSEncoder *)> opus;
+    int frame_size;
+    bool encode_failed = false;
+
+    std::shared_ptr<packet_pool_t> packet_pool;
+
+    std::vector<std::uint8_t> silence_packet;
+    std::int64_t hangover_frames;
+    std::int64_t silent_frames = 0;
+
+    std::uint64_t dropped_packets = 0;
+    std::uint64_t total_packets = 0;
+    std::uint64_t silent_packets = 0;
+  };
+
   /**
    * @brief Get the reference to the audio context.
    * @returns A shared pointer reference to audio context.
@@ -0,0 +1,224 @@
+/**
+ * @file src/audio_buffers.cpp
+ * @brief Definitions for the preallocated buffers used between audio capture, encoding and sending.
+ */
+// standard includes
+#include <algorithm>
+#include <utility>
+
+// local includes
+#include "audio_buffers.h"
+
+namespace audio {
+
+  sample_ring_t::sample_ring_t(std::size_t frames, std::size_t samples_per_frame):
+      frames(frames, std::vector<float>(samples_per_frame)),
+      scratch(samples_per_frame),
+      times(frames) {
+  }
+
+  std::vector<float> &sample_ring_t::write_frame() {
+    std::lock_guard lg {lock};
+
+    writing_scratch = count == frames.size();
+    if (writing_scratch) {
+      return scratch;
+    }
+
+    // Only published frames are visible to the reader, so this one can be written outside the lock
+    return frames[(head + count) % frames.size()];
+  }
+
+  void sample_ring_t::commit(std::chrono::steady_clock::time_point capture_time) {
+    {
+      std::lock_guard lg {lock};
+      if (writing_scratch) {
+        ++dropped;
+        return;
+      }
+
+      times[(head + count) % frames.size()] = capture_time;
+      ++count;
+    }
+
+    cv.notify_one();
+  }
+
+  const std::vector<float> *sample_ring_t::read_frame() {
+    std::unique_lock ul {lock};
+
+    cv.wait(ul, [this]() {
+      return stopped || count > 0;
+    });
+
+    if (stopped) {
+      return nullptr;
+    }
+
+    return &frames[head];
+  }
+
+  void sample_ring_t::release() {
+    std::lock_guard lg {lock};
+
+    head = (head + 1) % frames.size();
+    --count;
+  }
+
+  std::chrono::steady_clock::time_point sample_ring_t::read_time() const {
+    std::lock_guard lg {lock};
+    return times[head];
+  }
+
+  void sample_ring_t::stop() {
+    {
+      std::lock_guard lg {lock};
+      stopped = true;
+    }
+
+    cv.notify_all();
+  }
+
+  std::uint64_t sample_ring_t::overruns() const {
+    std::lock_guard lg {lock};
+    return dropped;
+  }
+
+  struct packet_buffer_t::slot_t {
+    std::uint8_t *data;
+    std::size_t size;
+    std::chrono::steady_clock::time_point timestamp;
+    bool silent;
+    std::atomic<int> refs;
+  };
+
+  packet_buffer_t::packet_buffer_t(std::shared_ptr<packet_pool_t> pool, slot_t *slot):
+      pool {std::move(pool)},
+      slot {slot} {
+  }
+
+  packet_buffer_t::packet_buffer_t(const packet_buffer_t &other) noexcept:
+      pool {other.pool},
+      slot {other.slot} {
+    if (slot) {
+      slot->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  packet_buffer_t::packet_buffer_t(packet_buffer_t &&other) noexcept:
+      pool {std::move(other.pool)},
+      slot {std::exchange(other.slot, nullptr)} {
+  }
+
+  packet_buffer_t &packet_buffer_t::operator=(packet_buffer_t other) noexcept {
+    std::swap(pool, other.pool);
+    std::swap(slot, other.slot);
+
+    return *this;
+  }
+
+  packet_buffer_t::~packet_buffer_t() {
+    reset();
+  }
+
+  void packet_buffer_t::reset() {
+    if (slot && slot->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      pool->release(slot);
+    }
+
+    slot = nullptr;
+    pool.reset();
+  }
+
+  std::uint8_t *packet_buffer_t::begin() const {
+    return slot ? slot->data : nullptr;
+  }
+
+  std::uint8_t *packet_buffer_t::end() const {
+    return slot ? slot->data + slot->size : nullptr;
+  }
+
+  std::size_t packet_buffer_t::size() const {
+    return slot ? slot->size : 0;
+  }
+
+  void packet_buffer_t::resize(std::size_t size) {
+    if (slot) {
+      slot->size = std::min(size, pool->slot_size);
+    }
+  }
+
+  std::chrono::steady_clock::time_point packet_buffer_t::timestamp() const {
+    return slot ? slot->timestamp : std::chrono::steady_clock::time_point {};
+  }
+
+  void packet_buffer_t::set_timestamp(std::chrono::steady_clock::time_point timestamp) {
+    if (slot) {
+      slot->timestamp = timestamp;
+    }
+  }
+
+  bool packet_buffer_t::silent() const {
+    return slot && slot->silent;
+  }
+
+  void packet_buffer_t::set_silent(bool silent) {
+    if (slot) {
+      slot->silent = silent;
+    }
+  }
+
+  std::shared_ptr<packet_pool_t> packet_pool_t::make(std::size_t slots, std::size_t slot_size) {
+    return std::make_shared<packet_pool_t>(slots, slot_size);
+  }
+
+  packet_pool_t::packet_pool_t(std::size_t slots, std::size_t slot_size):
+      slot_size {slot_size},
+      slots {std::make_unique<packet_buffer_t::slot_t[]>(slots)},
+      storage {std::make_unique<std::uint8_t[]>(slots * slot_size)} {
+    free_slots.reserve(slots);
+
+    for (std::size_t x = 0; x < slots; ++x) {
+      auto &slot = this->slots[x];
+      slot.data = &storage[x * slot_size];
+      slot.size = slot_size;
+      slot.refs = 0;
+
+      free_slots.emplace_back(&slot);
+    }
+  }
+
+  packet_pool_t::~packet_pool_t() = default;
+
+  packet_buffer_t packet_pool_t::acquire() {
+    packet_buffer_t::slot_t *slot;
+    {
+      std::lock_guard lg {lock};
+      if (free_slots.empty()) {
+        return {};
+      }
+
+      slot = free_slots.back();
+      free_slots.pop_back();
+    }
+
+    slot->size = slot_size;
+    slot->timestamp = {};
+    slot->silent = false;
+    slot->refs.store(1, std::memory_order_relaxed);
+
+    return packet_buffer_t {shared_from_this(), slot};
+  }
+
+  std::size_t packet_pool_t::free_count() const {
+    std::lock_guard lg {lock};
+    return free_slots.size();
+  }
+
+  void packet_pool_t::release(packet_buffer_t::slot_t *slot) {
+    std::lock_guard lg {lock};
+
+    // Capacity was reserved up front, this never allocates
+    free_slots.emplace_back(slot);
+  }
+}  // namespace audio
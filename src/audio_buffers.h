@@ -0,0 +1,168 @@
+/**
+ * @file src/audio_buffers.h
+ * @brief Declarations for the preallocated buffers used between audio capture, encoding and sending.
+ */
+#pragma once
+
+// standard includes
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace audio {
+
+  /**
+   * @brief Single producer, single consumer ring of fixed size sample frames.
+   *
+   * All frames are allocated up front. The capture thread fills the frame returned by
+   * `write_frame()` and publishes it with `commit()`, the encoding thread borrows the
+   * oldest frame with `read_frame()` and hands it back with `release()`.
+   *
+   * When the ring is full, the capture thread still needs somewhere to put samples to keep
+   * draining the device, so it writes into a scratch frame that is dropped on `commit()`.
+   */
+  class sample_ring_t {
+  public:
+    sample_ring_t(std::size_t frames, std::size_t samples_per_frame);
+
+    /**
+     * @brief Get the frame to capture the next samples into.
+     * @details Calling it again before `commit()` returns the same frame.
+     */
+    std::vector<float> &write_frame();
+
+    /**
+     * @brief Publish the frame returned by the last `write_frame()`.
+     * @param capture_time When the first sample of the frame was captured, if known.
+     */
+    void commit(std::chrono::steady_clock::time_point capture_time = {});
+
+    /**
+     * @brief Wait for the oldest published frame.
+     * @return The frame, or `nullptr` if the ring was stopped.
+     */
+    const std::vector<float> *read_frame();
+
+    /**
+     * @brief Hand the frame returned by `read_frame()` back to the capture thread.
+     */
+    void release();
+
+    /**
+     * @brief Capture time of the frame returned by `read_frame()`.
+     * @return The time passed to `commit()`, default constructed if it wasn't known.
+     */
+    std::chrono::steady_clock::time_point read_time() const;
+
+    void stop();
+
+    /**
+     * @brief Number of frames dropped because the encoding thread fell behind.
+     */
+    std::uint64_t overruns() const;
+
+  private:
+    std::vector<std::vector<float>> frames;
+    std::vector<float> scratch;
+    std::vector<std::chrono::steady_clock::time_point> times;
+
+    mutable std::mutex lock;
+    std::condition_variable cv;
+
+    std::size_t head = 0;
+    std::size_t count = 0;
+    bool writing_scratch = false;
+    bool stopped = false;
+    std::uint64_t dropped = 0;
+  };
+
+  class packet_pool_t;
+
+  /**
+   * @brief Reference counted handle to an encoded packet stored in a `packet_pool_t` slot.
+   * @details The slot returns to the pool when the last handle referencing it is destroyed.
+   *          Copying a handle doesn't allocate.
+   */
+  class packet_buffer_t {
+  public:
+    packet_buffer_t() = default;
+    packet_buffer_t(const packet_buffer_t &other) noexcept;
+    packet_buffer_t(packet_buffer_t &&other) noexcept;
+    packet_buffer_t &operator=(packet_buffer_t other) noexcept;
+    ~packet_buffer_t();
+
+    std::uint8_t *begin() const;
+    std::uint8_t *end() const;
+    std::size_t size() const;
+
+    /**
+     * @brief Set the number of bytes actually used, at most the slot size.
+     */
+    void resize(std::size_t size);
+
+    /**
+     * @brief Capture time of the first sample encoded in the packet.
+     * @return The time, default constructed if it isn't known.
+     */
+    std::chrono::steady_clock::time_point timestamp() const;
+    void set_timestamp(std::chrono::steady_clock::time_point timestamp);
+
+    /**
+     * @brief Whether the packet is the precomputed packet sent for digital silence.
+     */
+    bool silent() const;
+    void set_silent(bool silent);
+
+    explicit operator bool() const {
+      return slot != nullptr;
+    }
+
+  private:
+    friend class packet_pool_t;
+
+    struct slot_t;
+
+    packet_buffer_t(std::shared_ptr<packet_pool_t> pool, slot_t *slot);
+
+    void reset();
+
+    std::shared_ptr<packet_pool_t> pool;
+    slot_t *slot = nullptr;
+  };
+
+  /**
+   * @brief Fixed number of preallocated packet slots, recycled once the packet has been sent.
+   */
+  class packet_pool_t: public std::enable_shared_from_this<packet_pool_t> {
+  public:
+    static std::shared_ptr<packet_pool_t> make(std::size_t slots, std::size_t slot_size);
+
+    packet_pool_t(std::size_t slots, std::size_t slot_size);
+    ~packet_pool_t();
+
+    /**
+     * @brief Get a free slot, sized to the full slot size.
+     * @return The slot, or an empty handle if every slot is still in flight.
+     */
+    packet_buffer_t acquire();
+
+    std::size_t free_count() const;
+
+  private:
+    friend class packet_buffer_t;
+
+    void release(packet_buffer_t::slot_t *slot);
+
+    const std::size_t slot_size;
+    std::unique_ptr<packet_buffer_t::slot_t[]> slots;
+    std::unique_ptr<std::uint8_t[]> storage;
+
+    mutable std::mutex lock;
+    std::vector<packet_buffer_t::slot_t *> free_slots;
+  };
+}  // namespace audio
@@ -0,0 +1,161 @@
+/**
+ * @file src/audio_drift.cpp
+ * @brief Definitions for measuring and compensating audio device clock drift.
+ */
+// standard includes
+#include <algorithm>
+#include <cmath>
+
+// local includes
+#include "audio_drift.h"
+
+namespace audio {
+  // Weight kept by the previous frames on every update, about a minute worth of 5ms frames
+  constexpr double FORGET_FACTOR = 0.99998;
+
+  // Don't trust the measured drift before this much audio was captured
+  constexpr double WARMUP_SECONDS = 2.0;
+
+  // A larger jump between the device and host timelines is a discontinuity, not drift
+  constexpr double MAX_TIMELINE_ERROR = 0.2;
+
+  // Fraction of the timeline error corrected per second
+  constexpr double ERROR_GAIN = 0.1;
+
+  // Smoothing applied to the timeline error, to ignore capture timestamp jitter
+  constexpr double ERROR_SMOOTHING = 0.01;
+
+  // Real clocks are well within a few hundred ppm of each other
+  constexpr double MAX_CORRECTION = 0.002;
+
+  drift_tracker_t::drift_tracker_t(std::uint32_t sample_rate):
+      sample_rate {(double) sample_rate} {
+    reset();
+  }
+
+  void drift_tracker_t::reset() {
+    anchored = false;
+    device_samples = 0;
+    output_samples = 0;
+    sum_w = sum_x = sum_y = sum_xx = sum_xy = 0;
+    host_elapsed = 0;
+    output_error = 0;
+    slope = 0;
+    current_ratio = 1;
+  }
+
+  void drift_tracker_t::update(std::chrono::steady_clock::time_point capture_time, std::size_t frames) {
+    if (!anchored) {
+      anchored = true;
+      anchor = capture_time;
+    }
+
+    auto x = std::chrono::duration<double>(capture_time - anchor).count();
+    auto y = device_samples / sample_rate - x;
+
+    if (std::abs(y) > MAX_TIMELINE_ERROR) {
+      // Capture was interrupted, start measuring from scratch
+      reset();
+      anchored = true;
+      anchor = capture_time;
+      x = y = 0;
+    }
+
+    sum_w = sum_w * FORGET_FACTOR + 1;
+    sum_x = sum_x * FORGET_FACTOR + x;
+    sum_y = sum_y * FORGET_FACTOR + y;
+    sum_xx = sum_xx * FORGET_FACTOR + x * x;
+    sum_xy = sum_xy * FORGET_FACTOR + x * y;
+
+    host_elapsed = x;
+    device_samples += frames;
+
+    auto error = output_samples / sample_rate - x;
+    output_error += (error - output_error) * ERROR_SMOOTHING;
+    output_samples += frames * current_ratio;
+
+    if (host_elapsed < WARMUP_SECONDS) {
+      return;
+    }
+
+    auto denominator = sum_w * sum_xx - sum_x * sum_x;
+    if (denominator > 0) {
+      slope = (sum_w * sum_xy - sum_x * sum_y) / denominator;
+    }
+
+    // Undo the measured drift, then steer the remaining error back to zero
+    auto correction = 1 / (1 + slope) - 1 - output_error * ERROR_GAIN;
+    current_ratio = 1 + std::clamp(correction, -MAX_CORRECTION, MAX_CORRECTION);
+  }
+
+  double drift_tracker_t::drift_ppm() const {
+    return slope * 1e6;
+  }
+
+  double drift_tracker_t::ratio() const {
+    return current_ratio;
+  }
+
+  resampler_t::resampler_t(int channels, std::size_t frame_size):
+      channels {channels},
+      frame_size {frame_size},
+      input(frame_size * channels * 4) {
+  }
+
+  void resampler_t::push(const std::vector<float> &frame) {
+    auto capacity = input.size() / channels;
+    if (input_frames + frame_size > capacity) {
+      // Nobody is popping, drop the oldest input
+      auto drop = input_frames + frame_size - capacity;
+      std::copy(std::begin(input) + drop * channels, std::begin(input) + input_frames * channels, std::begin(input));
+      input_frames -= drop;
+      position = std::max(0.0, position - drop);
+    }
+
+    std::copy_n(std::begin(frame), frame_size * channels, std::begin(input) + input_frames * channels);
+    input_frames += frame_size;
+  }
+
+  bool resampler_t::pop(std::vector<float> &frame) {
+    auto last = position + (frame_size - 1) * step;
+    if (std::ceil(last) >= input_frames) {
+      return false;
+    }
+
+    for (std::size_t x = 0; x < frame_size; ++x) {
+      auto pos = position + x * step;
+      auto index = (std::size_t) pos;
+      auto frac = (float) (pos - index);
+
+      auto current = &input[index * channels];
+      auto out = &frame[x * channels];
+      if (frac == 0) {
+        std::copy_n(current, channels, out);
+        continue;
+      }
+
+      auto next = current + channels;
+      for (int c = 0; c < channels; ++c) {
+        out[c] = current[c] + (next[c] - current[c]) * frac;
+      }
+    }
+
+    position += frame_size * step;
+
+    // Drop the input that has been fully consumed
+    auto consumed = std::min((std::size_t) position, input_frames);
+    std::copy(std::begin(input) + consumed * channels, std::begin(input) + input_frames * channels, std::begin(input));
+    input_frames -= consumed;
+    position -= consumed;
+
+    return true;
+  }
+
+  void resampler_t::set_ratio(double ratio) {
+    step = 1 / ratio;
+  }
+
+  double resampler_t::pending() const {
+    return input_frames - position;
+  }
+}  // namespace audio
@@ -0,0 +1,109 @@
+/**
+ * @file src/audio_drift.h
+ * @brief Declarations for measuring and compensating audio device clock drift.
+ */
+#pragma once
+
+// standard includes
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace audio {
+
+  /**
+   * @brief Measures how fast the capture device clock runs compared to `std::chrono::steady_clock`.
+   *
+   * Every captured frame is fed with its capture time. The drift is the slope of a linear
+   * regression of the device timeline against the host timeline, with older frames slowly
+   * forgotten so the estimate follows temperature changes.
+   *
+   * On top of the measured drift, a small proportional term pulls the resampled audio timeline
+   * back onto the host clock, so latency stays constant instead of slowly wandering.
+   */
+  class drift_tracker_t {
+  public:
+    explicit drift_tracker_t(std::uint32_t sample_rate);
+
+    /**
+     * @brief Record a frame.
+     * @param capture_time When the first sample of the frame was captured.
+     * @param frames Number of samples per channel in the frame.
+     */
+    void update(std::chrono::steady_clock::time_point capture_time, std::size_t frames);
+
+    /**
+     * @brief Device clock drift in parts per million, positive when the device runs fast.
+     */
+    double drift_ppm() const;
+
+    /**
+     * @brief Output samples to produce per captured sample to stay locked to the host clock.
+     */
+    double ratio() const;
+
+    void reset();
+
+  private:
+    double sample_rate;
+
+    bool anchored = false;
+    std::chrono::steady_clock::time_point anchor;
+    double device_samples;
+    double output_samples;
+
+    // Exponentially weighted sums for the regression of device - host time against host time
+    double sum_w;
+    double sum_x;
+    double sum_y;
+    double sum_xx;
+    double sum_xy;
+
+    double host_elapsed;
+    double output_error;
+    double slope;
+    double current_ratio;
+  };
+
+  /**
+   * @brief Linear interpolation resampler with an adjustable ratio, producing fixed size frames.
+   * @details All memory is allocated up front. At a ratio of exactly 1 the samples are passed
+   *          through untouched.
+   */
+  class resampler_t {
+  public:
+    resampler_t(int channels, std::size_t frame_size);
+
+    /**
+     * @brief Append a captured frame of `frame_size` samples per channel.
+     */
+    void push(const std::vector<float> &frame);
+
+    /**
+     * @brief Produce the next output frame if enough input is buffered.
+     * @return `true` if `frame` was filled.
+     */
+    bool pop(std::vector<float> &frame);
+
+    /**
+     * @brief Set the number of output samples per input sample.
+     */
+    void set_ratio(double ratio);
+
+    /**
+     * @brief Input samples per channel that haven't been consumed yet.
+     */
+    double pending() const;
+
+  private:
+    int channels;
+    std::size_t frame_size;
+
+    std::vector<float> input;
+    std::size_t input_frames = 0;
+
+    double position = 0;
+    double step = 1;
+  };
+}  // namespace audio
@@ -23,6 +23,7 @@
 #include "config.h"
 #include "config_playnite.h"
 #include "entry_handler.h"
+#include "events.h"
 #include "file_handler.h"
 #include "httpcommon.h"
 #include "logging.h"
@@ -449,6 +450,7 @@ namespace config {
       "superfast"s,  // preset
       "zerolatency"s,  // tune
       11,  // superfast
+      false,  // pipelined_convert
     },  // software
 
     {},  // nv
@@ -517,6 +519,7 @@ namespace config {
     {},  // virtual_sink
     true,  // stream audio
     true,  // install_steam_drivers
+    true,  // silence_detection
   };
 
   stream_t stream {
@@ -1065,6 +1068,7 @@ namespace config {
       video.sw.svtav1_preset = sw::svtav1_preset_from_view(video.sw.sw_preset);
     }
     string_f(vars, "sw_tune", video.sw.sw_tune);
+    bool_f(vars, "sw_pipelined_convert", video.sw.pipelined_convert);
 
     int_between_f(vars, "nvenc_preset", video.nv.quality_preset, {1, 7});
     int_between_f(vars, "nvenc_vbv_increase", video.nv.vbv_percentage_increase, {0, 400});
@@ -1171,6 +1175,7 @@ namespace config {
     string_f(vars, "virtual_sink", audio.virtual_sink);
     bool_f(vars, "stream_audio", audio.stream);
     bool_f(vars, "install_steam_audio_drivers", audio.install_steam_drivers);
+    bool_f(vars, "audio_silence_detection", audio.silence_detection);
 
     string_restricted_f(vars, "origin_web_ui_allowed", nvhttp.origin_web_ui_allowed, {"pc"sv, "lan"sv, "wan"sv});
     // reflect origin ACL update immediately in HTTP layer
@@ -1504,6 +1509,8 @@ namespace config {
       if (sunshine.min_log_level != old_min_level && sunshine.log_file == old_log_file) {
         logging::reconfigure_min_log_level(sunshine.min_log_level);
       }
+
+      events::publish(events::event_e::config_reloaded);
     } catch (const std::exception &e) {
       BOOST_LOG(warning) << "Hot apply_config_now failed: "sv << e.what();
     }
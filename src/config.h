@@ -35,6 +35,7 @@ namespace config {
       std::string sw_preset;
       std::string sw_tune;
       std::optional<int> svtav1_preset;
+      bool pipelined_convert;  // Convert the next frame on a helper thread while the current one is encoded
     } sw;
 
     nvenc::nvenc_config nv;
@@ -152,6 +153,7 @@ namespace config {
     std::string virtual_sink;
     bool stream;
     bool install_steam_drivers;
+    bool silence_detection;  ///< Send cached silence packets instead of encoding digital silence
   };
 
   constexpr int ENCRYPTION_MODE_NEVER = 0;  // Never use video encryption, even if the client supports it
@@ -8,6 +8,8 @@
 
 // standard includes
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <boost/regex.hpp>
 #include <chrono>
 #include <filesystem>
@@ -28,14 +30,18 @@
 #include <Simple-Web-Server/server_https.hpp>
 
 // local includes
+#include "app_catalog.h"
+#include "asset_cache.h"
 #include "config.h"
 #include "confighttp.h"
 #include "crypto.h"
 #include "display_device.h"
+#include "events.h"
 #include "file_handler.h"
 #include "globals.h"
 #include "http_auth.h"
 #include "httpcommon.h"
+#include "input.h"
 #include "platform/common.h"
 #ifdef _WIN32
   #include "src/platform/windows/image_convert.h"
@@ -53,6 +59,8 @@
   #include <windows.h>
 #endif
 #include "process.h"
+#include "sse.h"
+#include "thumbnail.h"
 #include "utility.h"
 #include "uuid.h"
 
@@ -118,6 +126,20 @@ namespace confighttp {
   using resp_https_t = std::shared_ptr<typename SimpleWeb::ServerBase<SimpleWeb::HTTPS>::Response>;
   using req_https_t = std::shared_ptr<typename SimpleWeb::ServerBase<SimpleWeb::HTTPS>::Request>;
 
+  // Web UI files kept in memory
+  constexpr std::size_t WEB_CACHE_BYTES = 32 * 1024 * 1024;
+  // Size of the chunks the log is sent in, so large logs are never read into memory at once
+  constexpr std::size_t LOG_CHUNK_SIZE = 64 * 1024;
+  // Bytes queued on an event stream before the client is considered too slow and dropped
+  constexpr std::size_t SSE_MAX_PENDING = 1024 * 1024;
+  // A client that went away is only noticed when writing to it, idle event streams get a comment this often
+  constexpr auto SSE_KEEP_ALIVE_INTERVAL = std::chrono::seconds(20);
+
+  // Clients of /api/logs/stream
+  sse::hub_t log_events;
+  // Clients of /api/events
+  sse::hub_t status_events;
+
 #ifdef _WIN32
   // Forward declarations for Playnite handlers implemented in confighttp_playnite.cpp
   void getPlayniteStatus(std::shared_ptr<typename SimpleWeb::ServerBase<SimpleWeb::HTTPS>::Response> response, std::shared_ptr<typename SimpleWeb::ServerBase<SimpleWeb::HTTPS>::Request> request);
@@ -362,6 +384,67 @@ namespace confighttp {
    */
   // Consolidated redirect helper: use the const char* variant below.
 
+  /**
+   * @brief Send a file of the web UI from memory, compressed if the client accepts it.
+   * @param response The HTTP response object.
+   * @param request The HTTP request object.
+   * @param path The file.
+   * @param content_type The type of the file before compression.
+   * @param headers Additional headers.
+   */
+  void send_web_file(resp_https_t response, req_https_t request, const fs::path &path, const std::string &content_type, SimpleWeb::CaseInsensitiveMultimap headers = {}) {
+    // The whole web UI fits, along with its compressed variants
+    static http::asset_cache_t web_files {WEB_CACHE_BYTES};
+
+    auto asset = web_files.get(path);
+    if (!asset) {
+      not_found(response, request);
+      return;
+    }
+
+    headers.emplace("Content-Type", content_type);
+    headers.emplace("X-Frame-Options", "DENY");
+    headers.emplace("Content-Security-Policy", "frame-ancestors 'none';");
+    headers.emplace("Vary", "Accept-Encoding");
+
+    // Everything but the hashed build output is revalidated, see getNodeModules
+    if (headers.find("Cache-Control") == std::end(headers)) {
+      headers.emplace("Cache-Control", "no-cache");
+    }
+
+    // The web UI build writes the variants next to the files, see vite.config.ts
+    if (auto accept_encoding = request->header.find("Accept-Encoding"); accept_encoding != std::end(request->header)) {
+      static const std::array<std::pair<std::string_view, std::string_view>, 2> encodings {{{"br"sv, ".br"sv}, {"gzip"sv, ".gz"sv}}};
+
+      for (auto &[coding, extension] : encodings) {
+        if (!http::accepts_encoding(accept_encoding->second, coding)) {
+          continue;
+        }
+
+        auto variant_path = path;
+        variant_path += extension;
+
+        // A variant older than the file is left over from a previous build
+        auto variant = web_files.get(variant_path);
+        if (variant && variant->mtime >= asset->mtime) {
+          asset = std::move(variant);
+          headers.emplace("Content-Encoding", std::string {coding});
+          break;
+        }
+      }
+    }
+
+    headers.emplace("ETag", asset->etag);
+
+    auto if_none_match = request->header.find("If-None-Match");
+    if (if_none_match != std::end(request->header) && http::etag_matches(if_none_match->second, asset->etag)) {
+      response->write(redirection_not_modified, headers);
+      return;
+    }
+
+    response->write(success_ok, asset->data, headers);
+  }
+
   /**
    * @brief Get the index page.
    * @param response The HTTP response object.
@@ -374,12 +457,7 @@ namespace confighttp {
     // Frontend is expected to manage auth routes and flows.
     print_req(request);
 
-    std::string content = file_handler::read_file(WEB_DIR "index.html");
-    SimpleWeb::CaseInsensitiveMultimap headers;
-    headers.emplace("Content-Type", "text/html; charset=utf-8");
-    headers.emplace("X-Frame-Options", "DENY");
-    headers.emplace("Content-Security-Policy", "frame-ancestors 'none';");
-    response->write(content, headers);
+    send_web_file(response, request, WEB_DIR "index.html", "text/html; charset=utf-8");
   }
 
   /**
@@ -405,12 +483,7 @@ namespace confighttp {
 
     // Serve the SPA shell (index.html) without server-side auth so frontend
     // can manage routing and authentication flows.
-    std::string content = file_handler::read_file(WEB_DIR "index.html");
-    SimpleWeb::CaseInsensitiveMultimap headers;
-    headers.emplace("Content-Type", "text/html; charset=utf-8");
-    headers.emplace("X-Frame-Options", "DENY");
-    headers.emplace("Content-Security-Policy", "frame-ancestors 'none';");
-    response->write(content, headers);
+    send_web_file(response, request, WEB_DIR "index.html", "text/html; charset=utf-8");
   }
 
   /**
@@ -425,12 +498,7 @@ namespace confighttp {
 
     print_req(request);
 
-    std::string content = file_handler::read_file(WEB_DIR "pin.html");
-    SimpleWeb::CaseInsensitiveMultimap headers;
-    headers.emplace("Content-Type", "text/html; charset=utf-8");
-    headers.emplace("X-Frame-Options", "DENY");
-    headers.emplace("Content-Security-Policy", "frame-ancestors 'none';");
-    response->write(content, headers);
+    send_web_file(response, request, WEB_DIR "pin.html", "text/html; charset=utf-8");
   }
 
   /**
@@ -445,13 +513,9 @@ namespace confighttp {
 
     print_req(request);
 
-    std::string content = file_handler::read_file(WEB_DIR "apps.html");
     SimpleWeb::CaseInsensitiveMultimap headers;
-    headers.emplace("Content-Type", "text/html; charset=utf-8");
-    headers.emplace("X-Frame-Options", "DENY");
-    headers.emplace("Content-Security-Policy", "frame-ancestors 'none';");
     headers.emplace("Access-Control-Allow-Origin", "https://images.igdb.com/");
-    response->write(content, headers);
+    send_web_file(response, request, WEB_DIR "apps.html", "text/html; charset=utf-8", std::move(headers));
   }
 
   /**
@@ -466,12 +530,7 @@ namespace confighttp {
 
     print_req(request);
 
-    std::string content = file_handler::read_file(WEB_DIR "playnite.html");
-    SimpleWeb::CaseInsensitiveMultimap headers;
-    headers.emplace("Content-Type", "text/html; charset=utf-8");
-    headers.emplace("X-Frame-Options", "DENY");
-    headers.emplace("Content-Security-Policy", "frame-ancestors 'none';");
-    response->write(content, headers);
+    send_web_file(response, request, WEB_DIR "playnite.html", "text/html; charset=utf-8");
   }
 
   /**
@@ -486,12 +545,7 @@ namespace confighttp {
 
     print_req(request);
 
-    std::string content = file_handler::read_file(WEB_DIR "clients.html");
-    SimpleWeb::CaseInsensitiveMultimap headers;
-    headers.emplace("Content-Type", "text/html; charset=utf-8");
-    headers.emplace("X-Frame-Options", "DENY");
-    headers.emplace("Content-Security-Policy", "frame-ancestors 'none';");
-    response->write(content, headers);
+    send_web_file(response, request, WEB_DIR "clients.html", "text/html; charset=utf-8");
   }
 
   /**
@@ -506,12 +560,7 @@ namespace confighttp {
 
     print_req(request);
 
-    std::string content = file_handler::read_file(WEB_DIR "config.html");
-    SimpleWeb::CaseInsensitiveMultimap headers;
-    headers.emplace("Content-Type", "text/html; charset=utf-8");
-    headers.emplace("X-Frame-Options", "DENY");
-    headers.emplace("Content-Security-Policy", "frame-ancestors 'none';");
-    response->write(content, headers);
+    send_web_file(response, request, WEB_DIR "config.html", "text/html; charset=utf-8");
   }
 
   /**
@@ -526,12 +575,7 @@ namespace confighttp {
 
     print_req(request);
 
-    std::string content = file_handler::read_file(WEB_DIR "password.html");
-    SimpleWeb::CaseInsensitiveMultimap headers;
-    headers.emplace("Content-Type", "text/html; charset=utf-8");
-    headers.emplace("X-Frame-Options", "DENY");
-    headers.emplace("Content-Security-Policy", "frame-ancestors 'none';");
-    response->write(content, headers);
+    send_web_file(response, request, WEB_DIR "password.html", "text/html; charset=utf-8");
   }
 
   /**
@@ -545,12 +589,7 @@ namespace confighttp {
       send_redirect(response, request, "/");
       return;
     }
-    std::string content = file_handler::read_file(WEB_DIR "welcome.html");
-    SimpleWeb::CaseInsensitiveMultimap headers;
-    headers.emplace("Content-Type", "text/html; charset=utf-8");
-    headers.emplace("X-Frame-Options", "DENY");
-    headers.emplace("Content-Security-Policy", "frame-ancestors 'none';");
-    response->write(content, headers);
+    send_web_file(response, request, WEB_DIR "welcome.html", "text/html; charset=utf-8");
   }
 
   /**
@@ -561,10 +600,7 @@ namespace confighttp {
   void getLoginPage(resp_https_t response, req_https_t request) {
     print_req(request);
 
-    std::string content = file_handler::read_file(WEB_DIR "login.html");
-    SimpleWeb::CaseInsensitiveMultimap headers;
-    headers.emplace("Content-Type", "text/html; charset=utf-8");
-    response->write(content, headers);
+    send_web_file(response, request, WEB_DIR "login.html", "text/html; charset=utf-8");
   }
 
   /**
@@ -579,12 +615,7 @@ namespace confighttp {
 
     print_req(request);
 
-    std::string content = file_handler::read_file(WEB_DIR "troubleshooting.html");
-    SimpleWeb::CaseInsensitiveMultimap headers;
-    headers.emplace("Content-Type", "text/html; charset=utf-8");
-    headers.emplace("X-Frame-Options", "DENY");
-    headers.emplace("Content-Security-Policy", "frame-ancestors 'none';");
-    response->write(content, headers);
+    send_web_file(response, request, WEB_DIR "troubleshooting.html", "text/html; charset=utf-8");
   }
 
   /**
@@ -597,12 +628,7 @@ namespace confighttp {
   void getFaviconImage(resp_https_t response, req_https_t request) {
     print_req(request);
 
-    std::ifstream in(WEB_DIR "images/sunshine.ico", std::ios::binary);
-    SimpleWeb::CaseInsensitiveMultimap headers;
-    headers.emplace("Content-Type", "image/x-icon");
-    headers.emplace("X-Frame-Options", "DENY");
-    headers.emplace("Content-Security-Policy", "frame-ancestors 'none';");
-    response->write(success_ok, in, headers);
+    send_web_file(response, request, WEB_DIR "images/sunshine.ico", "image/x-icon");
   }
 
   /**
@@ -615,12 +641,7 @@ namespace confighttp {
   void getSunshineLogoImage(resp_https_t response, req_https_t request) {
     print_req(request);
 
-    std::ifstream in(WEB_DIR "images/logo-sunshine-45.png", std::ios::binary);
-    SimpleWeb::CaseInsensitiveMultimap headers;
-    headers.emplace("Content-Type", "image/png");
-    headers.emplace("X-Frame-Options", "DENY");
-    headers.emplace("Content-Security-Policy", "frame-ancestors 'none';");
-    response->write(success_ok, in, headers);
+    send_web_file(response, request, WEB_DIR "images/logo-sunshine-45.png", "image/png");
   }
 
   /**
@@ -668,13 +689,14 @@ namespace confighttp {
       return;
     }
 
-    // if it is, set the content type to the mime type
+    // The web UI build replaces a hashed file by a file with another name, see vite.config.ts
     SimpleWeb::CaseInsensitiveMultimap headers;
-    headers.emplace("Content-Type", mimeType->second);
-    headers.emplace("X-Frame-Options", "DENY");
-    headers.emplace("Content-Security-Policy", "frame-ancestors 'none';");
-    std::ifstream in(filePath.string(), std::ios::binary);
-    response->write(success_ok, in, headers);
+    if (http::is_hashed_name(filePath.filename().string())) {
+      headers.emplace("Cache-Control", "public, max-age=31536000, immutable");
+    }
+
+    // if it is, set the content type to the mime type
+    send_web_file(response, request, filePath, mimeType->second, std::move(headers));
   }
 
   /**
@@ -692,12 +714,11 @@ namespace confighttp {
     print_req(request);
 
     try {
-      std::string content = file_handler::read_file(config::stream.file_apps.c_str());
-      nlohmann::json file_tree = nlohmann::json::parse(content);
+      auto apps = app_catalog::apps(config::stream.file_apps);
 
       // Legacy versions of Sunshine used strings for boolean and integers, let's convert them
       // List of keys to convert to boolean
-      std::vector<std::string> boolean_keys = {
+      static const std::vector<std::string> boolean_keys = {
         "exclude-global-prep-cmd",
         "elevated",
         "auto-detach",
@@ -705,47 +726,74 @@ namespace confighttp {
       };
 
       // List of keys to convert to integers
-      std::vector<std::string> integer_keys = {
+      static const std::vector<std::string> integer_keys = {
         "exit-timeout"
       };
 
-      bool mutated = false;
+      auto is_legacy_value = [](const nlohmann::json &node, const std::string &key) {
+        return node.contains(key) && node[key].is_string();
+      };
+
+      // Check the shared snapshot first, once normalized it can be sent without copying
+      auto needs_normalization = [&](const nlohmann::json &app) {
+        for (const auto &key : boolean_keys) {
+          if (is_legacy_value(app, key)) {
+            return true;
+          }
+        }
+        for (const auto &key : integer_keys) {
+          if (is_legacy_value(app, key)) {
+            return true;
+          }
+        }
+        if (app.contains("prep-cmd")) {
+          for (const auto &prep : app["prep-cmd"]) {
+            if (is_legacy_value(prep, "elevated")) {
+              return true;
+            }
+          }
+        }
+        return !app.contains("uuid") || app["uuid"].is_null() || (app["uuid"].is_string() && app["uuid"].get<std::string>().empty());
+      };
+
+      auto apps_it = apps->find("apps");
+      if (apps_it == apps->end() || std::none_of(apps_it->begin(), apps_it->end(), needs_normalization)) {
+        send_response(response, *apps);
+        return;
+      }
+
+      nlohmann::json file_tree = *apps;
+
       // Walk fileTree and convert true/false strings to boolean or integer values
       for (auto &app : file_tree["apps"]) {
         for (const auto &key : boolean_keys) {
-          if (app.contains(key) && app[key].is_string()) {
+          if (is_legacy_value(app, key)) {
             app[key] = app[key] == "true";
-            mutated = true;
           }
         }
         for (const auto &key : integer_keys) {
-          if (app.contains(key) && app[key].is_string()) {
+          if (is_legacy_value(app, key)) {
             app[key] = std::stoi(app[key].get<std::string>());
-            mutated = true;
           }
         }
         if (app.contains("prep-cmd")) {
           for (auto &prep : app["prep-cmd"]) {
-            if (prep.contains("elevated") && prep["elevated"].is_string()) {
+            if (is_legacy_value(prep, "elevated")) {
               prep["elevated"] = prep["elevated"] == "true";
-              mutated = true;
             }
           }
         }
         // Ensure each app has a UUID (auto-insert if missing/empty)
         if (!app.contains("uuid") || app["uuid"].is_null() || (app["uuid"].is_string() && app["uuid"].get<std::string>().empty())) {
           app["uuid"] = uuid_util::uuid_t::generate().string();
-          mutated = true;
         }
       }
 
-      // If any normalization occurred, persist back to disk
-      if (mutated) {
-        try {
-          file_handler::write_file(config::stream.file_apps.c_str(), file_tree.dump(4));
-        } catch (std::exception &e) {
-          BOOST_LOG(warning) << "GetApps persist normalization failed: "sv << e.what();
-        }
+      // Persist the normalization back to disk
+      try {
+        file_handler::write_file(config::stream.file_apps.c_str(), file_tree.dump(4));
+      } catch (std::exception &e) {
+        BOOST_LOG(warning) << "GetApps persist normalization failed: "sv << e.what();
       }
 
       send_response(response, file_tree);
@@ -803,9 +851,7 @@ namespace confighttp {
       // TODO: Input Validation
       nlohmann::json output_tree;
       nlohmann::json input_tree = nlohmann::json::parse(ss);
-      std::string file = file_handler::read_file(config::stream.file_apps.c_str());
-      BOOST_LOG(info) << file;
-      nlohmann::json file_tree = nlohmann::json::parse(file);
+      nlohmann::json file_tree = *app_catalog::apps(config::stream.file_apps);
 
       if (input_tree["prep-cmd"].empty()) {
         input_tree.erase("prep-cmd");
@@ -917,8 +963,7 @@ namespace confighttp {
     try {
       nlohmann::json output_tree;
       nlohmann::json new_apps = nlohmann::json::array();
-      std::string file = file_handler::read_file(config::stream.file_apps.c_str());
-      nlohmann::json file_tree = nlohmann::json::parse(file);
+      nlohmann::json file_tree = *app_catalog::apps(config::stream.file_apps);
       auto &apps_node = file_tree["apps"];
       const int index = std::stoi(request->path_match[1]);
 
@@ -1312,6 +1357,47 @@ namespace confighttp {
     }
   }
 
+  /**
+   * @brief Queue Server-Sent Events on a response as they are published.
+   * @param response The HTTP response object, with the headers already sent.
+   * @return The sender to subscribe to a hub.
+   */
+  sse::hub_t::send_t sse_sender(resp_https_t response) {
+    auto pending = std::make_shared<std::atomic<std::size_t>>(0);
+    auto closed = std::make_shared<std::atomic_bool>(false);
+
+    return [response, pending, closed](const std::string &chunk) {
+      // Drop clients that are gone, or too slow to keep up, rather than buffering without bounds
+      if (*closed || *pending > SSE_MAX_PENDING) {
+        return false;
+      }
+
+      *pending += chunk.size();
+      *response << chunk;
+      response->send([pending, closed, size = chunk.size()](const SimpleWeb::error_code &ec) {
+        *pending -= size;
+        if (ec) {
+          *closed = true;
+        }
+      });
+
+      return true;
+    };
+  }
+
+  /**
+   * @brief Get the number of streaming sessions and whether an app is running.
+   */
+  nlohmann::json session_status() {
+    nlohmann::json output_tree;
+    const int active = rtsp_stream::session_count();
+    const bool app_running = proc::proc.running() > 0;
+    output_tree["activeSessions"] = active;
+    output_tree["appRunning"] = app_running;
+    output_tree["paused"] = app_running && active == 0;
+    return output_tree;
+  }
+
   // Lightweight session status for UI messaging
   void getSessionStatus(resp_https_t response, req_https_t request) {
     if (!authenticate(response, request)) {
@@ -1319,12 +1405,120 @@ namespace confighttp {
     }
     print_req(request);
 
+    nlohmann::json output_tree = session_status();
+    output_tree["status"] = true;
+    send_response(response, output_tree);
+  }
+
+  /**
+   * @brief Push changes of the server state as Server-Sent Events, instead of polling for them.
+   * @param response The HTTP response object.
+   * @param request The HTTP request object.
+   *
+   * Every change is sent as a `status` event with the session status, as returned by `GET /api/session/status`,
+   * and the name of the change in `event`: `session_started`, `session_stopped`, `app_launched`, `app_exited`,
+   * `client_paired`, `client_unpaired` or `config_reloaded`. The first event is `connected`, with the current status.
+   *
+   * @api_examples{/api/events| GET| null}
+   */
+  void getEvents(resp_https_t response, req_https_t request) {
+    if (!authenticate(response, request)) {
+      return;
+    }
+
+    print_req(request);
+
+    SimpleWeb::CaseInsensitiveMultimap headers;
+    headers.emplace("Content-Type", "text/event-stream");
+    headers.emplace("Cache-Control", "no-cache");
+    headers.emplace("X-Frame-Options", "DENY");
+    headers.emplace("Content-Security-Policy", "frame-ancestors 'none';");
+
+    // The response never ends, the connection can't be reused
+    response->close_connection_after_response = true;
+    response->write(success_ok, headers);
+
+    auto output_tree = session_status();
+    output_tree["event"] = "connected";
+    *response << sse::event(output_tree.dump(), "status"sv);
+    response->send();
+
+    status_events.subscribe(sse_sender(response));
+  }
+
+  /**
+   * @brief Summarize a latency histogram, in microseconds.
+   */
+  nlohmann::json histogram_json(const stat_trackers::latency_histogram &histogram) {
+    nlohmann::json stage;
+    stage["mean"] = histogram.mean().count();
+    stage["p50"] = histogram.percentile(50).count();
+    stage["p90"] = histogram.percentile(90).count();
+    stage["p99"] = histogram.percentile(99).count();
+    return stage;
+  }
+
+  /**
+   * @brief Get the latency of input from receipt on the control stream until it is sent to the OS.
+   * @param response The HTTP response object.
+   * @param request The HTTP request object.
+   *
+   * Durations are in microseconds and cover every session since startup, per event type.
+   *
+   * @api_examples{/api/input/stats| GET| null}
+   */
+  void getInputStats(resp_https_t response, req_https_t request) {
+    if (!authenticate(response, request)) {
+      return;
+    }
+    print_req(request);
+
     nlohmann::json output_tree;
-    const int active = rtsp_stream::session_count();
-    const bool app_running = proc::proc.running() > 0;
-    output_tree["activeSessions"] = active;
-    output_tree["appRunning"] = app_running;
-    output_tree["paused"] = app_running && active == 0;
+    for (std::size_t x = 0; x < (std::size_t) input::event_type_e::_count; ++x) {
+      auto type = (input::event_type_e) x;
+      auto &stats = input::latency_stats(type);
+
+      nlohmann::json type_tree;
+      type_tree["events"] = stats.total.count();
+      type_tree["coalesced"] = stats.coalesced.load(std::memory_order_relaxed);
+      type_tree["decrypt"] = histogram_json(stats.decrypt);
+      type_tree["queue"] = histogram_json(stats.queue);
+      type_tree["batch"] = histogram_json(stats.batch);
+      type_tree["inject"] = histogram_json(stats.inject);
+      type_tree["total"] = histogram_json(stats.total);
+      output_tree["input"][std::string {input::to_string(type)}] = type_tree;
+    }
+    output_tree["status"] = true;
+    send_response(response, output_tree);
+  }
+
+  /**
+   * @brief Get the TLS handshakes of the GameStream HTTPS server.
+   * @param response The HTTP response object.
+   * @param request The HTTP request object.
+   *
+   * Handshakes of resumed sessions skip the key exchange and client certificate, comparing
+   * both kinds shows the CPU saved. Durations are in microseconds, rates in handshakes per second.
+   *
+   * @api_examples{/api/tls/stats| GET| null}
+   */
+  void getTlsStats(resp_https_t response, req_https_t request) {
+    if (!authenticate(response, request)) {
+      return;
+    }
+    print_req(request);
+
+    auto &stats = nvhttp::tls_stats();
+    auto uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - stats.since).count();
+
+    nlohmann::json output_tree;
+    for (auto [name, histogram] : {std::pair {"full", &stats.full}, std::pair {"resumed", &stats.resumed}}) {
+      auto tree = histogram_json(*histogram);
+      tree["handshakes"] = histogram->count();
+      tree["rate"] = histogram->count() / uptime;
+      output_tree["tls"][name] = tree;
+    }
+    output_tree["tls"]["failed"] = stats.failed.load(std::memory_order_relaxed);
     output_tree["status"] = true;
     send_response(response, output_tree);
   }
@@ -1473,6 +1667,9 @@ namespace confighttp {
         return;
       }
 
+      // Have the scaled down covers ready before clients next load the app list
+      thumbnail::refresh(dest_png);
+
       output_tree["status"] = true;
       output_tree["path"] = dest_png;
       send_response(response, output_tree);
@@ -1496,8 +1693,7 @@ namespace confighttp {
     try {
       nlohmann::json output_tree;
       nlohmann::json new_apps = nlohmann::json::array();
-      std::string file = file_handler::read_file(config::stream.file_apps.c_str());
-      nlohmann::json file_tree = nlohmann::json::parse(file);
+      nlohmann::json file_tree = *app_catalog::apps(config::stream.file_apps);
       auto &apps_node = file_tree["apps"];
 
       int removed = 0;
@@ -1521,11 +1717,45 @@ namespace confighttp {
     }
   }
 
+  /**
+   * @brief Send the rest of a file in chunks, without reading all of it into memory.
+   * @param response The HTTP response object, with the headers already written.
+   * @param file The file, positioned at the first byte to send.
+   * @param remaining The number of bytes to send.
+   */
+  void send_file_chunks(resp_https_t response, std::shared_ptr<std::ifstream> file, std::uintmax_t remaining) {
+    std::array<char, LOG_CHUNK_SIZE> buf;
+    file->read(buf.data(), (std::streamsize) std::min<std::uintmax_t>(remaining, buf.size()));
+    auto read = file->gcount();
+    if (read <= 0) {
+      // The file shrank since the Content-Length was sent
+      response->close_connection_after_response = true;
+      return;
+    }
+
+    response->write(buf.data(), read);
+    remaining -= read;
+    if (remaining == 0) {
+      return;
+    }
+
+    response->send([response, file, remaining](const SimpleWeb::error_code &ec) {
+      if (!ec) {
+        send_file_chunks(response, file, remaining);
+      }
+    });
+  }
+
   /**
    * @brief Get the logs from the log file.
    * @param response The HTTP response object.
    * @param request The HTTP request object.
    *
+   * A `Range` header with a single byte range, e.g. `bytes=1024-`, only returns that part of the log
+   * with `206 Partial Content`. The `Content-Range` header of the response holds the offset to request next.
+   * `416 Range Not Satisfiable` means nothing was written since, or the log was restarted
+   * if the size in `Content-Range` is smaller than the offset.
+   *
    * @api_examples{/api/logs| GET| null}
    */
   void getLogs(resp_https_t response, req_https_t request) {
@@ -1535,12 +1765,78 @@ namespace confighttp {
 
     print_req(request);
 
-    std::string content = file_handler::read_file(config::sunshine.log_file.c_str());
     SimpleWeb::CaseInsensitiveMultimap headers;
     headers.emplace("Content-Type", "text/plain");
     headers.emplace("X-Frame-Options", "DENY");
     headers.emplace("Content-Security-Policy", "frame-ancestors 'none';");
-    response->write(success_ok, content, headers);
+    headers.emplace("Accept-Ranges", "bytes");
+
+    auto file = std::make_shared<std::ifstream>(config::sunshine.log_file, std::ios::binary);
+    std::error_code ec;
+    auto size = fs::file_size(config::sunshine.log_file, ec);
+    if (!*file || ec) {
+      response->write(success_ok, headers);
+      return;
+    }
+
+    auto status = success_ok;
+    std::uintmax_t first = 0;
+    std::uintmax_t length = size;
+    if (auto range_header = request->header.find("Range"); range_header != request->header.end()) {
+      if (auto range = http::parse_range(range_header->second, size)) {
+        if (!range->satisfiable) {
+          headers.emplace("Content-Range", std::format("bytes */{}", size));
+          response->write(client_error_range_not_satisfiable, headers);
+          return;
+        }
+
+        status = success_partial_content;
+        first = range->first;
+        length = range->last - range->first + 1;
+        headers.emplace("Content-Range", std::format("bytes {}-{}/{}", range->first, range->last, size));
+      }
+    }
+
+    if (length == 0) {
+      response->write(status, headers);
+      return;
+    }
+
+    headers.emplace("Content-Length", std::to_string(length));
+    response->write(status, headers);
+
+    file->seekg((std::streamoff) first);
+    send_file_chunks(response, file, length);
+  }
+
+  /**
+   * @brief Push new log lines as Server-Sent Events, as they are written to the log file.
+   * @param response The HTTP response object.
+   * @param request The HTTP request object.
+   *
+   * Every line is sent as a `log` event. Use `GET /api/logs` for the lines written before connecting.
+   *
+   * @api_examples{/api/logs/stream| GET| null}
+   */
+  void getLogStream(resp_https_t response, req_https_t request) {
+    if (!authenticate(response, request)) {
+      return;
+    }
+
+    print_req(request);
+
+    SimpleWeb::CaseInsensitiveMultimap headers;
+    headers.emplace("Content-Type", "text/event-stream");
+    headers.emplace("Cache-Control", "no-cache");
+    headers.emplace("X-Frame-Options", "DENY");
+    headers.emplace("Content-Security-Policy", "frame-ancestors 'none';");
+
+    // The response never ends, the connection can't be reused
+    response->close_connection_after_response = true;
+    response->write(success_ok, headers);
+    response->send();
+
+    log_events.subscribe(sse_sender(response));
   }
 
 #ifdef _WIN32
@@ -1839,6 +2135,7 @@ namespace confighttp {
     server.resource["^/api/pin$"]["POST"] = savePin;
     server.resource["^/api/apps$"]["GET"] = getApps;
     server.resource["^/api/logs$"]["GET"] = getLogs;
+    server.resource["^/api/logs/stream$"]["GET"] = getLogStream;
     server.resource["^/api/apps$"]["POST"] = saveApp;
     server.resource["^/api/config$"]["GET"] = getConfig;
     server.resource["^/api/config$"]["POST"] = saveConfig;
@@ -1856,6 +2153,9 @@ namespace confighttp {
     server.resource["^/api/clients/unpair$"]["POST"] = unpair;
     server.resource["^/api/apps/close$"]["POST"] = closeApp;
     server.resource["^/api/session/status$"]["GET"] = getSessionStatus;
+    server.resource["^/api/events$"]["GET"] = getEvents;
+    server.resource["^/api/input/stats$"]["GET"] = getInputStats;
+    server.resource["^/api/tls/stats$"]["GET"] = getTlsStats;
     // Keep legacy cover upload endpoint present in upstream master
     server.resource["^/api/covers/upload$"]["POST"] = uploadCover;
     server.resource["^/api/apps/purge_autosync$"]["POST"] = purgeAutoSyncedApps;
@@ -1903,17 +2203,50 @@ namespace confighttp {
 
     api_token_manager.load_api_tokens();
 
-    // Start a background task to clean up expired session tokens every hour
+    auto log_listener = logging::listen([](std::string_view line) {
+      if (!log_events.empty()) {
+        log_events.publish(sse::event(line, "log"sv));
+      }
+    });
+
+    auto event_subscription = events::subscribe([](events::event_e event) {
+      if (status_events.empty()) {
+        return;
+      }
+
+      // Publishers may hold locks that getting the session status needs, build the event on the task pool
+      task_pool.post([event]() {
+        auto output_tree = session_status();
+        output_tree["event"] = std::string {events::to_string(event)};
+        status_events.publish(sse::event(output_tree.dump(), "status"sv));
+      });
+    });
+
+    // Start a background task to keep the event streams alive and clean up expired session tokens every hour
     std::jthread cleanup_thread([shutdown_event]() {
-      while (!shutdown_event->peek()) {
-        std::this_thread::sleep_for(std::chrono::hours(1));
-        session_token_manager.cleanup_expired_session_tokens();
+      auto keep_alive = sse::comment("keep-alive"sv);
+      auto next_cleanup = std::chrono::steady_clock::now() + std::chrono::hours(1);
+
+      while (!shutdown_event->view(SSE_KEEP_ALIVE_INTERVAL)) {
+        log_events.publish(keep_alive);
+        status_events.publish(keep_alive);
+
+        if (std::chrono::steady_clock::now() >= next_cleanup) {
+          session_token_manager.cleanup_expired_session_tokens();
+          next_cleanup += std::chrono::hours(1);
+        }
       }
     });
 
     // Wait for any event
     shutdown_event->view();
 
+    // Release the streaming responses while their connections can still be closed
+    log_listener.reset();
+    log_events.clear();
+    event_subscription.reset();
+    status_events.clear();
+
     server.stop();
 
     tcp.join();
@@ -1935,10 +2268,7 @@ namespace confighttp {
       return;
     }
     print_req(request);
-    std::string content = file_handler::read_file(WEB_DIR "api-tokens.html");
-    SimpleWeb::CaseInsensitiveMultimap headers;
-    headers.emplace("Content-Type", "text/html; charset=utf-8");
-    response->write(content, headers);
+    send_web_file(response, request, WEB_DIR "api-tokens.html", "text/html; charset=utf-8");
   }
 
   /**
@@ -3,8 +3,10 @@
  * @brief Definitions for cryptography functions.
  */
 // lib includes
+#include <openssl/crypto.h>
 #include <openssl/pem.h>
 #include <openssl/rsa.h>
+#include <openssl/x509v3.h>
 
 // local includes
 #include "crypto.h"
@@ -17,15 +19,64 @@ namespace crypto {
       _cert_ctx {X509_STORE_CTX_new()} {
   }
 
+  std::optional<sha256_t> fingerprint(x509_t::element_type *cert) {
+    sha256_t digest;
+    unsigned int len = digest.size();
+    if (!X509_digest(cert, EVP_sha256(), digest.data(), &len)) {
+      return std::nullopt;
+    }
+
+    return digest;
+  }
+
+  static std::optional<sha256_t> key_digest(x509_t::element_type *cert) {
+    sha256_t digest;
+    unsigned int len = digest.size();
+    if (!X509_pubkey_digest(cert, EVP_sha256(), digest.data(), &len)) {
+      return std::nullopt;
+    }
+
+    return digest;
+  }
+
   void cert_chain_t::add(x509_t &&cert) {
+    std::lock_guard lg {_lock};
+    insert(std::move(cert));
+  }
+
+  void cert_chain_t::assign(std::vector<x509_t> &&certs) {
+    std::lock_guard lg {_lock};
+
+    _certs.clear();
+    _by_fingerprint.clear();
+    _by_key.clear();
+    for (auto &cert : certs) {
+      insert(std::move(cert));
+    }
+  }
+
+  void cert_chain_t::insert(x509_t &&cert) {
     x509_store_t x509_store {X509_STORE_new()};
 
     X509_STORE_add_cert(x509_store.get(), cert.get());
+
+    auto index = _certs.size();
+    if (auto digest = fingerprint(cert.get())) {
+      _by_fingerprint.emplace(*digest, index);
+    }
+    if (auto digest = key_digest(cert.get())) {
+      _by_key.emplace(*digest, index);
+    }
+
     _certs.emplace_back(std::make_pair(std::move(cert), std::move(x509_store)));
   }
 
   void cert_chain_t::clear() {
+    std::lock_guard lg {_lock};
+
     _certs.clear();
+    _by_fingerprint.clear();
+    _by_key.clear();
   }
 
   static int openssl_verify_cb(int ok, X509_STORE_CTX *ctx) {
@@ -46,6 +97,26 @@ namespace crypto {
     }
   }
 
+  int cert_chain_t::verify(x509_store_t::element_type *x509_store, x509_t::element_type *cert) {
+    auto fg = util::fail_guard([this]() {
+      X509_STORE_CTX_cleanup(_cert_ctx.get());
+    });
+
+    X509_STORE_CTX_init(_cert_ctx.get(), x509_store, cert, nullptr);
+    X509_STORE_CTX_set_verify_cb(_cert_ctx.get(), openssl_verify_cb);
+
+    // We don't care to validate the entire chain for the purposes of client auth.
+    // Some versions of clients forked from Moonlight Embedded produce client certs
+    // that OpenSSL doesn't detect as self-signed due to some X509v3 extensions.
+    X509_STORE_CTX_set_flags(_cert_ctx.get(), X509_V_FLAG_PARTIAL_CHAIN);
+
+    if (X509_verify_cert(_cert_ctx.get()) == 1) {
+      return X509_V_OK;
+    }
+
+    return X509_STORE_CTX_get_error(_cert_ctx.get());
+  }
+
   /**
    * @brief Verify the certificate chain.
    * When certificates from two or more instances of Moonlight have been added to x509_store_t,
@@ -53,34 +124,52 @@ namespace crypto {
    * Moonlight to be able to use Sunshine
    *
    * To circumvent this, x509_store_t instance will be created for each instance of the certificates.
+   * Only the stores that could possibly verify the certificate are tried: the one holding the same
+   * certificate, then the ones holding a certificate with the same key for a self-signed certificate.
    * @param cert The certificate to verify.
    * @return nullptr if the certificate is valid, otherwise an error string.
    */
   const char *cert_chain_t::verify(x509_t::element_type *cert) {
-    int err_code = 0;
-    for (auto &[_, x509_store] : _certs) {
-      auto fg = util::fail_guard([this]() {
-        X509_STORE_CTX_cleanup(_cert_ctx.get());
-      });
-
-      X509_STORE_CTX_init(_cert_ctx.get(), x509_store.get(), cert, nullptr);
-      X509_STORE_CTX_set_verify_cb(_cert_ctx.get(), openssl_verify_cb);
+    std::lock_guard lg {_lock};
 
-      // We don't care to validate the entire chain for the purposes of client auth.
-      // Some versions of clients forked from Moonlight Embedded produce client certs
-      // that OpenSSL doesn't detect as self-signed due to some X509v3 extensions.
-      X509_STORE_CTX_set_flags(_cert_ctx.get(), X509_V_FLAG_PARTIAL_CHAIN);
+    if (auto digest = fingerprint(cert)) {
+      if (auto it = _by_fingerprint.find(*digest); it != std::end(_by_fingerprint)) {
+        auto err_code = verify(_certs[it->second].second.get(), cert);
 
-      auto err = X509_verify_cert(_cert_ctx.get());
-
-      if (err == 1) {
-        return nullptr;
+        return err_code == X509_V_OK ? nullptr : X509_verify_cert_error_string(err_code);
       }
+    }
 
-      err_code = X509_STORE_CTX_get_error(_cert_ctx.get());
+    int err_code = 0;
+    auto try_store = [&](std::size_t index) {
+      err_code = verify(_certs[index].second.get(), cert);
+
+      // Any other error means this store was the right one and the certificate is invalid
+      return err_code == X509_V_OK || (err_code != X509_V_ERR_DEPTH_ZERO_SELF_SIGNED_CERT && err_code != X509_V_ERR_INVALID_CA);
+    };
+
+    auto self_signed = X509_check_issued(cert, cert) == X509_V_OK;
+    if (self_signed) {
+      auto digest = key_digest(cert);
+      if (digest) {
+        auto [begin, end] = _by_key.equal_range(*digest);
+        for (auto it = begin; it != end; ++it) {
+          if (try_store(it->second)) {
+            return err_code == X509_V_OK ? nullptr : X509_verify_cert_error_string(err_code);
+          }
+        }
+      }
 
-      if (err_code != X509_V_ERR_DEPTH_ZERO_SELF_SIGNED_CERT && err_code != X509_V_ERR_INVALID_CA) {
-        return X509_verify_cert_error_string(err_code);
+      // No paired certificate shares its key, every store would have rejected it as self-signed
+      if (!_certs.empty()) {
+        err_code = X509_V_ERR_DEPTH_ZERO_SELF_SIGNED_CERT;
+      }
+    } else {
+      // Issued by some other certificate, which could be any of the paired ones
+      for (std::size_t x = 0; x < _certs.size(); ++x) {
+        if (try_store(x)) {
+          return err_code == X509_V_OK ? nullptr : X509_verify_cert_error_string(err_code);
+        }
       }
     }
 
@@ -508,4 +597,8 @@ namespace crypto {
     return value;
   }
 
+  bool constant_time_equal(const std::string_view &a, const std::string_view &b) {
+    return a.size() == b.size() && CRYPTO_memcmp(a.data(), b.data(), a.size()) == 0;
+  }
+
 }  // namespace crypto
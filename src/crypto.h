@@ -6,6 +6,11 @@
 
 // standard includes
 #include <array>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 // lib includes
 #include <openssl/evp.h>
@@ -60,19 +65,69 @@ namespace crypto {
   std::string rand(std::size_t bytes);
   std::string rand_alphabet(std::size_t bytes, const std::string_view &alphabet = std::string_view {"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789!%&()=-"});
 
+  /**
+   * @brief Compare two secrets without leaking where they differ through timing.
+   * @details Only the length is compared in variable time.
+   */
+  bool constant_time_equal(const std::string_view &a, const std::string_view &b);
+
+  /**
+   * @brief SHA-256 of the DER encoding of a certificate.
+   */
+  std::optional<sha256_t> fingerprint(x509_t::element_type *cert);
+
+  /**
+   * @brief The certificates of the paired clients.
+   * @details Certificates are indexed by fingerprint, so verifying a paired client costs one
+   *          lookup and one signature check however many clients are paired. The chain may be
+   *          changed on one thread while requests are verified on another.
+   */
   class cert_chain_t {
   public:
-    KITTY_DECL_CONSTR(cert_chain_t)
+    cert_chain_t();
 
     void add(x509_t &&cert);
 
+    /**
+     * @brief Replace all certificates at once, verification never sees only some of them.
+     * @param certs The new certificates.
+     */
+    void assign(std::vector<x509_t> &&certs);
+
     void clear();
 
     const char *verify(x509_t::element_type *cert);
 
   private:
+    struct digest_hash_t {
+      std::size_t operator()(const sha256_t &digest) const noexcept {
+        std::size_t hash;
+        std::memcpy(&hash, digest.data(), sizeof(hash));
+        return hash;
+      }
+    };
+
+    /**
+     * @brief Verify a certificate against the store of a single paired client.
+     * @return `X509_V_OK` or the verification error.
+     */
+    int verify(x509_store_t::element_type *x509_store, x509_t::element_type *cert);
+
+    /**
+     * @brief Add a certificate, with `_lock` held.
+     */
+    void insert(x509_t &&cert);
+
+    std::mutex _lock;
+
     std::vector<std::pair<x509_t, x509_store_t>> _certs;
     x509_store_ctx_t _cert_ctx;
+
+    // Index into _certs by certificate fingerprint
+    std::unordered_map<sha256_t, std::size_t, digest_hash_t> _by_fingerprint;
+
+    // Index into _certs by SHA-256 of the public key, a self-signed certificate can only chain to these
+    std::unordered_multimap<sha256_t, std::size_t, digest_hash_t> _by_key;
   };
 
   namespace cipher {
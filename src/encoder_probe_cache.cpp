@@ -0,0 +1,132 @@
+/**
+ * @file src/encoder_probe_cache.cpp
+ * @brief Definitions for the persistent cache of encoder probe results.
+ */
+// standard includes
+#include <algorithm>
+
+// lib includes
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+// local includes
+#include "encoder_probe_cache.h"
+#include "logging.h"
+
+using namespace std::literals;
+
+namespace video {
+  namespace fs = std::filesystem;
+  namespace pt = boost::property_tree;
+
+  encoder_probe_cache_t::encoder_probe_cache_t(std::filesystem::path file, std::size_t max_entries):
+      file {std::move(file)},
+      max_entries {max_entries} {
+  }
+
+  std::string encoder_probe_cache_t::make_key(const std::vector<std::string_view> &parts) {
+    std::string key;
+    for (auto part : parts) {
+      // Length prefixed, so no choice of separator can make two different keys collide
+      key += std::to_string(part.size());
+      key += ':';
+      key += part;
+      key += ';';
+    }
+
+    return key;
+  }
+
+  std::optional<encoder_probe_cache_t::entry_t> encoder_probe_cache_t::get(const std::string &key) {
+    std::lock_guard lg {lock};
+    load();
+
+    auto it = entries.find(key);
+    if (it == std::end(entries)) {
+      return std::nullopt;
+    }
+
+    return it->second.entry;
+  }
+
+  void encoder_probe_cache_t::put(const std::string &key, const entry_t &entry) {
+    std::lock_guard lg {lock};
+    load();
+
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    entries.insert_or_assign(key, stored_entry_t {entry, now});
+
+    while (entries.size() > max_entries) {
+      auto oldest = std::ranges::min_element(entries, {}, [](auto &pair) {
+        return pair.second.updated;
+      });
+      entries.erase(oldest);
+    }
+
+    save();
+  }
+
+  void encoder_probe_cache_t::clear() {
+    std::lock_guard lg {lock};
+
+    entries.clear();
+    loaded = true;
+
+    std::error_code ec;
+    fs::remove(file, ec);
+  }
+
+  void encoder_probe_cache_t::load() {
+    if (loaded) {
+      return;
+    }
+    loaded = true;
+
+    if (!fs::exists(file)) {
+      return;
+    }
+
+    try {
+      pt::ptree tree;
+      pt::read_json(file.string(), tree);
+
+      for (auto &[_, node] : tree.get_child("entries"s)) {
+        entry_t entry {
+          node.get<bool>("passed"s),
+          node.get<std::string>("h264"s),
+          node.get<std::string>("hevc"s),
+          node.get<std::string>("av1"s),
+        };
+
+        entries.insert_or_assign(node.get<std::string>("key"s), stored_entry_t {std::move(entry), node.get<std::int64_t>("updated"s, 0)});
+      }
+    } catch (std::exception &e) {
+      // A corrupt cache only costs a full probe
+      BOOST_LOG(warning) << "Couldn't read encoder probe cache "sv << file.string() << ": "sv << e.what();
+      entries.clear();
+    }
+  }
+
+  void encoder_probe_cache_t::save() {
+    pt::ptree entry_nodes;
+    for (auto &[key, stored] : entries) {
+      pt::ptree node;
+      node.put("key"s, key);
+      node.put("passed"s, stored.entry.passed);
+      node.put("h264"s, stored.entry.h264);
+      node.put("hevc"s, stored.entry.hevc);
+      node.put("av1"s, stored.entry.av1);
+      node.put("updated"s, stored.updated);
+      entry_nodes.push_back(std::make_pair(""s, node));
+    }
+
+    pt::ptree tree;
+    tree.add_child("entries"s, entry_nodes);
+
+    try {
+      pt::write_json(file.string(), tree);
+    } catch (std::exception &e) {
+      BOOST_LOG(warning) << "Couldn't write encoder probe cache "sv << file.string() << ": "sv << e.what();
+    }
+  }
+}  // namespace video
@@ -0,0 +1,81 @@
+/**
+ * @file src/encoder_probe_cache.h
+ * @brief Declarations for the persistent cache of encoder probe results.
+ */
+#pragma once
+
+// standard includes
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace video {
+
+  /**
+   * @brief Persistent cache of encoder probe results.
+   *
+   * Probing an encoder requires creating several test encode sessions, which takes seconds.
+   * The results only change when the GPU, driver, FFmpeg build, Sunshine build or configuration does,
+   * so they are stored on disk keyed by everything that influences them.
+   */
+  class encoder_probe_cache_t {
+  public:
+    struct entry_t {
+      bool passed;
+
+      // Capability bitsets of each codec, as produced by `std::bitset::to_string()`
+      std::string h264;
+      std::string hevc;
+      std::string av1;
+
+      bool operator==(const entry_t &other) const {
+        return passed == other.passed && h264 == other.h264 && hevc == other.hevc && av1 == other.av1;
+      }
+    };
+
+    /**
+     * @param file Path of the JSON file backing the cache.
+     * @param max_entries Maximum number of entries kept, least recently updated ones are dropped first.
+     */
+    explicit encoder_probe_cache_t(std::filesystem::path file, std::size_t max_entries = 32);
+
+    /**
+     * @brief Build a cache key from the parts that influence probe results.
+     */
+    static std::string make_key(const std::vector<std::string_view> &parts);
+
+    std::optional<entry_t> get(const std::string &key);
+
+    /**
+     * @brief Store an entry and write the cache to disk.
+     */
+    void put(const std::string &key, const entry_t &entry);
+
+    /**
+     * @brief Drop all entries, both in memory and on disk.
+     */
+    void clear();
+
+  private:
+    struct stored_entry_t {
+      entry_t entry;
+      std::int64_t updated;  // Milliseconds since the epoch
+    };
+
+    void load();
+    void save();
+
+    const std::filesystem::path file;
+    const std::size_t max_entries;
+
+    std::mutex lock;
+    bool loaded = false;
+    std::map<std::string, stored_entry_t> entries;
+  };
+}  // namespace video
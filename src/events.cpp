@@ -0,0 +1,65 @@
+/**
+ * @file src/events.cpp
+ * @brief Definitions for the changes of server state the web UI is told about.
+ */
+// standard includes
+#include <map>
+#include <mutex>
+
+// local includes
+#include "events.h"
+
+using namespace std::literals;
+
+namespace events {
+  namespace {
+    std::mutex subscribers_lock;
+    std::map<std::size_t, std::function<void(event_e)>> subscribers;
+    std::size_t next_subscriber_id = 0;
+  }  // namespace
+
+  std::string_view to_string(event_e event) {
+    switch (event) {
+      case event_e::session_started:
+        return "session_started"sv;
+      case event_e::session_stopped:
+        return "session_stopped"sv;
+      case event_e::app_launched:
+        return "app_launched"sv;
+      case event_e::app_exited:
+        return "app_exited"sv;
+      case event_e::client_paired:
+        return "client_paired"sv;
+      case event_e::client_unpaired:
+        return "client_unpaired"sv;
+      case event_e::config_reloaded:
+        return "config_reloaded"sv;
+    }
+
+    return "unknown"sv;
+  }
+
+  subscription_t::subscription_t(std::size_t id):
+      id {id} {
+  }
+
+  subscription_t::~subscription_t() {
+    std::lock_guard lg(subscribers_lock);
+    subscribers.erase(id);
+  }
+
+  std::unique_ptr<subscription_t> subscribe(std::function<void(event_e)> on_event) {
+    std::lock_guard lg(subscribers_lock);
+    auto id = next_subscriber_id++;
+    subscribers.emplace(id, std::move(on_event));
+
+    return std::make_unique<subscription_t>(id);
+  }
+
+  void publish(event_e event) {
+    std::lock_guard lg(subscribers_lock);
+    for (auto &[id, on_event] : subscribers) {
+      on_event(event);
+    }
+  }
+}  // namespace events
@@ -0,0 +1,61 @@
+/**
+ * @file src/events.h
+ * @brief Declarations for the changes of server state the web UI is told about.
+ */
+#pragma once
+
+// standard includes
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string_view>
+
+/**
+ * @brief Broadcasts session, app, pairing and configuration changes as they happen.
+ */
+namespace events {
+  enum class event_e {
+    session_started,  ///< A client started streaming
+    session_stopped,  ///< A client stopped streaming
+    app_launched,  ///< An app was launched
+    app_exited,  ///< The running app exited or was terminated
+    client_paired,  ///< A client was paired
+    client_unpaired,  ///< One or all clients were unpaired
+    config_reloaded,  ///< The configuration was applied again
+  };
+
+  /**
+   * @brief Get the name of an event, as sent to the web UI.
+   */
+  std::string_view to_string(event_e event);
+
+  /**
+   * @brief Stops a subscription when it goes out of scope.
+   */
+  class subscription_t {
+  public:
+    explicit subscription_t(std::size_t id);
+
+    /**
+     * @brief A destructor that removes the subscriber.
+     */
+    ~subscription_t();
+
+  private:
+    std::size_t id;
+  };
+
+  /**
+   * @brief Receive every event published from now on.
+   * @param on_event Called on the publishing thread, which may hold locks of its own.
+   *                 It must return quickly, and not publish.
+   * @return An object that removes the subscriber when it goes out of scope.
+   */
+  [[nodiscard]] std::unique_ptr<subscription_t> subscribe(std::function<void(event_e)> on_event);
+
+  /**
+   * @brief Tell every subscriber about an event.
+   * @param event The event.
+   */
+  void publish(event_e event);
+}  // namespace events
@@ -10,16 +10,20 @@
 #include "utility.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <boost/algorithm/string.hpp>
 #include <boost/function.hpp>
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/regex.hpp>
 #include <chrono>
+#include <cstdint>
 #include <exception>
 #include <filesystem>
 #include <iostream>
 #include <map>
 #include <nlohmann/json.hpp>
+#include <openssl/crypto.h>
 #include <optional>
 #include <ranges>
 #include <set>
@@ -33,6 +37,129 @@ namespace fs = std::filesystem;
 
 namespace confighttp {
 
+  namespace {
+    /**
+     * @brief How long a thread remembers a credential it verified.
+     */
+    constexpr auto VERIFIED_TTL = 5s;
+
+    /**
+     * @brief Identifies published stores, unique across all managers.
+     */
+    std::atomic<std::uint64_t> next_generation {1};
+
+    /**
+     * @brief Copy the last published store.
+     * @details The lock is only held to copy the pointer, `std::atomic<std::shared_ptr>` isn't available everywhere.
+     */
+    template<class T>
+    std::shared_ptr<const T> load_store(sync_util::sync_t<std::shared_ptr<const T>> &store) {
+      auto lg = store.lock();
+      return store.raw;
+    }
+
+    /**
+     * @brief Replace the published store.
+     */
+    template<class T>
+    void replace_store(sync_util::sync_t<std::shared_ptr<const T>> &store, std::shared_ptr<const T> next) {
+      {
+        auto lg = store.lock();
+        store.raw.swap(next);
+      }
+
+      // The previous store may be the last reference, it's freed without holding the lock
+    }
+
+    struct compiled_scope_t {
+      boost::regex path;
+      std::set<std::string, std::less<>> methods;
+    };
+
+    using compiled_token_t = std::vector<compiled_scope_t>;
+
+    /**
+     * @brief Credentials recently verified by the current thread.
+     * @details Repeated requests with the same credential skip hashing and lookup. Entries
+     *          belong to the store they were found in, so any change to the tokens or sessions
+     *          makes them stale. Credentials are compared in constant time, and wiped from
+     *          memory once they expire.
+     */
+    template<class T>
+    class verified_cache_t {
+    public:
+      ~verified_cache_t() {
+        for (auto &slot : _slots) {
+          wipe(slot);
+        }
+      }
+
+      std::shared_ptr<const T> find(std::uint64_t generation, std::string_view credential) {
+        expire();
+        for (auto &slot : _slots) {
+          if (slot.value && slot.generation == generation && crypto::constant_time_equal(slot.credential, credential)) {
+            return slot.value;
+          }
+        }
+        return nullptr;
+      }
+
+      void insert(std::uint64_t generation, std::string_view credential, std::shared_ptr<const T> value) {
+        expire();
+
+        auto &slot = _slots[_next++ % _slots.size()];
+        wipe(slot);
+        slot.generation = generation;
+        slot.credential = credential;
+        slot.value = std::move(value);
+        slot.expires = std::chrono::steady_clock::now() + VERIFIED_TTL;
+      }
+
+    private:
+      struct slot_t {
+        std::uint64_t generation = 0;
+        std::string credential;
+        std::shared_ptr<const T> value;
+        std::chrono::steady_clock::time_point expires;
+      };
+
+      /**
+       * @brief Wipe every slot whose credential outlived `VERIFIED_TTL`.
+       * @details All slots are checked, not only the ones a lookup happens to visit.
+       */
+      void expire() {
+        auto now = std::chrono::steady_clock::now();
+        for (auto &slot : _slots) {
+          if (slot.value && now >= slot.expires) {
+            wipe(slot);
+          }
+        }
+      }
+
+      static void wipe(slot_t &slot) {
+        // Assigning an empty string would leave the characters in the buffer
+        OPENSSL_cleanse(slot.credential.data(), slot.credential.size());
+        slot = {};
+      }
+
+      std::array<slot_t, 8> _slots;
+      std::size_t _next = 0;
+    };
+
+    thread_local verified_cache_t<compiled_token_t> verified_tokens;
+    thread_local verified_cache_t<SessionToken> verified_sessions;
+  }  // namespace
+
+  struct ApiTokenManager::token_store_t {
+    std::uint64_t generation;
+    std::unordered_map<std::string, compiled_token_t> by_hash;
+  };
+
+  struct SessionTokenManager::session_store_t {
+    std::uint64_t generation;
+    std::unordered_map<std::string, SessionToken, TransparentStringHash, std::equal_to<>> by_hash;
+  };
+
   // Global instances for authentication
   ApiTokenManager api_token_manager;
   SessionTokenManager session_token_manager(SessionTokenManager::make_default_dependencies());
@@ -46,14 +173,23 @@ namespace confighttp {
   }
 
   ApiTokenManager::ApiTokenManager(const ApiTokenManagerDependencies &dependencies):
-      _dependencies(dependencies) {}
+      _dependencies(dependencies) {
+    publish();
+  }
 
   bool ApiTokenManager::authenticate_token(const std::string &token, const std::string &path, const std::string &method) {
-    std::scoped_lock lock(_mutex);
-    std::string token_hash = _dependencies.hash(token);
-    auto it = _api_tokens.find(token_hash);
-    if (it == _api_tokens.end()) {
-      return false;
+    // Requests never wait on `_mutex`, they check against the last published store
+    auto store = load_store(_store);
+
+    auto scopes = verified_tokens.find(store->generation, token);
+    if (!scopes) {
+      auto it = store->by_hash.find(_dependencies.hash(token));
+      if (it == store->by_hash.end()) {
+        return false;
+      }
+
+      scopes = std::shared_ptr<const compiled_token_t>(store, &it->second);
+      verified_tokens.insert(store->generation, token, scopes);
     }
 
     std::string req_method = boost::to_upper_copy(method);
@@ -64,23 +200,35 @@ namespace confighttp {
       });
     };
 
-    auto regex_path_match = [](const std::string &scope_path, const std::string &request_path) {
-      std::string pattern = scope_path;
-      if (pattern.empty() || pattern[0] != '^') {
-        pattern = "^" + pattern;
-      }
-      if (pattern.empty() || pattern.back() != '$') {
-        pattern += "$";
+    return std::ranges::any_of(*scopes, [&](const compiled_scope_t &scope) {
+      return boost::regex_match(path, scope.path) && is_method_allowed(scope.methods);
+    });
+  }
+
+  void ApiTokenManager::publish() {
+    auto store = std::make_shared<token_store_t>();
+    store->generation = next_generation++;
+
+    for (const auto &[hash, info] : _api_tokens) {
+      auto &scopes = store->by_hash[hash];
+      for (const auto &[scope_path, methods] : info.path_methods) {
+        std::string pattern = scope_path;
+        if (pattern.empty() || pattern[0] != '^') {
+          pattern = "^" + pattern;
+        }
+        if (pattern.empty() || pattern.back() != '$') {
+          pattern += "$";
+        }
+
+        try {
+          scopes.emplace_back(compiled_scope_t {boost::regex(pattern), methods});
+        } catch (const boost::regex_error &e) {
+          BOOST_LOG(warning) << "Ignoring invalid path in API token scope ["sv << scope_path << "]: "sv << e.what();
+        }
       }
-      boost::regex re(pattern);
-      return boost::regex_match(request_path, re);
-    };
+    }
 
-    return std::ranges::any_of(it->second.path_methods, [&](const auto &pair) {
-      const auto &scope_path = pair.first;
-      const auto &methods = pair.second;
-      return regex_path_match(scope_path, path) && is_method_allowed(methods);
-    });
+    replace_store<token_store_t>(_store, std::move(store));
   }
 
   bool ApiTokenManager::authenticate_bearer(std::string_view raw_auth, const std::string &path, const std::string &method) {
@@ -102,6 +250,7 @@ namespace confighttp {
     {
       std::scoped_lock lock(_mutex);
       _api_tokens[token_hash] = info;
+      publish();
     }
     save_api_tokens();
     return token;
@@ -171,6 +320,9 @@ namespace confighttp {
     {
       std::scoped_lock lock(_mutex);
       erased = _api_tokens.erase(hash) > 0;
+      if (erased) {
+        publish();
+      }
     }
     if (erased) {
       save_api_tokens();
@@ -253,14 +405,13 @@ namespace confighttp {
   void ApiTokenManager::load_api_tokens() {
     std::scoped_lock lock(_mutex);
     _api_tokens.clear();
-    if (!_dependencies.file_exists(config::nvhttp.file_state)) {
-      return;
-    }
     pt::ptree root;
-    try {
-      _dependencies.read_json(config::nvhttp.file_state, root);
-    } catch (...) {
-      return;  // unable to load tokens; ignore
+    if (_dependencies.file_exists(config::nvhttp.file_state)) {
+      try {
+        _dependencies.read_json(config::nvhttp.file_state, root);
+      } catch (...) {
+        root.clear();  // unable to load tokens; ignore
+      }
     }
     if (auto tokens_node = root.get_child_optional("root.api_tokens")) {
       for (const auto &[_, token_tree] : *tokens_node) {
@@ -278,6 +429,7 @@ namespace confighttp {
         _api_tokens.try_emplace(info.hash, std::move(info));
       }
     }
+    publish();
   }
 
   ApiTokenManagerDependencies ApiTokenManager::make_default_dependencies() {
@@ -303,12 +455,15 @@ namespace confighttp {
     return dependencies;
   }
 
-  const std::map<std::string, ApiTokenInfo, std::less<>> &ApiTokenManager::retrieve_loaded_api_tokens() const {
+  std::map<std::string, ApiTokenInfo, std::less<>> ApiTokenManager::retrieve_loaded_api_tokens() const {
+    std::scoped_lock lock(_mutex);
     return _api_tokens;
   }
 
   SessionTokenManager::SessionTokenManager(const SessionTokenManagerDependencies &dependencies):
-      _dependencies(dependencies) {}
+      _dependencies(dependencies) {
+    publish();
+  }
 
   SessionTokenManagerDependencies SessionTokenManager::make_default_dependencies() {
     SessionTokenManagerDependencies deps;
@@ -332,19 +487,21 @@ namespace confighttp {
     auto now = _dependencies.now();
     auto expires = now + config::sunshine.session_token_ttl;
     _session_tokens[token_hash] = SessionToken {username, now, expires};
-    cleanup_expired_session_tokens();
+    erase_expired_session_tokens();
+    publish();
     return token;
   }
 
   bool SessionTokenManager::validate_session_token(const std::string &token) {
-    std::scoped_lock lock(_mutex);
-    std::string token_hash = _dependencies.hash(token);
-    auto it = _session_tokens.find(token_hash);
-    if (it == _session_tokens.end()) {
+    auto session = find_session(token);
+    if (!session) {
       return false;
     }
-    if (auto now = _dependencies.now(); now > it->second.expires_at) {
-      _session_tokens.erase(it);
+    if (auto now = _dependencies.now(); now > session->expires_at) {
+      std::scoped_lock lock(_mutex);
+      if (erase_expired_session_tokens()) {
+        publish();
+      }
       return false;
     }
     return true;
@@ -353,28 +510,59 @@ namespace confighttp {
   void SessionTokenManager::revoke_session_token(const std::string &token) {
     std::scoped_lock lock(_mutex);
     std::string token_hash = _dependencies.hash(token);
-    _session_tokens.erase(token_hash);
+    if (_session_tokens.erase(token_hash) > 0) {
+      publish();
+    }
   }
 
   void SessionTokenManager::cleanup_expired_session_tokens() {
-    auto now = _dependencies.now();
-    std::erase_if(_session_tokens, [now](const auto &pair) {
-      return now > pair.second.expires_at;
-    });
+    std::scoped_lock lock(_mutex);
+    if (erase_expired_session_tokens()) {
+      publish();
+    }
   }
 
   std::optional<std::string> SessionTokenManager::get_username_for_token(const std::string &token) {
-    std::scoped_lock lock(_mutex);
-    std::string token_hash = _dependencies.hash(token);
-    if (auto it = _session_tokens.find(token_hash); it != _session_tokens.end() && _dependencies.now() <= it->second.expires_at) {
-      return it->second.username;
+    if (auto session = find_session(token); session && _dependencies.now() <= session->expires_at) {
+      return session->username;
     }
     return std::nullopt;
   }
 
   size_t SessionTokenManager::session_count() const {
-    std::scoped_lock lock(_mutex);
-    return _session_tokens.size();
+    return load_store(_store)->by_hash.size();
+  }
+
+  std::shared_ptr<const SessionToken> SessionTokenManager::find_session(const std::string &token) const {
+    auto store = load_store(_store);
+
+    if (auto session = verified_sessions.find(store->generation, token)) {
+      return session;
+    }
+
+    auto it = store->by_hash.find(_dependencies.hash(token));
+    if (it == store->by_hash.end()) {
+      return nullptr;
+    }
+
+    std::shared_ptr<const SessionToken> session {store, &it->second};
+    verified_sessions.insert(store->generation, token, session);
+    return session;
+  }
+
+  bool SessionTokenManager::erase_expired_session_tokens() {
+    auto now = _dependencies.now();
+    return std::erase_if(_session_tokens, [now](const auto &pair) {
+             return now > pair.second.expires_at;
+           }) > 0;
+  }
+
+  void SessionTokenManager::publish() {
+    auto store = std::make_shared<session_store_t>();
+    store->generation = next_generation++;
+    store->by_hash = _session_tokens;
+
+    replace_store<session_store_t>(_store, std::move(store));
   }
 
   SessionTokenAPI::SessionTokenAPI(SessionTokenManager &session_manager):
@@ -460,7 +648,7 @@ namespace confighttp {
 
   bool SessionTokenAPI::validate_credentials(const std::string &username, const std::string &password) const {
     if (auto hash = util::hex(crypto::hash(password + config::sunshine.salt)).to_string();
-        !boost::iequals(username, config::sunshine.username) || hash != config::sunshine.password) {
+        !boost::iequals(username, config::sunshine.username) || !crypto::constant_time_equal(hash, config::sunshine.password)) {
       return false;
     }
     return true;
@@ -20,6 +20,7 @@
 // local includes
 #include "config.h"
 #include "crypto.h"
+#include "sync.h"
 #include "utility.h"
 
 // platform includes
@@ -146,12 +147,19 @@ namespace confighttp {
      */
     static ApiTokenManagerDependencies make_default_dependencies();
     /**
-     * @brief Access currently loaded tokens (thread-safe for reading via mutex).
+     * @brief Copy the currently loaded tokens.
      * @return Map of token hash to token info.
      */
-    const std::map<std::string, ApiTokenInfo, std::less<>> &retrieve_loaded_api_tokens() const;
+    std::map<std::string, ApiTokenInfo, std::less<>> retrieve_loaded_api_tokens() const;
 
   private:
+    struct token_store_t;
+
+    /**
+     * @brief Replace the store that requests are authenticated against with a copy of the current tokens.
+     * @details Must be called with `_mutex` held after every change to `_api_tokens`.
+     */
+    void publish();
     /**
      * @brief Parse scope JSON into internal map form.
      * @param scopes_json Incoming JSON object.
@@ -172,8 +180,9 @@ namespace confighttp {
      */
     std::map<std::string, std::set<std::string, std::less<>>, std::less<>> build_scope_map(const boost::property_tree::ptree &scopes_node) const;
     ApiTokenManagerDependencies _dependencies;  ///< Injected dependencies
-    mutable std::mutex _mutex;  ///< Guards token container
+    mutable std::mutex _mutex;  ///< Serializes changes to the tokens
     std::map<std::string, ApiTokenInfo, std::less<>> _api_tokens;  ///< Token storage keyed by hash
+    mutable sync_util::sync_t<std::shared_ptr<const token_store_t>> _store;  ///< Read-only tokens with compiled scopes, replaced on change
   };
 
   struct SessionToken {
@@ -239,8 +248,27 @@ namespace confighttp {
     static SessionTokenManagerDependencies make_default_dependencies();
 
   private:
+    struct session_store_t;
+
+    /**
+     * @brief Find the session of a token without taking `_mutex`.
+     * @param token Opaque token string.
+     * @return The session, possibly expired, or `nullptr` if unknown.
+     */
+    std::shared_ptr<const SessionToken> find_session(const std::string &token) const;
+    /**
+     * @brief Remove expired tokens, with `_mutex` held.
+     * @return `true` if any token was removed.
+     */
+    bool erase_expired_session_tokens();
+    /**
+     * @brief Replace the store that requests are validated against with a copy of the current sessions.
+     * @details Must be called with `_mutex` held after every change to `_session_tokens`.
+     */
+    void publish();
+
     SessionTokenManagerDependencies _dependencies;  ///< Injected dependencies
-    mutable std::mutex _mutex;  ///< Guards session token map
+    mutable std::mutex _mutex;  ///< Serializes changes to the session token map
 
     struct TransparentStringHash {
       using is_transparent = void;
@@ -259,6 +287,7 @@ namespace confighttp {
     };
 
     std::unordered_map<std::string, SessionToken, TransparentStringHash, std::equal_to<>> _session_tokens;  ///< Active session tokens keyed by hash
+    mutable sync_util::sync_t<std::shared_ptr<const session_store_t>> _store;  ///< Read-only copy of the sessions, replaced on change
   };
 
   struct APIResponse {
@@ -5,6 +5,8 @@
 #define BOOST_BIND_GLOBAL_PLACEHOLDERS
 
 // standard includes
+#include <algorithm>
+#include <charconv>
 #include <filesystem>
 #include <utility>
 
@@ -268,4 +270,68 @@ namespace http {
     return result;
   }
 
+  /**
+   * @brief Parse a `Range` header for a resource of the given size.
+   * @details Only a single range is supported: `bytes=first-`, `bytes=first-last` or the suffix `bytes=-length`.
+   * @param header The value of the header.
+   * @param size The size of the resource.
+   * @return The range clamped to the size, with `satisfiable` unset if it lies outside the resource,
+   *         or `std::nullopt` if the header should be ignored and the whole resource sent.
+   */
+  std::optional<byte_range_t> parse_range(std::string_view header, std::uintmax_t size) {
+    constexpr std::string_view unit = "bytes=";
+    if (!header.starts_with(unit)) {
+      return std::nullopt;
+    }
+    header.remove_prefix(unit.size());
+
+    auto dash = header.find('-');
+    if (dash == std::string_view::npos || header.find_first_not_of("0123456789-") != std::string_view::npos || header.find('-', dash + 1) != std::string_view::npos) {
+      return std::nullopt;
+    }
+
+    auto parse = [](std::string_view digits) -> std::optional<std::uintmax_t> {
+      std::uintmax_t value;
+      auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+      if (digits.empty() || ec != std::errc {} || end != digits.data() + digits.size()) {
+        return std::nullopt;
+      }
+      return value;
+    };
+
+    auto first = header.substr(0, dash);
+    auto last = header.substr(dash + 1);
+
+    if (first.empty()) {
+      // The last bytes of the resource
+      auto length = parse(last);
+      if (!length) {
+        return std::nullopt;
+      }
+      if (*length == 0 || size == 0) {
+        return byte_range_t {0, 0, false};
+      }
+      return byte_range_t {size - std::min(*length, size), size - 1, true};
+    }
+
+    auto from = parse(first);
+    if (!from) {
+      return std::nullopt;
+    }
+
+    std::uintmax_t to = size ? size - 1 : 0;
+    if (!last.empty()) {
+      auto value = parse(last);
+      if (!value || *value < *from) {
+        return std::nullopt;
+      }
+      to = std::min(*value, to);
+    }
+
+    if (*from >= size) {
+      return byte_range_t {0, 0, false};
+    }
+    return byte_range_t {*from, to, true};
+  }
+
 }  // namespace http
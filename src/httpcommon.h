@@ -4,6 +4,11 @@
  */
 #pragma once
 
+// standard includes
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
 // lib includes
 #include <curl/curl.h>
 
@@ -29,6 +34,17 @@ namespace http {
   std::string cookie_escape(const std::string &value);
   std::string cookie_unescape(const std::string &value);
 
+  /**
+   * @brief An inclusive range of bytes requested with a `Range` header.
+   */
+  struct byte_range_t {
+    std::uintmax_t first;
+    std::uintmax_t last;
+    bool satisfiable;
+  };
+
+  std::optional<byte_range_t> parse_range(std::string_view header, std::uintmax_t size);
+
   extern std::string unique_id;
   extern net::net_e origin_web_ui_allowed;
 
@@ -0,0 +1,176 @@
+/**
+ * @file src/image_pool.cpp
+ * @brief Definitions for the pool of capture images shared between capture and encoding.
+ */
+// standard includes
+#include <algorithm>
+#include <iterator>
+
+// local includes
+#include "image_pool.h"
+
+namespace video {
+
+  std::shared_ptr<image_pool_t> image_pool_t::make(std::size_t capacity, alloc_fn alloc, std::chrono::milliseconds trim_timeout) {
+    auto pool = std::make_shared<image_pool_t>(capacity, std::move(alloc), trim_timeout);
+    pool->self = pool;
+
+    return pool;
+  }
+
+  image_pool_t::image_pool_t(std::size_t capacity, alloc_fn alloc, std::chrono::milliseconds trim_timeout):
+      capacity {capacity},
+      alloc {std::move(alloc)},
+      trim_timeout {trim_timeout} {
+  }
+
+  std::shared_ptr<platf::img_t> image_pool_t::acquire(std::chrono::milliseconds timeout) {
+    std::unique_lock ul {lock};
+
+    auto ready = [this]() {
+      return !free_imgs.empty() || allocated_count < capacity;
+    };
+
+    if (!ready()) {
+      ++stalls;
+
+      auto start = std::chrono::steady_clock::now();
+      cv.wait_for(ul, timeout, ready);
+      wait_time += std::chrono::steady_clock::now() - start;
+    }
+
+    std::shared_ptr<platf::img_t> img;
+    if (!free_imgs.empty()) {
+      // Reuse the most recently returned image, it's the most likely to still be in cache
+      img = std::move(free_imgs.back());
+      free_imgs.pop_back();
+    } else if (allocated_count < capacity) {
+      ++allocated_count;
+      auto current_generation = generation;
+
+      // Allocation may be slow, don't block consumers returning images meanwhile
+      ul.unlock();
+      img = alloc();
+      ul.lock();
+
+      if (current_generation != generation) {
+        return nullptr;
+      }
+
+      if (!img) {
+        --allocated_count;
+
+        // Allocation keeps failing while the display is lost, don't make the caller retry right away.
+        // Wait for an image to be returned instead.
+        cv.wait_for(ul, timeout, [this, current_generation]() {
+          return !free_imgs.empty() || current_generation != generation;
+        });
+        return nullptr;
+      }
+    } else {
+      // Timed out
+      return nullptr;
+    }
+
+    auto trimmed = trim(std::chrono::steady_clock::now());
+    auto current_generation = generation;
+    ul.unlock();
+
+    img->frame_timestamp.reset();
+    return wrap(std::move(img), current_generation);
+  }
+
+  std::shared_ptr<platf::img_t> image_pool_t::wrap(std::shared_ptr<platf::img_t> &&img, std::uint64_t generation) {
+    auto raw = img.get();
+
+    return std::shared_ptr<platf::img_t>(raw, [pool = self, img = std::move(img), generation](platf::img_t *) mutable {
+      if (auto pool_p = pool.lock()) {
+        pool_p->release(std::move(img), generation);
+      }
+    });
+  }
+
+  void image_pool_t::release(std::shared_ptr<platf::img_t> &&img, std::uint64_t generation) {
+    {
+      std::lock_guard lg {lock};
+
+      // Images from before clear() may reference a display that no longer exists
+      if (generation != this->generation) {
+        return;
+      }
+
+      free_imgs.emplace_back(std::move(img));
+    }
+
+    cv.notify_one();
+  }
+
+  std::vector<std::shared_ptr<platf::img_t>> image_pool_t::trim(std::chrono::steady_clock::time_point now) {
+    std::vector<std::shared_ptr<platf::img_t>> trimmed;
+
+    auto used_count = allocated_count - free_imgs.size();
+
+    // Remember when this many images were last in use at the same time
+    if (used_timestamps.size() <= used_count) {
+      used_timestamps.resize(used_count + 1);
+    }
+    used_timestamps[used_count] = now;
+
+    // Keep as many images as were needed within the trim timeout
+    auto trim_target = used_count;
+    for (auto i = used_count; i < used_timestamps.size(); ++i) {
+      if (used_timestamps[i] && now - *used_timestamps[i] < trim_timeout) {
+        trim_target = i;
+      }
+    }
+
+    if (allocated_count > trim_target) {
+      // Least recently used images are at the front
+      auto to_trim = std::min(allocated_count - trim_target, free_imgs.size());
+      std::move(free_imgs.begin(), free_imgs.begin() + to_trim, std::back_inserter(trimmed));
+      free_imgs.erase(free_imgs.begin(), free_imgs.begin() + to_trim);
+      allocated_count -= to_trim;
+
+      used_timestamps.resize(trim_target + 1);
+    }
+
+    // Freed by the caller outside of the lock
+    return trimmed;
+  }
+
+  void image_pool_t::clear() {
+    std::deque<std::shared_ptr<platf::img_t>> imgs;
+    {
+      std::lock_guard lg {lock};
+
+      imgs = std::move(free_imgs);
+      free_imgs.clear();
+      allocated_count = 0;
+      used_timestamps.clear();
+      ++generation;
+    }
+
+    // Images in flight no longer count against the capacity
+    cv.notify_all();
+  }
+
+  std::size_t image_pool_t::allocated() const {
+    std::lock_guard lg {lock};
+    return allocated_count;
+  }
+
+  std::size_t image_pool_t::free_count() const {
+    std::lock_guard lg {lock};
+    return free_imgs.size();
+  }
+
+  std::uint64_t image_pool_t::stall_count() const {
+    std::lock_guard lg {lock};
+    return stalls;
+  }
+
+  std::chrono::nanoseconds image_pool_t::total_wait() const {
+    std::lock_guard lg {lock};
+    return wait_time;
+  }
+}  // namespace video
@@ -0,0 +1,100 @@
+/**
+ * @file src/image_pool.h
+ * @brief Declarations for the pool of capture images shared between capture and encoding.
+ */
+#pragma once
+
+// standard includes
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+// local includes
+#include "platform/common.h"
+
+namespace video {
+
+  /**
+   * @brief Fixed capacity pool of capture images.
+   *
+   * Images are handed out as `std::shared_ptr` with a custom deleter, so an image
+   * returns to the free list as soon as the last encoder drops its reference.
+   * Acquiring blocks on a condition variable instead of polling when every image is in use.
+   *
+   * Unused images are trimmed with the same policy the capture thread always used:
+   * images above the highest in-use count seen within the trim timeout are released,
+   * least recently used first.
+   */
+  class image_pool_t {
+  public:
+    using alloc_fn = std::function<std::shared_ptr<platf::img_t>()>;
+
+    /**
+     * @brief Create a new pool.
+     * @param capacity Maximum number of images allocated at once.
+     * @param alloc Callback allocating a new image, typically `display_t::alloc_img()`.
+     * @param trim_timeout How long an unused image is retained after it was last needed.
+     */
+    static std::shared_ptr<image_pool_t> make(std::size_t capacity, alloc_fn alloc, std::chrono::milliseconds trim_timeout = std::chrono::seconds(3));
+
+    /**
+     * @brief Get a free image, allocating a new one if the pool isn't full yet.
+     * @param timeout Maximum time to wait for an image to be returned.
+     * @return The image, or `nullptr` if the timeout expired or the allocation failed.
+     * @details When the allocation fails, it waits up to `timeout` for an image to be returned before failing.
+     */
+    std::shared_ptr<platf::img_t> acquire(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Drop all images currently owned by the pool.
+     * @details Images still held by consumers are freed rather than recycled once they are released.
+     *          This is used when the display is reinitialized, since images may reference it.
+     */
+    void clear();
+
+    std::size_t allocated() const;
+    std::size_t free_count() const;
+
+    /**
+     * @brief Number of `acquire()` calls that had to block because every image was in use.
+     */
+    std::uint64_t stall_count() const;
+
+    /**
+     * @brief Accumulated time spent blocked in `acquire()`.
+     */
+    std::chrono::nanoseconds total_wait() const;
+
+    image_pool_t(std::size_t capacity, alloc_fn alloc, std::chrono::milliseconds trim_timeout);
+
+  private:
+    void release(std::shared_ptr<platf::img_t> &&img, std::uint64_t generation);
+    std::shared_ptr<platf::img_t> wrap(std::shared_ptr<platf::img_t> &&img, std::uint64_t generation);
+    std::vector<std::shared_ptr<platf::img_t>> trim(std::chrono::steady_clock::time_point now);
+
+    const std::size_t capacity;
+    const alloc_fn alloc;
+    const std::chrono::milliseconds trim_timeout;
+
+    std::weak_ptr<image_pool_t> self;
+
+    mutable std::mutex lock;
+    std::condition_variable cv;
+
+    // Back of the deque holds the most recently returned image
+    std::deque<std::shared_ptr<platf::img_t>> free_imgs;
+    std::size_t allocated_count = 0;
+    std::uint64_t generation = 0;
+
+    std::vector<std::optional<std::chrono::steady_clock::time_point>> used_timestamps;
+
+    std::uint64_t stalls = 0;
+    std::chrono::nanoseconds wait_time {0};
+  };
+}  // namespace video
@@ -9,10 +9,12 @@ extern "C" {
 }
 
 // standard includes
+#include <array>
+#include <atomic>
 #include <bitset>
 #include <chrono>
 #include <cmath>
-#include <list>
+#include <format>
 #include <thread>
 #include <unordered_map>
 
@@ -26,6 +28,7 @@ extern "C" {
 #include "logging.h"
 #include "platform/common.h"
 #include "thread_pool.h"
+#include "thread_safe.h"
 #include "utility.h"
 
 // Win32 WHEEL_DELTA constant
@@ -108,6 +111,22 @@ namespace input {
     return std::clamp(from_netfloat(f), min, max);
   }
 
+  // Input messages are small, the largest ones (pen and touch events) take less than 64 bytes.
+  // Larger messages are kept in an allocated buffer of the slot.
+  constexpr std::size_t INPUT_SLOT_SIZE = 128;
+
+  // Messages that may wait for the input thread per session without allocating, newer ones spill to a list
+  constexpr std::size_t INPUT_QUEUE_SLOTS = 256;
+
+  /**
+   * @brief Dispatches input to the OS and runs the timers emulating input, like key repeat.
+   * @details All input state is global, so a single thread handles every session. Input never
+   *          waits behind unrelated work scheduled on the global task_pool.
+   */
+  static thread_pool_util::ThreadPool input_pool;
+
+  static std::array<latency_stats_t, (std::size_t) event_type_e::_count> latency;
+
   static task_pool_util::TaskPool::task_id_t key_press_repeat_id {};
   static std::unordered_map<key_press_id_t, bool> key_press {};
   static std::array<std::uint8_t, 5> mouse_press {};
@@ -132,7 +151,7 @@ namespace input {
 
     ~gamepad_t() {
       if (id >= 0) {
-        task_pool.push([id = this->id]() {
+        input_pool.push([id = this->id]() {
           free_gamepad(platf_input, id);
         });
       }
@@ -184,8 +203,23 @@ namespace input {
     safe::mail_raw_t::event_t<input::touch_port_t> touch_port_event;
     platf::feedback_queue_t feedback_queue;
 
-    std::list<std::vector<uint8_t>> input_queue;
-    std::mutex input_queue_lock;
+    struct input_slot_t {
+      // 0 once the message has been batched into an earlier one
+      std::size_t size;
+      std::chrono::steady_clock::time_point received;
+      std::chrono::steady_clock::time_point queued;
+      alignas(16) std::array<std::uint8_t, INPUT_SLOT_SIZE> data;
+      std::vector<std::uint8_t> large_data;
+
+      PNV_INPUT_HEADER payload() {
+        return (PNV_INPUT_HEADER) (large_data.empty() ? data.data() : large_data.data());
+      }
+    };
+
+    // Filled by the control stream thread, drained by the input thread. No message is ever dropped,
+    // a lost key or button release would leave it pressed on the host.
+    safe::spsc_spill_queue_t<input_slot_t> input_queue {INPUT_QUEUE_SLOTS};
+    std::atomic_bool drain_scheduled {false};
 
     thread_pool_util::ThreadPool::task_id_t mouse_left_button_timeout;
 
@@ -597,7 +631,7 @@ namespace input {
         input->mouse_left_button_timeout = nullptr;
       };
 
-      input->mouse_left_button_timeout = task_pool.pushDelayed(std::move(f), 10ms).task_id;
+      input->mouse_left_button_timeout = input_pool.pushDelayed(std::move(f), 10ms).task_id;
 
       return;
     }
@@ -716,7 +750,7 @@ namespace input {
 
     send_key_and_modifiers(key_code, false, flags, synthetic_modifiers);
 
-    key_press_repeat_id = task_pool.pushDelayed(repeat_key, config::input.key_repeat_period, key_code, flags, synthetic_modifiers).task_id;
+    key_press_repeat_id = input_pool.pushDelayed(repeat_key, config::input.key_repeat_period, key_code, flags, synthetic_modifiers).task_id;
   }
 
   void passthrough(std::shared_ptr<input_t> &input, PNV_KEYBOARD_PACKET packet) {
@@ -752,11 +786,11 @@ namespace input {
         }
 
         if (key_press_repeat_id) {
-          task_pool.cancel(key_press_repeat_id);
+          input_pool.cancel(key_press_repeat_id);
         }
 
         if (config::input.key_repeat_delay.count() > 0) {
-          key_press_repeat_id = task_pool.pushDelayed(repeat_key, config::input.key_repeat_delay, keyCode, packet->flags, synthetic_modifiers).task_id;
+          key_press_repeat_id = input_pool.pushDelayed(repeat_key, config::input.key_repeat_delay, keyCode, packet->flags, synthetic_modifiers).task_id;
         }
       } else {
         // Already released
@@ -1180,10 +1214,10 @@ namespace input {
             gamepad.back_timeout_id = nullptr;
           };
 
-          gamepad.back_timeout_id = task_pool.pushDelayed(std::move(f), config::input.back_button_timeout).task_id;
+          gamepad.back_timeout_id = input_pool.pushDelayed(std::move(f), config::input.back_button_timeout).task_id;
         }
       } else if (gamepad.back_timeout_id) {
-        task_pool.cancel(gamepad.back_timeout_id);
+        input_pool.cancel(gamepad.back_timeout_id);
         gamepad.back_timeout_id = nullptr;
       }
     }
@@ -1475,121 +1509,227 @@ namespace input {
   }
 
   /**
-   * @brief Called on a thread pool thread to process an input message.
-   * @param input The input context pointer.
+   * @brief Get the kind of event an input message holds.
+   * @param payload The input message.
+   * @return The event type, `event_type_e::_count` for unknown messages.
    */
-  void passthrough_next_message(std::shared_ptr<input_t> input) {
-    // 'entry' backs the 'payload' pointer, so they must remain in scope together
-    std::vector<uint8_t> entry;
-    PNV_INPUT_HEADER payload;
-
-    // Lock the input queue while batching, but release it before sending
-    // the input to the OS. This avoids potentially lengthy lock contention
-    // in the control stream thread while input is being processed by the OS.
-    {
-      std::lock_guard<std::mutex> lg(input->input_queue_lock);
-
-      // If all entries have already been processed, nothing to do
-      if (input->input_queue.empty()) {
-        return;
-      }
-
-      // Pop off the first entry, which we will send
-      entry = input->input_queue.front();
-      payload = (PNV_INPUT_HEADER) entry.data();
-      input->input_queue.pop_front();
-
-      // Try to batch with remaining items on the queue
-      auto i = input->input_queue.begin();
-      while (i != input->input_queue.end()) {
-        auto batchable_entry = *i;
-        auto batchable_payload = (PNV_INPUT_HEADER) batchable_entry.data();
-
-        auto batch_result = batch(payload, batchable_payload);
-        if (batch_result == batch_result_e::terminate_batch) {
-          // Stop batching
-          break;
-        } else if (batch_result == batch_result_e::batched) {
-          // Erase this entry since it was batched
-          i = input->input_queue.erase(i);
-        } else {
-          // We couldn't batch this entry, but try to batch later entries.
-          i++;
-        }
-      }
-    }
-
-    // Print the final input packet
-    input::print((void *) payload);
-
-    // Send the batched input to the OS
+  event_type_e event_type(PNV_INPUT_HEADER payload) {
     switch (util::endian::little(payload->magic)) {
       case MOUSE_MOVE_REL_MAGIC_GEN5:
-        passthrough(input, (PNV_REL_MOUSE_MOVE_PACKET) payload);
-        break;
       case MOUSE_MOVE_ABS_MAGIC:
-        passthrough(input, (PNV_ABS_MOUSE_MOVE_PACKET) payload);
-        break;
       case MOUSE_BUTTON_DOWN_EVENT_MAGIC_GEN5:
       case MOUSE_BUTTON_UP_EVENT_MAGIC_GEN5:
-        passthrough(input, (PNV_MOUSE_BUTTON_PACKET) payload);
-        break;
       case SCROLL_MAGIC_GEN5:
-        passthrough(input, (PNV_SCROLL_PACKET) payload);
-        break;
       case SS_HSCROLL_MAGIC:
-        passthrough(input, (PSS_HSCROLL_PACKET) payload);
-        break;
+        return event_type_e::mouse;
       case KEY_DOWN_EVENT_MAGIC:
       case KEY_UP_EVENT_MAGIC:
-        passthrough(input, (PNV_KEYBOARD_PACKET) payload);
-        break;
       case UTF8_TEXT_EVENT_MAGIC:
-        passthrough((PNV_UNICODE_PACKET) payload);
-        break;
+        return event_type_e::keyboard;
       case MULTI_CONTROLLER_MAGIC_GEN5:
-        passthrough(input, (PNV_MULTI_CONTROLLER_PACKET) payload);
-        break;
-      case SS_TOUCH_MAGIC:
-        passthrough(input, (PSS_TOUCH_PACKET) payload);
-        break;
-      case SS_PEN_MAGIC:
-        passthrough(input, (PSS_PEN_PACKET) payload);
-        break;
       case SS_CONTROLLER_ARRIVAL_MAGIC:
-        passthrough(input, (PSS_CONTROLLER_ARRIVAL_PACKET) payload);
-        break;
       case SS_CONTROLLER_TOUCH_MAGIC:
-        passthrough(input, (PSS_CONTROLLER_TOUCH_PACKET) payload);
-        break;
       case SS_CONTROLLER_MOTION_MAGIC:
-        passthrough(input, (PSS_CONTROLLER_MOTION_PACKET) payload);
-        break;
       case SS_CONTROLLER_BATTERY_MAGIC:
-        passthrough(input, (PSS_CONTROLLER_BATTERY_PACKET) payload);
-        break;
+        return event_type_e::gamepad;
+      case SS_TOUCH_MAGIC:
+        return event_type_e::touch;
+      case SS_PEN_MAGIC:
+        return event_type_e::pen;
+      default:
+        return event_type_e::_count;
+    }
+  }
+
+  std::string_view to_string(event_type_e type) {
+    switch (type) {
+      case event_type_e::mouse:
+        return "mouse"sv;
+      case event_type_e::keyboard:
+        return "keyboard"sv;
+      case event_type_e::gamepad:
+        return "gamepad"sv;
+      case event_type_e::touch:
+        return "touch"sv;
+      case event_type_e::pen:
+        return "pen"sv;
+      default:
+        return "unknown"sv;
+    }
+  }
+
+  const latency_stats_t &latency_stats(event_type_e type) {
+    return latency[(std::size_t) type];
+  }
+
+  /**
+   * @brief Log the input latency percentiles of every event type seen so far.
+   */
+  void log_latency_stats() {
+    for (std::size_t x = 0; x < latency.size(); ++x) {
+      auto &stats = latency[x];
+      auto events = stats.total.count();
+      if (!events) {
+        continue;
+      }
+
+      auto p50_p99 = [](const stat_trackers::latency_histogram &histogram) {
+        return std::format("{}/{}us", histogram.percentile(50).count(), histogram.percentile(99).count());
+      };
+
+      BOOST_LOG(info) << "Input latency ["sv << to_string((event_type_e) x) << "]: "sv
+                      << events << " events, "sv << stats.coalesced.load(std::memory_order_relaxed) << " coalesced, p50/p99 decrypt "sv
+                      << p50_p99(stats.decrypt) << ", queue "sv << p50_p99(stats.queue) << ", batch "sv << p50_p99(stats.batch)
+                      << ", inject "sv << p50_p99(stats.inject) << ", total "sv << p50_p99(stats.total);
+    }
+  }
+
+  /**
+   * @brief Called on the input thread to send every queued input message to the OS.
+   * @param input The input context pointer.
+   */
+  void passthrough_next_message(std::shared_ptr<input_t> input) {
+    // Messages queued from now on need another run. The fence pairs with the one in passthrough():
+    // either the queue is seen non-empty below, or the producer sees the flag cleared and schedules a run.
+    input->drain_scheduled.store(false, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    while (auto entry = input->input_queue.peek()) {
+      auto dequeued = std::chrono::steady_clock::now();
+
+      if (!entry->size) {
+        // Already batched into an earlier message
+        input->input_queue.pop();
+        continue;
+      }
+
+      auto payload = entry->payload();
+
+      // Try to batch with the other queued messages. They stay in their slots until
+      // the producer gets them back, so batching doesn't need to copy anything.
+      for (std::size_t x = 1; auto batchable_entry = input->input_queue.peek(x); ++x) {
+        if (!batchable_entry->size) {
+          continue;
+        }
+
+        auto batch_result = batch(payload, batchable_entry->payload());
+        if (batch_result == batch_result_e::terminate_batch) {
+          // Stop batching
+          break;
+        } else if (batch_result == batch_result_e::batched) {
+          batchable_entry->size = 0;
+
+          if (auto type = event_type(batchable_entry->payload()); type != event_type_e::_count) {
+            latency[(std::size_t) type].coalesced.fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+      }
+
+      auto batched = std::chrono::steady_clock::now();
+
+      // Print the final input packet
+      input::print((void *) payload);
+
+      auto type = event_type(payload);
+      auto injecting = std::chrono::steady_clock::now();
+
+      // Send the batched input to the OS
+      switch (util::endian::little(payload->magic)) {
+        case MOUSE_MOVE_REL_MAGIC_GEN5:
+          passthrough(input, (PNV_REL_MOUSE_MOVE_PACKET) payload);
+          break;
+        case MOUSE_MOVE_ABS_MAGIC:
+          passthrough(input, (PNV_ABS_MOUSE_MOVE_PACKET) payload);
+          break;
+        case MOUSE_BUTTON_DOWN_EVENT_MAGIC_GEN5:
+        case MOUSE_BUTTON_UP_EVENT_MAGIC_GEN5:
+          passthrough(input, (PNV_MOUSE_BUTTON_PACKET) payload);
+          break;
+        case SCROLL_MAGIC_GEN5:
+          passthrough(input, (PNV_SCROLL_PACKET) payload);
+          break;
+        case SS_HSCROLL_MAGIC:
+          passthrough(input, (PSS_HSCROLL_PACKET) payload);
+          break;
+        case KEY_DOWN_EVENT_MAGIC:
+        case KEY_UP_EVENT_MAGIC:
+          passthrough(input, (PNV_KEYBOARD_PACKET) payload);
+          break;
+        case UTF8_TEXT_EVENT_MAGIC:
+          passthrough((PNV_UNICODE_PACKET) payload);
+          break;
+        case MULTI_CONTROLLER_MAGIC_GEN5:
+          passthrough(input, (PNV_MULTI_CONTROLLER_PACKET) payload);
+          break;
+        case SS_TOUCH_MAGIC:
+          passthrough(input, (PSS_TOUCH_PACKET) payload);
+          break;
+        case SS_PEN_MAGIC:
+          passthrough(input, (PSS_PEN_PACKET) payload);
+          break;
+        case SS_CONTROLLER_ARRIVAL_MAGIC:
+          passthrough(input, (PSS_CONTROLLER_ARRIVAL_PACKET) payload);
+          break;
+        case SS_CONTROLLER_TOUCH_MAGIC:
+          passthrough(input, (PSS_CONTROLLER_TOUCH_PACKET) payload);
+          break;
+        case SS_CONTROLLER_MOTION_MAGIC:
+          passthrough(input, (PSS_CONTROLLER_MOTION_PACKET) payload);
+          break;
+        case SS_CONTROLLER_BATTERY_MAGIC:
+          passthrough(input, (PSS_CONTROLLER_BATTERY_PACKET) payload);
+          break;
+      }
+
+      if (type != event_type_e::_count) {
+        auto injected = std::chrono::steady_clock::now();
+
+        auto &stats = latency[(std::size_t) type];
+        stats.decrypt.record(entry->queued - entry->received);
+        stats.queue.record(dequeued - entry->queued);
+        stats.batch.record(batched - dequeued);
+        stats.inject.record(injected - injecting);
+        stats.total.record(injected - entry->received);
+      }
+
+      input->input_queue.pop();
     }
   }
 
   /**
    * @brief Called on the control stream thread to queue an input message.
    * @param input The input context pointer.
-   * @param input_data The input message.
+   * @param input_data The decrypted input message.
+   * @param received When the control stream received the message, before decryption.
    */
-  void passthrough(std::shared_ptr<input_t> &input, std::vector<std::uint8_t> &&input_data) {
-    {
-      std::lock_guard<std::mutex> lg(input->input_queue_lock);
-      input->input_queue.push_back(std::move(input_data));
+  void passthrough(std::shared_ptr<input_t> &input, std::vector<std::uint8_t> &&input_data, std::chrono::steady_clock::time_point received) {
+    auto slot = input->input_queue.back();
+
+    slot->size = input_data.size();
+    slot->received = received;
+    slot->queued = std::chrono::steady_clock::now();
+    if (input_data.size() > INPUT_SLOT_SIZE) {
+      slot->large_data = std::move(input_data);
+    } else {
+      slot->large_data.clear();
+      std::copy(std::begin(input_data), std::end(input_data), std::begin(slot->data));
+    }
+    input->input_queue.push();
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!input->drain_scheduled.exchange(true, std::memory_order_acq_rel)) {
+      input_pool.push(passthrough_next_message, input);
     }
-    task_pool.push(passthrough_next_message, input);
   }
 
   void reset(std::shared_ptr<input_t> &input) {
-    task_pool.cancel(key_press_repeat_id);
-    task_pool.cancel(input->mouse_left_button_timeout);
+    input_pool.cancel(key_press_repeat_id);
+    input_pool.cancel(input->mouse_left_button_timeout);
+
+    log_latency_stats();
 
-    // Ensure input is synchronous, by using the task_pool
-    task_pool.push([]() {
+    // Ensure input is synchronous, by using the input thread
+    input_pool.push([]() {
       for (int x = 0; x < mouse_press.size(); ++x) {
         if (mouse_press[x]) {
           platf::button_mouse(platf_input, x, true);
@@ -1611,12 +1751,17 @@ namespace input {
   class deinit_t: public platf::deinit_t {
   public:
     ~deinit_t() override {
+      // Runs the remaining tasks, releasing any gamepad still plugged in
+      input_pool.stop();
+      input_pool.join();
+
       platf_input.reset();
     }
   };
 
   [[nodiscard]] std::unique_ptr<platf::deinit_t> init() {
     platf_input = platf::input();
+    input_pool.start(1);
 
     return std::make_unique<deinit_t>();
   }
@@ -1639,7 +1784,7 @@ namespace input {
     );
 
     // Workaround to ensure new frames will be captured when a client connects
-    task_pool.pushDelayed([]() {
+    input_pool.pushDelayed([]() {
       platf::move_mouse(platf_input, 1, 1);
       platf::move_mouse(platf_input, -1, -1);
     },
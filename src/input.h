@@ -5,10 +5,13 @@
 #pragma once
 
 // standard includes
+#include <chrono>
 #include <functional>
+#include <string_view>
 
 // local includes
 #include "platform/common.h"
+#include "stat_trackers.h"
 #include "thread_safe.h"
 
 namespace input {
@@ -16,7 +19,7 @@ namespace input {
 
   void print(void *input);
   void reset(std::shared_ptr<input_t> &input);
-  void passthrough(std::shared_ptr<input_t> &input, std::vector<std::uint8_t> &&input_data);
+  void passthrough(std::shared_ptr<input_t> &input, std::vector<std::uint8_t> &&input_data, std::chrono::steady_clock::time_point received = std::chrono::steady_clock::now());
 
   [[nodiscard]] std::unique_ptr<platf::deinit_t> init();
 
@@ -24,6 +27,31 @@ namespace input {
 
   std::shared_ptr<input_t> alloc(safe::mail_t mail);
 
+  enum class event_type_e {
+    mouse,  ///< Mouse movement, buttons and scrolling
+    keyboard,  ///< Keys and text
+    gamepad,  ///< Gamepad state, arrival, motion, touchpad and battery
+    touch,  ///< Touchscreen
+    pen,  ///< Pen tablet
+    _count  ///< Number of event types
+  };
+
+  std::string_view to_string(event_type_e type);
+
+  /**
+   * @brief Time spent by one kind of input event in every processing stage, since startup.
+   */
+  struct latency_stats_t {
+    stat_trackers::latency_histogram decrypt;  ///< From receipt on the control stream until queued for the input thread
+    stat_trackers::latency_histogram queue;  ///< Waiting for the input thread
+    stat_trackers::latency_histogram batch;  ///< Coalescing with the messages queued behind it
+    stat_trackers::latency_histogram inject;  ///< Sending to the OS
+    stat_trackers::latency_histogram total;  ///< From receipt on the control stream until sent to the OS
+    std::atomic<std::uint64_t> coalesced {0};  ///< Messages merged into an earlier one instead of being sent
+  };
+
+  const latency_stats_t &latency_stats(event_type_e type);
+
   struct touch_port_t: public platf::touch_port_t {
     int env_width, env_height;
 
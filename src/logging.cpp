@@ -3,10 +3,14 @@
  * @brief Definitions for logging related functions.
  */
 // standard includes
+#include <atomic>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <streambuf>
 
 // lib includes
 #include <boost/core/null_deleter.hpp>
@@ -52,10 +56,86 @@ bl::sources::severity_logger<int> tests(10);  // Automatic tests output
 // severity keyword is declared in logging.h
 
 namespace logging {
+  namespace {
+    std::mutex listeners_lock;
+    std::map<std::size_t, std::function<void(std::string_view)>> listeners;
+    std::size_t next_listener_id = 0;
+    std::atomic_bool has_listeners = false;
+
+    /**
+     * @brief Splits the formatted records written by the sink into lines for the listeners.
+     */
+    class listener_buf_t: public std::streambuf {
+    protected:
+      int_type overflow(int_type ch) override {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+          auto c = traits_type::to_char_type(ch);
+          xsputn(&c, 1);
+        }
+
+        return traits_type::not_eof(ch);
+      }
+
+      std::streamsize xsputn(const char *s, std::streamsize n) override {
+        if (!has_listeners) {
+          line.clear();
+          return n;
+        }
+
+        std::string_view data {s, (std::size_t) n};
+        for (auto pos = data.find('\n'); pos != std::string_view::npos; pos = data.find('\n')) {
+          line.append(data.substr(0, pos));
+          data.remove_prefix(pos + 1);
+
+          std::lock_guard lg(listeners_lock);
+          for (auto &[id, on_line] : listeners) {
+            on_line(line);
+          }
+          line.clear();
+        }
+        line.append(data);
+
+        return n;
+      }
+
+    private:
+      std::string line;
+    };
+
+    /**
+     * @brief Only written to by the sink, from the logging thread.
+     */
+    std::ostream &listener_stream() {
+      static listener_buf_t buf;
+      static std::ostream stream {&buf};
+
+      return stream;
+    }
+  }  // namespace
+
   deinit_t::~deinit_t() {
     deinit();
   }
 
+  listener_t::listener_t(std::size_t id):
+      id {id} {
+  }
+
+  listener_t::~listener_t() {
+    std::lock_guard lg(listeners_lock);
+    listeners.erase(id);
+    has_listeners = !listeners.empty();
+  }
+
+  std::unique_ptr<listener_t> listen(std::function<void(std::string_view)> on_line) {
+    std::lock_guard lg(listeners_lock);
+    auto id = next_listener_id++;
+    listeners.emplace(id, std::move(on_line));
+    has_listeners = true;
+
+    return std::make_unique<listener_t>(id);
+  }
+
   void deinit() {
     log_flush();
     bl::core::get()->remove_sink(sink);
@@ -176,6 +256,7 @@ namespace logging {
       file_stream->flush();
     }
     sink->locked_backend()->add_stream(file_stream);
+    sink->locked_backend()->add_stream(boost::shared_ptr<std::ostream> {&listener_stream(), boost::null_deleter()});
     sink->set_filter(severity >= min_log_level);
     sink->set_formatter(&formatter);
 
@@ -231,6 +312,7 @@ namespace logging {
       file_stream->flush();
     }
     sink->locked_backend()->add_stream(file_stream);
+    sink->locked_backend()->add_stream(boost::shared_ptr<std::ostream> {&listener_stream(), boost::null_deleter()});
 
     sink->set_filter(severity >= min_log_level);
     sink->set_formatter(&formatter);
@@ -4,6 +4,11 @@
  */
 #pragma once
 
+// standard includes
+#include <functional>
+#include <memory>
+#include <string_view>
+
 // lib includes
 #include <boost/log/common.hpp>
 #include <boost/log/expressions.hpp>
@@ -92,6 +97,33 @@ namespace logging {
    */
   void log_flush();
 
+  /**
+   * @brief Stops a log listener when it goes out of scope.
+   */
+  class listener_t {
+  public:
+    explicit listener_t(std::size_t id);
+
+    /**
+     * @brief A destructor that removes the listener.
+     */
+    ~listener_t();
+
+  private:
+    std::size_t id;
+  };
+
+  /**
+   * @brief Receive every line written to the log, formatted as in the log file.
+   * @param on_line Called on the logging thread for each line, without the line break.
+   *                It must not block, or log itself.
+   * @return An object that removes the listener when it goes out of scope.
+   * @examples
+   * auto listener = logging::listen([](std::string_view line) { ... });
+   * @examples_end
+   */
+  [[nodiscard]] std::unique_ptr<listener_t> listen(std::function<void(std::string_view)> on_line);
+
   /**
    * @brief Print help to stdout.
    * @param name The name of the program.
@@ -6,8 +6,11 @@
 #define BOOST_BIND_GLOBAL_PLACEHOLDERS
 
 // standard includes
+#include <array>
 #include <filesystem>
 #include <format>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -20,8 +23,10 @@
 #include <Simple-Web-Server/server_http.hpp>
 
 // local includes
+#include "asset_cache.h"
 #include "config.h"
 #include "display_device.h"
+#include "events.h"
 #include "file_handler.h"
 #include "globals.h"
 #include "httpcommon.h"
@@ -32,6 +37,7 @@
 #include "process.h"
 #include "rtsp.h"
 #include "system_tray.h"
+#include "thumbnail.h"
 #include "utility.h"
 #include "uuid.h"
 #include "video.h"
@@ -43,8 +49,51 @@ namespace nvhttp {
   namespace fs = std::filesystem;
   namespace pt = boost::property_tree;
 
+  // Enough for a few hundred covers
+  constexpr std::size_t COVER_CACHE_BYTES = 64 * 1024 * 1024;
+
+  // TLS sessions clients may resume, Moonlight polls /serverinfo every few seconds while it is open
+  constexpr long TLS_SESSION_CACHE_SIZE = 1024;
+  constexpr auto TLS_SESSION_TIMEOUT = 1h;
+  constexpr std::string_view TLS_SESSION_ID_CONTEXT = "sunshine-nvhttp"sv;
+
+  tls_stats_t &tls_stats() {
+    static tls_stats_t stats;
+    return stats;
+  }
+
   crypto::cert_chain_t cert_chain;
 
+  void verified_peers_t::add(const endpoint_t &endpoint, const void *owner, crypto::x509_t &&cert) {
+    std::lock_guard lg(_lock);
+    _peers.insert_or_assign(endpoint, peer_t {owner, std::move(cert)});
+  }
+
+  void verified_peers_t::remove(const endpoint_t &endpoint, const void *owner) {
+    std::lock_guard lg(_lock);
+
+    // A new connection from the same endpoint may already have replaced the entry
+    if (auto it = _peers.find(endpoint); it != std::end(_peers) && it->second.owner == owner) {
+      _peers.erase(it);
+    }
+  }
+
+  const char *verified_peers_t::verify(const endpoint_t &endpoint, crypto::cert_chain_t &chain) {
+    std::lock_guard lg(_lock);
+
+    auto it = _peers.find(endpoint);
+    if (it == std::end(_peers)) {
+      return "The connection has no verified client certificate";
+    }
+
+    return chain.verify(it->second.cert.get());
+  }
+
+  verified_peers_t &verified_peers() {
+    static verified_peers_t peers;
+    return peers;
+  }
+
   class SunshineHTTPSServer: public SimpleWeb::ServerBase<SunshineHTTPS> {
   public:
     SunshineHTTPSServer(const std::string &certification_file, const std::string &private_key_file):
@@ -55,6 +104,16 @@ namespace nvhttp {
       context.set_options(boost::asio::ssl::context::no_tlsv1_1);
       context.use_certificate_chain_file(certification_file);
       context.use_private_key_file(private_key_file, boost::asio::ssl::context::pem);
+
+      // Resuming a session skips the key exchange and sending the client certificate. The certificate
+      // is kept in the session and still checked against the paired clients on every connection.
+      auto ctx = context.native_handle();
+      SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+      SSL_CTX_sess_set_cache_size(ctx, TLS_SESSION_CACHE_SIZE);
+      SSL_CTX_set_timeout(ctx, std::chrono::duration_cast<std::chrono::seconds>(TLS_SESSION_TIMEOUT).count());
+
+      // OpenSSL refuses to resume sessions with a verified peer without an id context
+      SSL_CTX_set_session_id_context(ctx, (const unsigned char *) TLS_SESSION_ID_CONTEXT.data(), TLS_SESSION_ID_CONTEXT.size());
     }
 
     std::function<int(SSL *)> verify;
@@ -88,6 +147,7 @@ namespace nvhttp {
         }
 
         auto session = std::make_shared<Session>(config.max_request_streambuf_size, connection);
+        auto accepted = std::chrono::steady_clock::now();
 
         if (!ec) {
           boost::asio::ip::tcp::no_delay option(true);
@@ -95,20 +155,49 @@ namespace nvhttp {
           session->connection->socket->lowest_layer().set_option(option, ec);
 
           session->connection->set_timeout(config.timeout_request);
-          session->connection->socket->async_handshake(boost::asio::ssl::stream_base::server, [this, session](const SimpleWeb::error_code &ec) {
+          session->connection->socket->async_handshake(boost::asio::ssl::stream_base::server, [this, session, accepted](const SimpleWeb::error_code &ec) {
             session->connection->cancel_timeout();
             auto lock = session->connection->handler_runner->continue_lock();
             if (!lock) {
               return;
             }
             if (!ec) {
-              if (verify && !verify(session->connection->socket->native_handle())) {
+              auto ssl = session->connection->socket->native_handle();
+              auto verified = !verify || verify(ssl);
+
+              auto &stats = tls_stats();
+              (SSL_session_reused(ssl) ? stats.resumed : stats.full).record(std::chrono::steady_clock::now() - accepted);
+
+              if (!verified) {
                 this->write(session, on_verify_failed);
-              } else {
-                this->read(session);
+                return;
+              }
+
+              // Kept to check the client again on every request of this connection
+              if (verify) {
+                SimpleWeb::error_code endpoint_ec;
+                auto endpoint = session->connection->socket->lowest_layer().remote_endpoint(endpoint_ec);
+                crypto::x509_t cert {
+#if OPENSSL_VERSION_MAJOR >= 3
+                  SSL_get1_peer_certificate(ssl)
+#else
+                  SSL_get_peer_certificate(ssl)
+#endif
+                };
+                if (!endpoint_ec && cert) {
+                  auto socket = session->connection->socket.get();
+                  verified_peers().add(endpoint, socket, std::move(cert));
+                  socket->verified_endpoint = endpoint;
+                }
+              }
+
+              this->read(session);
+            } else {
+              tls_stats().failed.fetch_add(1, std::memory_order_relaxed);
+
+              if (this->on_error) {
+                this->on_error(session->request, ec);
               }
-            } else if (this->on_error) {
-              this->on_error(session->request, ec);
             }
           });
         } else if (this->on_error) {
@@ -255,11 +344,12 @@ namespace nvhttp {
       }
     }
 
-    // Empty certificate chain and import certs from file
-    cert_chain.clear();
+    // Replace the certificate chain with the certs from file
+    std::vector<crypto::x509_t> certs;
     for (auto &named_cert : client.named_devices) {
-      cert_chain.add(crypto::x509(named_cert.cert));
+      certs.emplace_back(crypto::x509(named_cert.cert));
     }
+    cert_chain.assign(std::move(certs));
 
     client_root = client;
   }
@@ -275,6 +365,8 @@ namespace nvhttp {
     if (!config::sunshine.flags[config::flag::FRESH_STATE]) {
       save_state();
     }
+
+    events::publish(events::event_e::client_paired);
   }
 
   std::shared_ptr<rtsp_stream::launch_session_t> make_launch_session(bool host_audio, const args_t &args) {
@@ -673,138 +765,269 @@ namespace nvhttp {
     return true;
   }
 
-  template<class T>
-  void serverinfo(std::shared_ptr<typename SimpleWeb::ServerBase<T>::Response> response, std::shared_ptr<typename SimpleWeb::ServerBase<T>::Request> request) {
-    print_req<T>(request);
+  /**
+   * @brief A pre-rendered response, rendered again only when what it depends on changes.
+   */
+  template<class Key, class Value = std::string>
+  struct response_cache_t {
+    std::mutex lock;
+    std::optional<Key> key;
+    std::shared_ptr<const Value> xml;
+  };
 
-    int pair_status = 0;
-    if constexpr (std::is_same_v<SunshineHTTPS, T>) {
-      auto args = request->parse_query_string();
-      auto clientID = args.find("uniqueid"s);
+  /**
+   * @brief Everything the /serverinfo response depends on that is the same for every request.
+   */
+  struct serverinfo_key_t {
+    std::string hostname;
+    int https_port;
+    int http_port;
+    int hevc_mode;
+    int av1_mode;
+    std::array<bool, 3> yuv444;
+    int current_appid;
+
+    auto operator<=>(const serverinfo_key_t &) const = default;
+  };
 
-      if (clientID != std::end(args)) {
-        pair_status = 1;
-      }
+  /**
+   * @brief Everything the /applist response depends on.
+   */
+  struct applist_key_t {
+    std::uint64_t apps_generation;
+    int hevc_mode;
+
+    auto operator<=>(const applist_key_t &) const = default;
+  };
+
+  /**
+   * @brief The /serverinfo response without the values that depend on the request.
+   */
+  struct serverinfo_template_t {
+    std::string xml;
+    // Where the MAC address, local IP and pair status go, in that order
+    std::array<std::size_t, 3> offsets;
+  };
+
+  /**
+   * @brief Get the cached response, rendering it again if the key changed.
+   * @param cache The cache of the response.
+   * @param key Everything the response depends on.
+   * @param render Renders the response for a key.
+   * @return The response.
+   */
+  template<class Key, class Value, class Render>
+  std::shared_ptr<const Value> cached_response(response_cache_t<Key, Value> &cache, const Key &key, Render &&render) {
+    std::lock_guard lg(cache.lock);
+
+    if (!cache.xml || cache.key != key) {
+      cache.xml = std::make_shared<const Value>(render(key));
+      cache.key = key;
     }
 
-    auto local_endpoint = request->local_endpoint();
+    return cache.xml;
+  }
+
+  serverinfo_template_t render_serverinfo(const serverinfo_key_t &key) {
+    // Placeholders no host name can contain, so only the ones written below are found
+    auto nonce = crypto::rand_alphabet(16, "abcdefghijklmnopqrstuvwxyz0123456789"sv);
+    const std::array<std::string, 3> fields {
+      "@@mac-" + nonce + "@@",
+      "@@LocalIP-" + nonce + "@@",
+      "@@PairStatus-" + nonce + "@@",
+    };
 
     pt::ptree tree;
 
     tree.put("root.<xmlattr>.status_code", 200);
-    tree.put("root.hostname", config::nvhttp.sunshine_name);
+    tree.put("root.hostname", key.hostname);
 
     tree.put("root.appversion", VERSION);
     tree.put("root.GfeVersion", GFE_VERSION);
     tree.put("root.uniqueid", http::unique_id);
-    tree.put("root.HttpsPort", net::map_port(PORT_HTTPS));
-    tree.put("root.ExternalPort", net::map_port(PORT_HTTP));
-    tree.put("root.MaxLumaPixelsHEVC", video::active_hevc_mode > 1 ? "1869449984" : "0");
-
-    // Only include the MAC address for requests sent from paired clients over HTTPS.
-    // For HTTP requests, use a placeholder MAC address that Moonlight knows to ignore.
-    if constexpr (std::is_same_v<SunshineHTTPS, T>) {
-      tree.put("root.mac", platf::get_mac_address(net::addr_to_normalized_string(local_endpoint.address())));
-    } else {
-      tree.put("root.mac", "00:00:00:00:00:00");
-    }
-
-    // Moonlight clients track LAN IPv6 addresses separately from LocalIP which is expected to
-    // always be an IPv4 address. If we return that same IPv6 address here, it will clobber the
-    // stored LAN IPv4 address. To avoid this, we need to return an IPv4 address in this field
-    // when we get a request over IPv6.
-    //
-    // HACK: We should return the IPv4 address of local interface here, but we don't currently
-    // have that implemented. For now, we will emulate the behavior of GFE+GS-IPv6-Forwarder,
-    // which returns 127.0.0.1 as LocalIP for IPv6 connections. Moonlight clients with IPv6
-    // support know to ignore this bogus address.
-    if (local_endpoint.address().is_v6() && !local_endpoint.address().to_v6().is_v4_mapped()) {
-      tree.put("root.LocalIP", "127.0.0.1");
-    } else {
-      tree.put("root.LocalIP", net::addr_to_normalized_string(local_endpoint.address()));
-    }
+    tree.put("root.HttpsPort", key.https_port);
+    tree.put("root.ExternalPort", key.http_port);
+    tree.put("root.MaxLumaPixelsHEVC", key.hevc_mode > 1 ? "1869449984" : "0");
+    tree.put("root.mac", fields[0]);
+    tree.put("root.LocalIP", fields[1]);
 
     uint32_t codec_mode_flags = SCM_H264;
-    if (video::last_encoder_probe_supported_yuv444_for_codec[0]) {
+    if (key.yuv444[0]) {
       codec_mode_flags |= SCM_H264_HIGH8_444;
     }
-    if (video::active_hevc_mode >= 2) {
+    if (key.hevc_mode >= 2) {
       codec_mode_flags |= SCM_HEVC;
-      if (video::last_encoder_probe_supported_yuv444_for_codec[1]) {
+      if (key.yuv444[1]) {
         codec_mode_flags |= SCM_HEVC_REXT8_444;
       }
     }
-    if (video::active_hevc_mode >= 3) {
+    if (key.hevc_mode >= 3) {
       codec_mode_flags |= SCM_HEVC_MAIN10;
-      if (video::last_encoder_probe_supported_yuv444_for_codec[1]) {
+      if (key.yuv444[1]) {
         codec_mode_flags |= SCM_HEVC_REXT10_444;
       }
     }
-    if (video::active_av1_mode >= 2) {
+    if (key.av1_mode >= 2) {
       codec_mode_flags |= SCM_AV1_MAIN8;
-      if (video::last_encoder_probe_supported_yuv444_for_codec[2]) {
+      if (key.yuv444[2]) {
         codec_mode_flags |= SCM_AV1_HIGH8_444;
       }
     }
-    if (video::active_av1_mode >= 3) {
+    if (key.av1_mode >= 3) {
       codec_mode_flags |= SCM_AV1_MAIN10;
-      if (video::last_encoder_probe_supported_yuv444_for_codec[2]) {
+      if (key.yuv444[2]) {
         codec_mode_flags |= SCM_AV1_HIGH10_444;
       }
     }
     tree.put("root.ServerCodecModeSupport", codec_mode_flags);
 
-    auto current_appid = proc::proc.running();
-    tree.put("root.PairStatus", pair_status);
-    tree.put("root.currentgame", current_appid);
-    tree.put("root.state", current_appid > 0 ? "SUNSHINE_SERVER_BUSY" : "SUNSHINE_SERVER_FREE");
+    tree.put("root.PairStatus", fields[2]);
+    tree.put("root.currentgame", key.current_appid);
+    tree.put("root.state", key.current_appid > 0 ? "SUNSHINE_SERVER_BUSY" : "SUNSHINE_SERVER_FREE");
 
     std::ostringstream data;
 
     pt::write_xml(data, tree);
-    response->write(data.str());
-    response->close_connection_after_response = true;
+
+    // Cut out the placeholders and remember where they were
+    serverinfo_template_t result {data.str(), {}};
+    for (std::size_t x = 0; x < fields.size(); ++x) {
+      auto pos = result.xml.find(fields[x]);
+      result.xml.erase(pos, fields[x].size());
+      result.offsets[x] = pos;
+    }
+
+    return result;
   }
 
-  nlohmann::json get_all_clients() {
-    nlohmann::json named_cert_nodes = nlohmann::json::array();
-    client_t &client = client_root;
-    for (auto &named_cert : client.named_devices) {
-      nlohmann::json named_cert_node;
-      named_cert_node["name"] = named_cert.name;
-      named_cert_node["uuid"] = named_cert.uuid;
-      named_cert_nodes.push_back(named_cert_node);
+  std::string serverinfo_xml(std::string_view mac, std::string_view local_ip, int pair_status) {
+    static response_cache_t<serverinfo_key_t, serverinfo_template_t> cache;
+
+    serverinfo_key_t key {
+      config::nvhttp.sunshine_name,
+      net::map_port(PORT_HTTPS),
+      net::map_port(PORT_HTTP),
+      video::active_hevc_mode,
+      video::active_av1_mode,
+      video::last_encoder_probe_supported_yuv444_for_codec,
+      proc::proc.running(),
+    };
+
+    auto info = cached_response(cache, key, render_serverinfo);
+
+    // Patch in the values that depend on the request, in the order they appear
+    auto pair_status_str = std::to_string(pair_status);
+    const std::array<std::string_view, 3> values {mac, local_ip, pair_status_str};
+
+    std::string response;
+    response.reserve(info->xml.size() + mac.size() + local_ip.size() + pair_status_str.size());
+
+    std::string_view xml = info->xml;
+    std::size_t copied = 0;
+    for (std::size_t x = 0; x < values.size(); ++x) {
+      response.append(xml.substr(copied, info->offsets[x] - copied));
+      response.append(values[x]);
+      copied = info->offsets[x];
     }
+    response.append(xml.substr(copied));
 
-    return named_cert_nodes;
+    return response;
   }
 
-  void applist(resp_https_t response, req_https_t request) {
-    print_req<SunshineHTTPS>(request);
+  std::shared_ptr<const std::string> applist_xml() {
+    static response_cache_t<applist_key_t> cache;
 
-    pt::ptree tree;
+    applist_key_t key {
+      proc::proc.apps_generation(),
+      video::active_hevc_mode,
+    };
+
+    return cached_response(cache, key, [](const applist_key_t &key) {
+      pt::ptree tree;
+
+      auto &apps = tree.add_child("root", pt::ptree {});
+
+      apps.put("<xmlattr>.status_code", 200);
+
+      for (auto &proc : proc::proc.get_apps()) {
+        pt::ptree app;
+
+        app.put("IsHdrSupported"s, key.hevc_mode == 3 ? 1 : 0);
+        app.put("AppTitle"s, proc.name);
+        app.put("ID", proc.id);
+
+        apps.push_back(std::make_pair("App", std::move(app)));
+      }
 
-    auto g = util::fail_guard([&]() {
       std::ostringstream data;
 
       pt::write_xml(data, tree);
-      response->write(data.str());
-      response->close_connection_after_response = true;
+      return data.str();
     });
+  }
 
-    auto &apps = tree.add_child("root", pt::ptree {});
+  template<class T>
+  void serverinfo(std::shared_ptr<typename SimpleWeb::ServerBase<T>::Response> response, std::shared_ptr<typename SimpleWeb::ServerBase<T>::Request> request) {
+    print_req<T>(request);
 
-    apps.put("<xmlattr>.status_code", 200);
+    int pair_status = 0;
+    if constexpr (std::is_same_v<SunshineHTTPS, T>) {
+      auto args = request->parse_query_string();
+      auto clientID = args.find("uniqueid"s);
 
-    for (auto &proc : proc::proc.get_apps()) {
-      pt::ptree app;
+      if (clientID != std::end(args)) {
+        pair_status = 1;
+      }
+    }
+
+    auto local_endpoint = request->local_endpoint();
+
+    // Only include the MAC address for requests sent from paired clients over HTTPS.
+    // For HTTP requests, use a placeholder MAC address that Moonlight knows to ignore.
+    std::string mac;
+    if constexpr (std::is_same_v<SunshineHTTPS, T>) {
+      mac = platf::get_mac_address(net::addr_to_normalized_string(local_endpoint.address()));
+    } else {
+      mac = "00:00:00:00:00:00";
+    }
+
+    // Moonlight clients track LAN IPv6 addresses separately from LocalIP which is expected to
+    // always be an IPv4 address. If we return that same IPv6 address here, it will clobber the
+    // stored LAN IPv4 address. To avoid this, we need to return an IPv4 address in this field
+    // when we get a request over IPv6.
+    //
+    // HACK: We should return the IPv4 address of local interface here, but we don't currently
+    // have that implemented. For now, we will emulate the behavior of GFE+GS-IPv6-Forwarder,
+    // which returns 127.0.0.1 as LocalIP for IPv6 connections. Moonlight clients with IPv6
+    // support know to ignore this bogus address.
+    std::string local_ip;
+    if (local_endpoint.address().is_v6() && !local_endpoint.address().to_v6().is_v4_mapped()) {
+      local_ip = "127.0.0.1";
+    } else {
+      local_ip = net::addr_to_normalized_string(local_endpoint.address());
+    }
 
-      app.put("IsHdrSupported"s, video::active_hevc_mode == 3 ? 1 : 0);
-      app.put("AppTitle"s, proc.name);
-      app.put("ID", proc.id);
+    // Polled by clients, keep the connection so the next poll doesn't need another handshake
+    response->write(serverinfo_xml(mac, local_ip, pair_status));
+  }
 
-      apps.push_back(std::make_pair("App", std::move(app)));
+  nlohmann::json get_all_clients() {
+    nlohmann::json named_cert_nodes = nlohmann::json::array();
+    client_t &client = client_root;
+    for (auto &named_cert : client.named_devices) {
+      nlohmann::json named_cert_node;
+      named_cert_node["name"] = named_cert.name;
+      named_cert_node["uuid"] = named_cert.uuid;
+      named_cert_nodes.push_back(named_cert_node);
     }
+
+    return named_cert_nodes;
+  }
+
+  void applist(resp_https_t response, req_https_t request) {
+    print_req<SunshineHTTPS>(request);
+
+    response->write(*applist_xml());
   }
 
   void launch(bool &host_audio, resp_https_t response, req_https_t request) {
@@ -1036,11 +1259,36 @@ namespace nvhttp {
     auto args = request->parse_query_string();
     auto app_image = proc::proc.get_app_image(util::from_view(get_arg(args, "appid")));
 
-    std::ifstream in(app_image, std::ios::binary);
+    // Moonlight only renders small tiles, serve a scaled down cover unless the client asks for a larger one
+    std::optional<std::uint32_t> width_hint;
+    if (auto width = util::from_view(get_arg(args, "width", "0")); width > 0) {
+      width_hint = (std::uint32_t) std::min<std::int64_t>(width, UINT32_MAX);
+    }
+    app_image = thumbnail::select(app_image, width_hint).string();
+
+    // Clients fetch every cover again on each app list refresh, keep them in memory
+    static http::asset_cache_t covers {COVER_CACHE_BYTES};
+
+    auto asset = covers.get(app_image);
+    if (!asset) {
+      BOOST_LOG(warning) << "Couldn't read app image ["sv << app_image << ']';
+      response->write(SimpleWeb::StatusCode::client_error_not_found);
+      return;
+    }
+
+    // Clients must revalidate, which costs a 304 without a body when the cover didn't change
     SimpleWeb::CaseInsensitiveMultimap headers;
+    headers.emplace("ETag", asset->etag);
+    headers.emplace("Cache-Control", "no-cache");
+
+    auto if_none_match = request->header.find("If-None-Match");
+    if (if_none_match != std::end(request->header) && http::etag_matches(if_none_match->second, asset->etag)) {
+      response->write(SimpleWeb::StatusCode::redirection_not_modified, headers);
+      return;
+    }
+
     headers.emplace("Content-Type", "image/png");
-    response->write(SimpleWeb::StatusCode::success_ok, in, headers);
-    response->close_connection_after_response = true;
+    response->write(SimpleWeb::StatusCode::success_ok, asset->data, headers);
   }
 
   void setup(const std::string &pkey, const std::string &cert) {
@@ -1135,20 +1383,34 @@ namespace nvhttp {
       tree.put("root.<xmlattr>.status_message"s, "The client is not authorized. Certificate verification failed."s);
     };
 
+    // Connections outlive the handshake, so the client is checked again for every request.
+    // A client unpaired while its connection is open is rejected from its next request on.
+    auto verified = [&https_server](std::function<void(resp_https_t, req_https_t)> handler) {
+      return [&https_server, handler = std::move(handler)](resp_https_t resp, req_https_t req) {
+        if (auto err_str = verified_peers().verify(req->remote_endpoint(), cert_chain)) {
+          BOOST_LOG(info) << "Request from "sv << req->remote_endpoint().address().to_string() << " denied :: "sv << err_str;
+          https_server.on_verify_failed(resp, req);
+          return;
+        }
+
+        handler(resp, req);
+      };
+    };
+
     https_server.default_resource["GET"] = not_found<SunshineHTTPS>;
-    https_server.resource["^/serverinfo$"]["GET"] = serverinfo<SunshineHTTPS>;
-    https_server.resource["^/pair$"]["GET"] = [&add_cert](auto resp, auto req) {
+    https_server.resource["^/serverinfo$"]["GET"] = verified(serverinfo<SunshineHTTPS>);
+    https_server.resource["^/pair$"]["GET"] = verified([&add_cert](auto resp, auto req) {
       pair<SunshineHTTPS>(add_cert, resp, req);
-    };
-    https_server.resource["^/applist$"]["GET"] = applist;
-    https_server.resource["^/appasset$"]["GET"] = appasset;
-    https_server.resource["^/launch$"]["GET"] = [&host_audio](auto resp, auto req) {
+    });
+    https_server.resource["^/applist$"]["GET"] = verified(applist);
+    https_server.resource["^/appasset$"]["GET"] = verified(appasset);
+    https_server.resource["^/launch$"]["GET"] = verified([&host_audio](auto resp, auto req) {
       launch(host_audio, resp, req);
-    };
-    https_server.resource["^/resume$"]["GET"] = [&host_audio](auto resp, auto req) {
+    });
+    https_server.resource["^/resume$"]["GET"] = verified([&host_audio](auto resp, auto req) {
       resume(host_audio, resp, req);
-    };
-    https_server.resource["^/cancel$"]["GET"] = cancel;
+    });
+    https_server.resource["^/cancel$"]["GET"] = verified(cancel);
 
     https_server.config.reuse_address = true;
     https_server.config.address = net::af_to_any_address_string(address_family);
@@ -1196,6 +1458,8 @@ namespace nvhttp {
     client_root = client;
     cert_chain.clear();
     save_state();
+
+    events::publish(events::event_e::client_unpaired);
   }
 
   bool unpair_client(const std::string_view uuid) {
@@ -1212,6 +1476,10 @@ namespace nvhttp {
 
     save_state();
     load_state();
+
+    if (removed) {
+      events::publish(events::event_e::client_unpaired);
+    }
     return removed;
   }
 }  // namespace nvhttp
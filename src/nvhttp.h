@@ -6,7 +6,14 @@
 #pragma once
 
 // standard includes
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
 
 // lib includes
 #include <boost/property_tree/ptree.hpp>
@@ -15,6 +22,7 @@
 
 // local includes
 #include "crypto.h"
+#include "stat_trackers.h"
 #include "thread_safe.h"
 
 /**
@@ -52,6 +60,42 @@ namespace nvhttp {
    */
   void start();
 
+  /**
+   * @brief Get the body of the /serverinfo response.
+   * @details The XML is rendered once and reused until the host name, ports, encoder
+   *          capabilities or running app change. Only the request specific values are patched in.
+   * @param mac The MAC address to report.
+   * @param local_ip The local IP address to report.
+   * @param pair_status 1 if the request comes from a paired client.
+   * @return The XML response.
+   */
+  std::string serverinfo_xml(std::string_view mac, std::string_view local_ip, int pair_status);
+
+  /**
+   * @brief Get the body of the /applist response.
+   * @details The XML is rendered once and reused until the app list or the HDR support change.
+   * @return The XML response.
+   */
+  std::shared_ptr<const std::string> applist_xml();
+
+  /**
+   * @brief TLS handshakes on the HTTPS server since startup.
+   * @details Durations run from accepting the connection until the client certificate was verified.
+   */
+  struct tls_stats_t {
+    const std::chrono::steady_clock::time_point since = std::chrono::steady_clock::now();
+
+    std::atomic<std::uint64_t> failed {0};
+
+    stat_trackers::latency_histogram full;
+    stat_trackers::latency_histogram resumed;
+  };
+
+  /**
+   * @brief Get the TLS handshake statistics of the HTTPS server.
+   */
+  tls_stats_t &tls_stats();
+
   /**
    * @brief Setup the nvhttp server.
    * @param pkey
@@ -59,6 +103,54 @@ namespace nvhttp {
    */
   void setup(const std::string &pkey, const std::string &cert);
 
+  /**
+   * @brief The client certificates of the open HTTPS connections.
+   * @details Connections stay open between polls and the certificate is only sent during the
+   *          handshake, so every request checks the certificate of its connection against the
+   *          currently paired clients. Unpairing a client then rejects its next request.
+   */
+  class verified_peers_t {
+  public:
+    using endpoint_t = boost::asio::ip::tcp::endpoint;
+
+    /**
+     * @brief Remember the certificate a connection was verified with.
+     * @param endpoint The remote endpoint of the connection.
+     * @param owner Identifies the connection, only the owner can remove the entry.
+     * @param cert The client certificate.
+     */
+    void add(const endpoint_t &endpoint, const void *owner, crypto::x509_t &&cert);
+
+    /**
+     * @brief Forget a closed connection.
+     * @param endpoint The remote endpoint of the connection.
+     * @param owner The owner passed to add().
+     */
+    void remove(const endpoint_t &endpoint, const void *owner);
+
+    /**
+     * @brief Check a request against the paired clients.
+     * @param endpoint The remote endpoint of the request.
+     * @param chain The paired clients.
+     * @return `nullptr` if the connection's client is still paired, otherwise the reason it isn't.
+     */
+    const char *verify(const endpoint_t &endpoint, crypto::cert_chain_t &chain);
+
+  private:
+    struct peer_t {
+      const void *owner;
+      crypto::x509_t cert;
+    };
+
+    std::mutex _lock;
+    std::map<endpoint_t, peer_t> _peers;
+  };
+
+  /**
+   * @brief Get the client certificates of the open HTTPS connections.
+   */
+  verified_peers_t &verified_peers();
+
   class SunshineHTTPS: public SimpleWeb::HTTPS {
   public:
     SunshineHTTPS(boost::asio::io_context &io_context, boost::asio::ssl::context &ctx):
@@ -66,10 +158,19 @@ namespace nvhttp {
     }
 
     virtual ~SunshineHTTPS() {
+      if (verified_endpoint) {
+        verified_peers().remove(*verified_endpoint, this);
+      }
+
       // Gracefully shutdown the TLS connection
       SimpleWeb::error_code ec;
       shutdown(ec);
     }
+
+    /**
+     * @brief Set once the client certificate was verified, the connection is then in verified_peers().
+     */
+    std::optional<boost::asio::ip::tcp::endpoint> verified_endpoint;
   };
 
   enum class PAIR_PHASE {
@@ -547,6 +547,14 @@ namespace platf {
   public:
     virtual capture_e sample(std::vector<float> &frame_buffer) = 0;
 
+    /**
+     * @brief Get the time the first sample of the last frame returned by `sample()` was captured.
+     * @return The capture time, or `std::nullopt` if the backend can't tell.
+     */
+    virtual std::optional<std::chrono::steady_clock::time_point> capture_time() const {
+      return std::nullopt;
+    }
+
     virtual ~mic_t() = default;
   };
 
@@ -601,6 +609,13 @@ namespace platf {
    */
   bool needs_encoder_reenumeration();
 
+  /**
+   * @brief Describe the GPUs and drivers available for encoding.
+   * @details Cached encoder probe results are only reused while this stays the same.
+   * @return A string that changes whenever a GPU or its driver is added, removed or updated.
+   */
+  std::string encoder_identity();
+
   boost::process::v1::child run_command(bool elevated, bool interactive, const std::string &cmd, boost::filesystem::path &working_dir, const boost::process::v1::environment &env, FILE *file, std::error_code &ec, boost::process::v1::group *group);
 
   enum class thread_priority_e : int {
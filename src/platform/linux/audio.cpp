@@ -3,7 +3,9 @@
  * @brief Definitions for audio control on Linux.
  */
 // standard includes
+#include <atomic>
 #include <bitset>
+#include <chrono>
 #include <sstream>
 #include <thread>
 
@@ -11,7 +13,6 @@
 #include <boost/regex.hpp>
 #include <pulse/error.h>
 #include <pulse/pulseaudio.h>
-#include <pulse/simple.h>
 
 // local includes
 #include "src/config.h"
@@ -50,22 +51,181 @@ namespace platf {
     return result;
   }
 
+  /**
+   * @brief Asynchronous record stream on its own threaded mainloop.
+   *
+   * The mainloop thread copies every fragment the server delivers into a preallocated
+   * FIFO and keeps track of when the newest sample was captured, so `sample()` can hand
+   * out frames together with their capture time.
+   */
   struct mic_attr_t: public mic_t {
-    util::safe_ptr<pa_simple, pa_simple_free> mic;
+    using loop_t = util::safe_ptr<pa_threaded_mainloop, pa_threaded_mainloop_free>;
+    using ctx_t = util::safe_ptr<pa_context, pa_context_unref>;
+    using stream_t = util::safe_ptr<pa_stream, pa_stream_unref>;
+
+    // Frames the FIFO and the server buffer can hold before the oldest samples are dropped
+    static constexpr std::size_t fifo_frames = 8;
+
+    loop_t loop;
+    ctx_t ctx;
+    stream_t stream;
+
+    std::uint32_t sample_rate;
+    std::uint32_t channels;
+
+    // Guarded by the mainloop lock
+    std::vector<float> fifo;
+    std::size_t fifo_begin = 0;
+    std::size_t fifo_size = 0;
+    std::chrono::steady_clock::time_point fifo_end_time;
+    std::optional<std::chrono::steady_clock::time_point> frame_time;
+
+    std::atomic<std::uint64_t> overruns {0};
+    std::atomic<std::uint64_t> server_overflows {0};
+    std::atomic<std::uint64_t> underruns {0};
+
+    ~mic_attr_t() override {
+      if (!loop) {
+        return;
+      }
+
+      pa_threaded_mainloop_lock(loop.get());
+      if (stream) {
+        pa_stream_disconnect(stream.get());
+      }
+      if (ctx) {
+        pa_context_disconnect(ctx.get());
+      }
+      pa_threaded_mainloop_unlock(loop.get());
+      pa_threaded_mainloop_stop(loop.get());
+
+      if (overruns || server_overflows || underruns) {
+        BOOST_LOG(warning) << "Audio capture dropped "sv << overruns << " samples, had "sv << server_overflows
+                           << " server overflows and filled "sv << underruns << " gaps with silence"sv;
+      }
+    }
+
+    static void state_cb(pa_context *, void *userdata) {
+      auto mic = (mic_attr_t *) userdata;
+      pa_threaded_mainloop_signal(mic->loop.get(), 0);
+    }
+
+    static void stream_state_cb(pa_stream *, void *userdata) {
+      auto mic = (mic_attr_t *) userdata;
+      pa_threaded_mainloop_signal(mic->loop.get(), 0);
+    }
+
+    static void overflow_cb(pa_stream *, void *userdata) {
+      auto mic = (mic_attr_t *) userdata;
+
+      ++mic->server_overflows;
+      BOOST_LOG(debug) << "Pulseaudio record stream overflowed"sv;
+    }
+
+    static void read_cb(pa_stream *s, std::size_t, void *userdata) {
+      auto mic = (mic_attr_t *) userdata;
+
+      // Age of the oldest sample still waiting in the server
+      pa_usec_t latency = 0;
+      int negative = 0;
+      if (pa_stream_get_latency(s, &latency, &negative) || negative) {
+        latency = 0;
+      }
+      auto first_sample_time = std::chrono::steady_clock::now() - std::chrono::microseconds(latency);
+
+      std::size_t samples_read = 0;
+      while (pa_stream_readable_size(s) > 0) {
+        const void *data;
+        std::size_t bytes;
+        if (pa_stream_peek(s, &data, &bytes) < 0) {
+          BOOST_LOG(error) << "pa_stream_peek() failed: "sv << pa_strerror(pa_context_errno(mic->ctx.get()));
+          break;
+        }
+
+        if (bytes == 0) {
+          break;
+        }
+
+        // A null pointer with a size is a hole in the stream, the source had nothing to give us
+        if (!data) {
+          ++mic->underruns;
+        }
+
+        mic->push((const float *) data, bytes / sizeof(float));
+        samples_read += bytes / sizeof(float);
+
+        pa_stream_drop(s);
+      }
+
+      auto duration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>((double) samples_read / mic->channels / mic->sample_rate));
+      mic->fifo_end_time = first_sample_time + duration;
+
+      pa_threaded_mainloop_signal(mic->loop.get(), 0);
+    }
+
+    void push(const float *data, std::size_t count) {
+      for (std::size_t x = 0; x < count; ++x) {
+        if (fifo_size == fifo.size()) {
+          // The capture thread fell behind, drop the oldest sample to keep latency bounded
+          fifo_begin = (fifo_begin + 1) % fifo.size();
+          --fifo_size;
+          ++overruns;
+        }
+
+        fifo[(fifo_begin + fifo_size) % fifo.size()] = data ? data[x] : 0.0f;
+        ++fifo_size;
+      }
+    }
+
+    /**
+     * @brief Wait on the mainloop until the state check returns a final result.
+     * @return 0 when ready, -1 on failure.
+     */
+    template<class F>
+    int wait_for(F &&is_ready) {
+      while (true) {
+        auto status = is_ready();
+        if (status != 1) {
+          return status;
+        }
+
+        pa_threaded_mainloop_wait(loop.get());
+      }
+    }
 
     capture_e sample(std::vector<float> &sample_buf) override {
       auto sample_size = sample_buf.size();
 
-      auto buf = sample_buf.data();
-      int status;
-      if (pa_simple_read(mic.get(), buf, sample_size * sizeof(float), &status)) {
-        BOOST_LOG(error) << "pa_simple_read() failed: "sv << pa_strerror(status);
+      pa_threaded_mainloop_lock(loop.get());
+      auto fg = util::fail_guard([this]() {
+        pa_threaded_mainloop_unlock(loop.get());
+      });
+
+      while (fifo_size < sample_size) {
+        if (!PA_STREAM_IS_GOOD(pa_stream_get_state(stream.get()))) {
+          BOOST_LOG(error) << "Pulseaudio record stream failed: "sv << pa_strerror(pa_context_errno(ctx.get()));
+          return capture_e::error;
+        }
 
-        return capture_e::error;
+        pa_threaded_mainloop_wait(loop.get());
       }
 
+      auto buffered = std::chrono::duration<double>((double) fifo_size / channels / sample_rate);
+      frame_time = fifo_end_time - std::chrono::duration_cast<std::chrono::steady_clock::duration>(buffered);
+
+      auto first = std::min(sample_size, fifo.size() - fifo_begin);
+      std::copy_n(std::begin(fifo) + fifo_begin, first, std::begin(sample_buf));
+      std::copy_n(std::begin(fifo), sample_size - first, std::begin(sample_buf) + first);
+
+      fifo_begin = (fifo_begin + sample_size) % fifo.size();
+      fifo_size -= sample_size;
+
       return capture_e::ok;
     }
+
+    std::optional<std::chrono::steady_clock::time_point> capture_time() const override {
+      return frame_time;
+    }
   };
 
   std::unique_ptr<mic_t> microphone(const std::uint8_t *mapping, int channels, std::uint32_t sample_rate, std::uint32_t frame_size, std::string source_name) {
@@ -79,26 +239,84 @@ namespace platf {
       channel = position_mapping[*mapping++];
     });
 
+    auto frame_bytes = uint32_t(frame_size * channels * sizeof(float));
+
+    // Ask for one packet per fragment and cap the server side buffer, instead of
+    // leaving the capture latency up to the server
     pa_buffer_attr pa_attr = {
-      .maxlength = uint32_t(-1),
+      .maxlength = frame_bytes * mic_attr_t::fifo_frames,
       .tlength = uint32_t(-1),
       .prebuf = uint32_t(-1),
       .minreq = uint32_t(-1),
-      .fragsize = uint32_t(frame_size * channels * sizeof(float))
+      .fragsize = frame_bytes
     };
 
-    int status;
+    mic->sample_rate = sample_rate;
+    mic->channels = channels;
+    mic->fifo.resize(frame_size * channels * mic_attr_t::fifo_frames);
+
+    mic->loop.reset(pa_threaded_mainloop_new());
+    if (!mic->loop) {
+      BOOST_LOG(error) << "pa_threaded_mainloop_new() failed"sv;
+      return nullptr;
+    }
 
-    mic->mic.reset(
-      pa_simple_new(nullptr, "sunshine", pa_stream_direction_t::PA_STREAM_RECORD, source_name.c_str(), "sunshine-record", &ss, &pa_map, &pa_attr, &status)
-    );
+    mic->ctx.reset(pa_context_new(pa_threaded_mainloop_get_api(mic->loop.get()), "sunshine"));
+    pa_context_set_state_callback(mic->ctx.get(), mic_attr_t::state_cb, mic.get());
 
-    if (!mic->mic) {
-      auto err_str = pa_strerror(status);
-      BOOST_LOG(error) << "pa_simple_new() failed: "sv << err_str;
+    if (pa_context_connect(mic->ctx.get(), nullptr, PA_CONTEXT_NOFLAGS, nullptr) < 0) {
+      BOOST_LOG(error) << "Couldn't connect to pulseaudio: "sv << pa_strerror(pa_context_errno(mic->ctx.get()));
       return nullptr;
     }
 
+    pa_threaded_mainloop_lock(mic->loop.get());
+    auto fg = util::fail_guard([&mic]() {
+      pa_threaded_mainloop_unlock(mic->loop.get());
+    });
+
+    if (pa_threaded_mainloop_start(mic->loop.get()) < 0) {
+      BOOST_LOG(error) << "pa_threaded_mainloop_start() failed"sv;
+      return nullptr;
+    }
+
+    auto status = mic->wait_for([&]() {
+      auto state = pa_context_get_state(mic->ctx.get());
+      return state == PA_CONTEXT_READY ? 0 : PA_CONTEXT_IS_GOOD(state) ? 1 : -1;
+    });
+    if (status) {
+      BOOST_LOG(error) << "Couldn't connect to pulseaudio: "sv << pa_strerror(pa_context_errno(mic->ctx.get()));
+      return nullptr;
+    }
+
+    mic->stream.reset(pa_stream_new(mic->ctx.get(), "sunshine-record", &ss, &pa_map));
+    if (!mic->stream) {
+      BOOST_LOG(error) << "pa_stream_new() failed: "sv << pa_strerror(pa_context_errno(mic->ctx.get()));
+      return nullptr;
+    }
+
+    pa_stream_set_state_callback(mic->stream.get(), mic_attr_t::stream_state_cb, mic.get());
+    pa_stream_set_read_callback(mic->stream.get(), mic_attr_t::read_cb, mic.get());
+    pa_stream_set_overflow_callback(mic->stream.get(), mic_attr_t::overflow_cb, mic.get());
+
+    auto flags = pa_stream_flags_t(PA_STREAM_ADJUST_LATENCY | PA_STREAM_INTERPOLATE_TIMING | PA_STREAM_AUTO_TIMING_UPDATE);
+    if (pa_stream_connect_record(mic->stream.get(), source_name.empty() ? nullptr : source_name.c_str(), &pa_attr, flags) < 0) {
+      BOOST_LOG(error) << "pa_stream_connect_record() failed: "sv << pa_strerror(pa_context_errno(mic->ctx.get()));
+      return nullptr;
+    }
+
+    status = mic->wait_for([&]() {
+      auto state = pa_stream_get_state(mic->stream.get());
+      return state == PA_STREAM_READY ? 0 : PA_STREAM_IS_GOOD(state) ? 1 : -1;
+    });
+    if (status) {
+      BOOST_LOG(error) << "Couldn't connect record stream: "sv << pa_strerror(pa_context_errno(mic->ctx.get()));
+      return nullptr;
+    }
+
+    if (auto attr = pa_stream_get_buffer_attr(mic->stream.get())) {
+      BOOST_LOG(debug) << "Record stream buffer: maxlength="sv << attr->maxlength << " fragsize="sv << attr->fragsize;
+    }
+
     return mic;
   }
 
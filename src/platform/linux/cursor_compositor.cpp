@@ -0,0 +1,207 @@
+/**
+ * @file src/platform/linux/cursor_compositor.cpp
+ * @brief Definitions for the software cursor compositor used by the RAM capture paths.
+ */
+// standard includes
+#include <algorithm>
+#include <cstring>
+
+// platform includes
+#if defined(__x86_64__) || defined(__i386__)
+  #include <immintrin.h>
+  #define SUNSHINE_CURSOR_X86 1
+#endif
+
+// local includes
+#include "cursor_compositor.h"
+
+namespace platf {
+  namespace {
+    /**
+     * @brief Exact rounded division by 255 for values in [0, 255 * 255].
+     */
+    inline std::uint32_t div255(std::uint32_t v) {
+      v += 128;
+      return (v + (v >> 8)) >> 8;
+    }
+
+#ifdef SUNSHINE_CURSOR_X86
+    __attribute__((target("sse2"))) inline __m128i blend_sse2(__m128i dst, __m128i src) {
+      const auto zero = _mm_setzero_si128();
+      const auto v255 = _mm_set1_epi16(255);
+      const auto v128 = _mm_set1_epi16(128);
+
+      auto src_lo = _mm_unpacklo_epi8(src, zero);
+      auto src_hi = _mm_unpackhi_epi8(src, zero);
+
+      // Broadcast each pixel's alpha to all four of its 16-bit channels
+      auto inv_lo = _mm_sub_epi16(v255, _mm_shufflehi_epi16(_mm_shufflelo_epi16(src_lo, 0xFF), 0xFF));
+      auto inv_hi = _mm_sub_epi16(v255, _mm_shufflehi_epi16(_mm_shufflelo_epi16(src_hi, 0xFF), 0xFF));
+
+      auto t_lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), inv_lo), v128);
+      auto t_hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), inv_hi), v128);
+
+      t_lo = _mm_srli_epi16(_mm_add_epi16(t_lo, _mm_srli_epi16(t_lo, 8)), 8);
+      t_hi = _mm_srli_epi16(_mm_add_epi16(t_hi, _mm_srli_epi16(t_hi, 8)), 8);
+
+      return _mm_adds_epu8(_mm_packus_epi16(t_lo, t_hi), src);
+    }
+
+    __attribute__((target("sse2"))) void blend_row_sse2(std::uint32_t *dst, const std::uint32_t *src, int count) {
+      int i = 0;
+      for (; i + 4 <= count; i += 4) {
+        auto s = _mm_loadu_si128((const __m128i *) (src + i));
+
+        // Fully transparent runs are common around the cursor shape
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, _mm_setzero_si128())) == 0xFFFF) {
+          continue;
+        }
+
+        auto d = _mm_loadu_si128((const __m128i *) (dst + i));
+        _mm_storeu_si128((__m128i *) (dst + i), blend_sse2(d, s));
+      }
+
+      cursor_compositor_t::blend_row_scalar(dst + i, src + i, count - i);
+    }
+
+    __attribute__((target("avx2"))) void blend_row_avx2(std::uint32_t *dst, const std::uint32_t *src, int count) {
+      const auto zero = _mm256_setzero_si256();
+      const auto v255 = _mm256_set1_epi16(255);
+      const auto v128 = _mm256_set1_epi16(128);
+
+      int i = 0;
+      for (; i + 8 <= count; i += 8) {
+        auto s = _mm256_loadu_si256((const __m256i *) (src + i));
+
+        if (_mm256_testz_si256(s, s)) {
+          continue;
+        }
+
+        auto d = _mm256_loadu_si256((const __m256i *) (dst + i));
+
+        auto s_lo = _mm256_unpacklo_epi8(s, zero);
+        auto s_hi = _mm256_unpackhi_epi8(s, zero);
+
+        auto inv_lo = _mm256_sub_epi16(v255, _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s_lo, 0xFF), 0xFF));
+        auto inv_hi = _mm256_sub_epi16(v255, _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s_hi, 0xFF), 0xFF));
+
+        auto t_lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), inv_lo), v128);
+        auto t_hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), inv_hi), v128);
+
+        t_lo = _mm256_srli_epi16(_mm256_add_epi16(t_lo, _mm256_srli_epi16(t_lo, 8)), 8);
+        t_hi = _mm256_srli_epi16(_mm256_add_epi16(t_hi, _mm256_srli_epi16(t_hi, 8)), 8);
+
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_adds_epu8(_mm256_packus_epi16(t_lo, t_hi), s));
+      }
+
+      blend_row_sse2(dst + i, src + i, count - i);
+    }
+#endif
+
+    using blend_row_fn = void (*)(std::uint32_t *, const std::uint32_t *, int);
+
+    blend_row_fn select_blend_row() {
+#ifdef SUNSHINE_CURSOR_X86
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2")) {
+        return blend_row_avx2;
+      }
+      if (__builtin_cpu_supports("sse2")) {
+        return blend_row_sse2;
+      }
+#endif
+      return cursor_compositor_t::blend_row_scalar;
+    }
+  }  // namespace
+
+  void cursor_compositor_t::blend_row_scalar(std::uint32_t *dst, const std::uint32_t *src, int count) {
+    for (int i = 0; i < count; ++i) {
+      auto s = src[i];
+      auto alpha = s >> 24;
+
+      if (alpha == 255) {
+        dst[i] = s;
+        continue;
+      }
+      if (s == 0) {
+        continue;
+      }
+
+      auto d = dst[i];
+      std::uint32_t out = 0;
+      for (int shift = 0; shift < 32; shift += 8) {
+        auto c = ((s >> shift) & 0xFF) + div255(((d >> shift) & 0xFF) * (255 - alpha));
+        out |= std::min<std::uint32_t>(c, 255) << shift;
+      }
+      dst[i] = out;
+    }
+  }
+
+  void cursor_compositor_t::blend_row(std::uint32_t *dst, const std::uint32_t *src, int count) {
+    static const auto fn = select_blend_row();
+    fn(dst, src, count);
+  }
+
+  bool cursor_compositor_t::needs_image(unsigned long serial) const {
+    return !has_image || this->serial != serial;
+  }
+
+  void cursor_compositor_t::set_image(unsigned long serial, int width, int height, const std::uint32_t *pixels, int row_pitch) {
+    this->pixels.resize(width * height);
+    for (int row = 0; row < height; ++row) {
+      std::memcpy(&this->pixels[row * width], &pixels[row * row_pitch], width * sizeof(std::uint32_t));
+    }
+
+    this->width = width;
+    this->height = height;
+    this->serial = serial;
+    has_image = true;
+  }
+
+  void cursor_compositor_t::set_image(unsigned long serial, int width, int height, const unsigned long *pixels) {
+    this->pixels.resize(width * height);
+    std::transform(pixels, pixels + width * height, this->pixels.begin(), [](unsigned long pixel) {
+      return (std::uint32_t) pixel;
+    });
+
+    this->width = width;
+    this->height = height;
+    this->serial = serial;
+    has_image = true;
+  }
+
+  void cursor_compositor_t::set_position(int x, int y) {
+    this->x = x;
+    this->y = y;
+  }
+
+  void cursor_compositor_t::set_visible(bool visible) {
+    this->visible = visible;
+  }
+
+  void cursor_compositor_t::blend(img_t &img, int offset_x, int offset_y) const {
+    if (!visible || !has_image || img.pixel_pitch != 4) {
+      return;
+    }
+
+    // Position of the cursor relative to the captured image, which may be partially off screen
+    auto cursor_x = x - offset_x;
+    auto cursor_y = y - offset_y;
+
+    auto src_x = std::max(0, -cursor_x);
+    auto src_y = std::max(0, -cursor_y);
+    auto dst_x = std::max(0, cursor_x);
+    auto dst_y = std::max(0, cursor_y);
+
+    auto blend_width = std::min(width - src_x, img.width - dst_x);
+    auto blend_height = std::min(height - src_y, img.height - dst_y);
+    if (blend_width <= 0 || blend_height <= 0) {
+      return;
+    }
+
+    for (int row = 0; row < blend_height; ++row) {
+      auto dst = (std::uint32_t *) (img.data + (dst_y + row) * img.row_pitch) + dst_x;
+      blend_row(dst, &pixels[(src_y + row) * width + src_x], blend_width);
+    }
+  }
+}  // namespace platf
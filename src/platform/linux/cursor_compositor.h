@@ -0,0 +1,83 @@
+/**
+ * @file src/platform/linux/cursor_compositor.h
+ * @brief Declarations for the software cursor compositor used by the RAM capture paths.
+ */
+#pragma once
+
+// standard includes
+#include <cstdint>
+#include <vector>
+
+// local includes
+#include "src/platform/common.h"
+
+namespace platf {
+  /**
+   * @brief Caches a premultiplied ARGB cursor bitmap and alpha-blends it into captured frames.
+   *
+   * The cursor image is only converted when its serial changes, so callers may report
+   * the position every frame and re-upload the bitmap only when the cursor shape changes.
+   * Blending uses AVX2 or SSE2 kernels when available, falling back to scalar code.
+   */
+  class cursor_compositor_t {
+  public:
+    /**
+     * @brief Check whether the cached bitmap is out of date.
+     * @param serial The serial of the cursor currently shown by the platform.
+     * @return `true` if `set_image()` must be called before blending.
+     */
+    bool needs_image(unsigned long serial) const;
+
+    /**
+     * @brief Replace the cached cursor bitmap.
+     * @param serial Serial identifying this cursor shape.
+     * @param width Width of the cursor in pixels.
+     * @param height Height of the cursor in pixels.
+     * @param pixels Premultiplied ARGB8888 pixels.
+     * @param row_pitch Distance in pixels between the start of two rows of `pixels`.
+     */
+    void set_image(unsigned long serial, int width, int height, const std::uint32_t *pixels, int row_pitch);
+
+    /**
+     * @brief Replace the cached cursor bitmap from 64-bit XFixes style pixels.
+     * @note Only the lower 32 bits of each element are used.
+     */
+    void set_image(unsigned long serial, int width, int height, const unsigned long *pixels);
+
+    /**
+     * @brief Update the position of the top left corner of the cursor image.
+     */
+    void set_position(int x, int y);
+
+    void set_visible(bool visible);
+
+    /**
+     * @brief Blend the cached cursor into the image.
+     * @param img The BGRA/BGRX destination image.
+     * @param offset_x Left edge of the captured area in the cursor coordinate space.
+     * @param offset_y Top edge of the captured area in the cursor coordinate space.
+     */
+    void blend(img_t &img, int offset_x, int offset_y) const;
+
+    /**
+     * @brief Blend one row of premultiplied source pixels over a destination row.
+     * @details Exposed for unit tests; `dst = src + dst * (255 - src.a) / 255` per channel.
+     */
+    static void blend_row(std::uint32_t *dst, const std::uint32_t *src, int count);
+
+    /**
+     * @brief Scalar reference implementation of `blend_row()`.
+     */
+    static void blend_row_scalar(std::uint32_t *dst, const std::uint32_t *src, int count);
+
+  private:
+    std::vector<std::uint32_t> pixels;
+    int width = 0;
+    int height = 0;
+    int x = 0;
+    int y = 0;
+    unsigned long serial = 0;
+    bool has_image = false;
+    bool visible = true;
+  };
+}  // namespace platf
@@ -0,0 +1,48 @@
+/**
+ * @file src/platform/linux/input/inputtino_batch.h
+ * @brief Declarations for applying coalesced input state to inputtino devices.
+ */
+#pragma once
+
+// standard includes
+#include <optional>
+
+// local includes
+#include "src/platform/common.h"
+
+namespace platf::gamepad {
+  /**
+   * @brief Apply a gamepad state, only touching the components that changed.
+   * @details Every inputtino setter writes its events followed by its own `SYN_REPORT`, so a
+   *          full state costs four syscalls even when a single axis moved. Skipping the
+   *          unchanged components turns a typical coalesced state into a single report.
+   * @param joypad The device, anything with the `inputtino::Joypad` setters.
+   * @param last The state last applied to the device, empty for a new device.
+   * @param state The new state.
+   * @return The number of reports written.
+   */
+  template<class Joypad>
+  int apply_state(Joypad &joypad, std::optional<gamepad_state_t> &last, const gamepad_state_t &state) {
+    int reports = 0;
+
+    if (!last || last->buttonFlags != state.buttonFlags) {
+      joypad.set_pressed_buttons(state.buttonFlags);
+      ++reports;
+    }
+    if (!last || last->lsX != state.lsX || last->lsY != state.lsY) {
+      joypad.set_stick(Joypad::LS, state.lsX, state.lsY);
+      ++reports;
+    }
+    if (!last || last->rsX != state.rsX || last->rsY != state.rsY) {
+      joypad.set_stick(Joypad::RS, state.rsX, state.rsY);
+      ++reports;
+    }
+    if (!last || last->lt != state.lt || last->rt != state.rt) {
+      joypad.set_triggers(state.lt, state.rt);
+      ++reports;
+    }
+
+    last = state;
+    return reports;
+  }
+}  // namespace platf::gamepad
@@ -4,6 +4,9 @@
  */
 #pragma once
 
+// standard includes
+#include <optional>
+
 // lib includes
 #include <boost/locale.hpp>
 #include <inputtino/input.hpp>
@@ -25,6 +28,9 @@ namespace platf {
     std::unique_ptr<joypads_t> joypad;
     gamepad_feedback_msg_t last_rumble;
     gamepad_feedback_msg_t last_rgb_led;
+
+    // Last state sent to the device, so unchanged buttons, sticks and triggers aren't written again
+    std::optional<gamepad_state_t> last_state;
   };
 
   struct input_raw_t {
@@ -8,6 +8,7 @@
 #include <libevdev/libevdev.h>
 
 // local includes
+#include "inputtino_batch.h"
 #include "inputtino_common.h"
 #include "inputtino_gamepad.h"
 #include "src/config.h"
@@ -191,11 +192,8 @@ namespace platf::gamepad {
       return;
     }
 
-    std::visit([gamepad_state](inputtino::Joypad &gc) {
-      gc.set_pressed_buttons(gamepad_state.buttonFlags);
-      gc.set_stick(inputtino::Joypad::LS, gamepad_state.lsX, gamepad_state.lsY);
-      gc.set_stick(inputtino::Joypad::RS, gamepad_state.rsX, gamepad_state.rsY);
-      gc.set_triggers(gamepad_state.lt, gamepad_state.rt);
+    std::visit([&gamepad, &gamepad_state](inputtino::Joypad &gc) {
+      apply_state(gc, gamepad->last_state, gamepad_state);
     },
                *gamepad->joypad);
   }
@@ -19,6 +19,7 @@
 
 // local includes
 #include "cuda.h"
+#include "cursor_compositor.h"
 #include "graphics.h"
 #include "src/config.h"
 #include "src/logging.h"
@@ -1221,49 +1222,12 @@ namespace platf {
       void blend_cursor(img_t &img) {
         // TODO: Cursor scaling is not supported in this codepath.
         // We always draw the cursor at the source size.
-        auto pixels = (int *) img.data;
-
-        int32_t screen_height = img.height;
-        int32_t screen_width = img.width;
-
-        // This is the position in the target that we will start drawing the cursor
-        auto cursor_x = std::max<int32_t>(0, captured_cursor.x - img_offset_x);
-        auto cursor_y = std::max<int32_t>(0, captured_cursor.y - img_offset_y);
-
-        // If the cursor is partially off screen, the coordinates may be negative
-        // which means we will draw the top-right visible portion of the cursor only.
-        auto cursor_delta_x = cursor_x - std::max<int32_t>(-captured_cursor.src_w, captured_cursor.x - img_offset_x);
-        auto cursor_delta_y = cursor_y - std::max<int32_t>(-captured_cursor.src_h, captured_cursor.y - img_offset_y);
-
-        auto delta_height = std::min<uint32_t>(captured_cursor.src_h, std::max<int32_t>(0, screen_height - cursor_y)) - cursor_delta_y;
-        auto delta_width = std::min<uint32_t>(captured_cursor.src_w, std::max<int32_t>(0, screen_width - cursor_x)) - cursor_delta_x;
-        for (auto y = 0; y < delta_height; ++y) {
-          // Offset into the cursor image to skip drawing the parts of the cursor image that are off screen
-          //
-          // NB: We must access the elements via the data() function because cursor_end may point to the
-          // the first element beyond the valid range of the vector. Using vector's [] operator in that
-          // manner is undefined behavior (and triggers errors when using debug libc++), while doing the
-          // same with an array is fine.
-          auto cursor_begin = (uint32_t *) &captured_cursor.pixels.data()[((y + cursor_delta_y) * captured_cursor.src_w + cursor_delta_x) * 4];
-          auto cursor_end = (uint32_t *) &captured_cursor.pixels.data()[((y + cursor_delta_y) * captured_cursor.src_w + delta_width + cursor_delta_x) * 4];
-
-          auto pixels_begin = &pixels[(y + cursor_y) * (img.row_pitch / img.pixel_pitch) + cursor_x];
-
-          std::for_each(cursor_begin, cursor_end, [&](uint32_t cursor_pixel) {
-            auto colors_in = (uint8_t *) pixels_begin;
-
-            auto alpha = (*(uint *) &cursor_pixel) >> 24u;
-            if (alpha == 255) {
-              *pixels_begin = cursor_pixel;
-            } else {
-              auto colors_out = (uint8_t *) &cursor_pixel;
-              colors_in[0] = colors_out[0] + (colors_in[0] * (255 - alpha) + 255 / 2) / 255;
-              colors_in[1] = colors_out[1] + (colors_in[1] * (255 - alpha) + 255 / 2) / 255;
-              colors_in[2] = colors_out[2] + (colors_in[2] * (255 - alpha) + 255 / 2) / 255;
-            }
-            ++pixels_begin;
-          });
+        if (compositor.needs_image(captured_cursor.serial)) {
+          compositor.set_image(captured_cursor.serial, captured_cursor.src_w, captured_cursor.src_h, (const std::uint32_t *) captured_cursor.pixels.data(), captured_cursor.src_w);
         }
+
+        compositor.set_position(captured_cursor.x, captured_cursor.y);
+        compositor.blend(img, img_offset_x, img_offset_y);
       }
 
       capture_e snapshot(const pull_free_image_cb_t &pull_free_image_cb, std::shared_ptr<platf::img_t> &img_out, std::chrono::milliseconds timeout, bool cursor) {
@@ -1326,6 +1290,8 @@ namespace platf {
       gbm::gbm_t gbm;
       egl::display_t display;
       egl::ctx_t ctx;
+
+      cursor_compositor_t compositor;
     };
 
     class display_vram_t: public display_t {
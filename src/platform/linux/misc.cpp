@@ -9,8 +9,10 @@
 #endif
 
 // standard includes
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 
 // platform includes
 #include <arpa/inet.h>
@@ -18,6 +20,7 @@
 #include <ifaddrs.h>
 #include <netinet/udp.h>
 #include <pwd.h>
+#include <sys/utsname.h>
 
 // lib includes
 #include <boost/asio/ip/address.hpp>
@@ -863,6 +866,48 @@ namespace platf {
     return true;
   }
 
+  std::string encoder_identity() {
+    auto read_line = [](const fs::path &path) {
+      std::string line;
+      std::ifstream file {path};
+      std::getline(file, line);
+      return line;
+    };
+
+    std::ostringstream identity;
+
+    // In-tree drivers are updated with the kernel
+    utsname name;
+    if (!uname(&name)) {
+      identity << name.release << ';';
+    }
+
+    std::vector<fs::path> render_nodes;
+    std::error_code ec;
+    for (auto &entry : fs::directory_iterator {"/sys/class/drm", ec}) {
+      if (entry.path().filename().string().starts_with("renderD"sv)) {
+        render_nodes.emplace_back(entry.path());
+      }
+    }
+    std::ranges::sort(render_nodes);
+
+    for (auto &node : render_nodes) {
+      auto device = node / "device";
+      identity << node.filename().string() << ':' << read_line(device / "vendor") << ':' << read_line(device / "device");
+
+      // Out-of-tree modules report their own version
+      auto driver = fs::read_symlink(device / "driver", ec).filename();
+      if (!ec) {
+        identity << ':' << driver.string() << ':' << read_line(fs::path {"/sys/module"} / driver / "version");
+      }
+      identity << ';';
+    }
+
+    identity << read_line("/proc/driver/nvidia/version");
+
+    return identity.str();
+  }
+
   std::shared_ptr<display_t> display(mem_type_e hwdevice_type, const std::string &display_name, const video::config_t &config) {
 #ifdef SUNSHINE_BUILD_CUDA
     if (sources[source::NVFBC] && hwdevice_type == mem_type_e::cuda) {
@@ -19,6 +19,7 @@
 
 // local includes
 #include "cuda.h"
+#include "cursor_compositor.h"
 #include "graphics.h"
 #include "misc.h"
 #include "src/config.h"
@@ -49,6 +50,9 @@ namespace platf {
     _FN(CloseDisplay, int, (Display * display));
     _FN(Free, int, (void *data));
     _FN(InitThreads, Status, (void) );
+    _FN(QueryPointer, Bool, (Display * display, Window w, Window *root_return, Window *child_return, int *root_x_return, int *root_y_return, int *win_x_return, int *win_y_return, unsigned int *mask_return));
+    _FN(Pending, int, (Display * display));
+    _FN(NextEvent, int, (Display * display, XEvent *event_return));
 
     namespace rr {
       _FN(GetScreenResources, XRRScreenResources *, (Display * dpy, Window window));
@@ -94,6 +98,8 @@ namespace platf {
 
     namespace fix {
       _FN(GetCursorImage, XFixesCursorImage *, (Display * dpy));
+      _FN(QueryExtension, Bool, (Display * dpy, int *event_base_return, int *error_base_return));
+      _FN(SelectCursorInput, void, (Display * dpy, Window win, unsigned long eventMask));
 
       static int init() {
         static void *handle {nullptr};
@@ -112,6 +118,8 @@ namespace platf {
 
         std::vector<std::tuple<dyn::apiproc *, const char *>> funcs {
           {(dyn::apiproc *) &GetCursorImage, "XFixesGetCursorImage"},
+          {(dyn::apiproc *) &QueryExtension, "XFixesQueryExtension"},
+          {(dyn::apiproc *) &SelectCursorInput, "XFixesSelectCursorInput"},
         };
 
         if (dyn::load(handle, funcs)) {
@@ -145,6 +153,9 @@ namespace platf {
         {(dyn::apiproc *) &Free, "XFree"},
         {(dyn::apiproc *) &CloseDisplay, "XCloseDisplay"},
         {(dyn::apiproc *) &InitThreads, "XInitThreads"},
+        {(dyn::apiproc *) &QueryPointer, "XQueryPointer"},
+        {(dyn::apiproc *) &Pending, "XPending"},
+        {(dyn::apiproc *) &NextEvent, "XNextEvent"},
       };
 
       if (dyn::load(handle, funcs)) {
@@ -321,46 +332,87 @@ namespace platf {
       return;
     }
 
-    overlay->x -= overlay->xhot;
-    overlay->y -= overlay->yhot;
+    cursor_compositor_t compositor;
+    compositor.set_image(overlay->cursor_serial, overlay->width, overlay->height, overlay->pixels);
+    compositor.set_position(overlay->x - overlay->xhot, overlay->y - overlay->yhot);
+    compositor.blend(img, offsetX, offsetY);
+  }
 
-    overlay->x -= offsetX;
-    overlay->y -= offsetY;
+  /**
+   * Keeps the X cursor cached between frames.
+   *
+   * The cursor image is only downloaded after XFixes reports a cursor change,
+   * otherwise the position is refreshed with a cheap XQueryPointer round trip.
+   */
+  class x11_cursor_t {
+  public:
+    void blend(Display *display, img_t &img, int offsetX, int offsetY) {
+      if (this->display != display) {
+        init(display);
+      }
 
-    overlay->x = std::max((short) 0, overlay->x);
-    overlay->y = std::max((short) 0, overlay->y);
+      // Drain cursor change notifications, they are the only events selected on this display
+      while (event_base >= 0 && x11::Pending(display)) {
+        XEvent event;
+        x11::NextEvent(display, &event);
+        if (event.type == event_base + XFixesCursorNotify) {
+          dirty = true;
+        }
+      }
 
-    auto pixels = (int *) img.data;
+      if (dirty) {
+        xcursor_t overlay {x11::fix::GetCursorImage(display)};
+        if (!overlay) {
+          BOOST_LOG(error) << "Couldn't get cursor from XFixesGetCursorImage"sv;
+          return;
+        }
 
-    auto screen_height = img.height;
-    auto screen_width = img.width;
+        if (compositor.needs_image(overlay->cursor_serial)) {
+          compositor.set_image(overlay->cursor_serial, overlay->width, overlay->height, overlay->pixels);
+        }
 
-    auto delta_height = std::min<uint16_t>(overlay->height, std::max(0, screen_height - overlay->y));
-    auto delta_width = std::min<uint16_t>(overlay->width, std::max(0, screen_width - overlay->x));
-    for (auto y = 0; y < delta_height; ++y) {
-      auto overlay_begin = &overlay->pixels[y * overlay->width];
-      auto overlay_end = &overlay->pixels[y * overlay->width + delta_width];
+        xhot = overlay->xhot;
+        yhot = overlay->yhot;
+        compositor.set_position(overlay->x - xhot, overlay->y - yhot);
 
-      auto pixels_begin = &pixels[(y + overlay->y) * (img.row_pitch / img.pixel_pitch) + overlay->x];
+        // Without cursor notifications we have to poll the image every frame
+        dirty = event_base < 0;
+      } else {
+        Window root_return, child_return;
+        int root_x, root_y, win_x, win_y;
+        unsigned int mask;
+        if (x11::QueryPointer(display, root, &root_return, &child_return, &root_x, &root_y, &win_x, &win_y, &mask)) {
+          compositor.set_position(root_x - xhot, root_y - yhot);
+        }
+      }
 
-      std::for_each(overlay_begin, overlay_end, [&](long pixel) {
-        int *pixel_p = (int *) &pixel;
+      compositor.blend(img, offsetX, offsetY);
+    }
 
-        auto colors_in = (uint8_t *) pixels_begin;
+  private:
+    void init(Display *display) {
+      this->display = display;
+      root = DefaultRootWindow(display);
+      dirty = true;
 
-        auto alpha = (*(uint *) pixel_p) >> 24u;
-        if (alpha == 255) {
-          *pixels_begin = *pixel_p;
-        } else {
-          auto colors_out = (uint8_t *) pixel_p;
-          colors_in[0] = colors_out[0] + (colors_in[0] * (255 - alpha) + 255 / 2) / 255;
-          colors_in[1] = colors_out[1] + (colors_in[1] * (255 - alpha) + 255 / 2) / 255;
-          colors_in[2] = colors_out[2] + (colors_in[2] * (255 - alpha) + 255 / 2) / 255;
-        }
-        ++pixels_begin;
-      });
+      int error_base;
+      if (x11::fix::QueryExtension(display, &event_base, &error_base)) {
+        x11::fix::SelectCursorInput(display, root, XFixesDisplayCursorNotifyMask);
+      } else {
+        BOOST_LOG(warning) << "XFixes cursor notifications unavailable, polling cursor image every frame"sv;
+        event_base = -1;
+      }
     }
-  }
+
+    Display *display {};
+    Window root {};
+    int event_base {-1};
+    bool dirty {true};
+    int xhot {};
+    int yhot {};
+
+    cursor_compositor_t compositor;
+  };
 
   struct x11_attr_t: public display_t {
     std::chrono::nanoseconds delay;
@@ -371,6 +423,8 @@ namespace platf {
 
     mem_type_e mem_type;
 
+    x11_cursor_t cursor_tracker;
+
     /**
      * Last X (NOT the streamed monitor!) size.
      * This way we can trigger reinitialization if the dimensions changed while streaming
@@ -526,7 +580,7 @@ namespace platf {
       img->img.reset(x_img);
 
       if (cursor) {
-        blend_cursor(xdisplay.get(), *img, offset_x, offset_y);
+        cursor_tracker.blend(xdisplay.get(), *img, offset_x, offset_y);
       }
 
       return capture_e::ok;
@@ -663,7 +717,7 @@ namespace platf {
         img_out->frame_timestamp = frame_timestamp;
 
         if (cursor) {
-          blend_cursor(shm_xdisplay.get(), *img_out, offset_x, offset_y);
+          cursor_tracker.blend(shm_xdisplay.get(), *img_out, offset_x, offset_y);
         }
 
         return capture_e::ok;
@@ -215,4 +215,9 @@ namespace platf {
     // We don't track GPU state, so we will always reenumerate. Fortunately, it is fast on macOS.
     return true;
   }
+
+  std::string encoder_identity() {
+    // GPU drivers are only updated along with the OS
+    return [[[NSProcessInfo processInfo] operatingSystemVersionString] UTF8String];
+  }
 }  // namespace platf
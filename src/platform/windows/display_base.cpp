@@ -4,6 +4,7 @@
  */
 // standard includes
 #include <cmath>
+#include <sstream>
 #include <thread>
 
 // platform includes
@@ -1100,4 +1101,32 @@ namespace platf {
       return false;
     }
   }
+
+  std::string encoder_identity() {
+    dxgi::factory1_t factory;
+    auto status = CreateDXGIFactory1(IID_IDXGIFactory1, (void **) &factory);
+    if (FAILED(status)) {
+      BOOST_LOG(error) << "Failed to create DXGIFactory1 [0x"sv << util::hex(status).to_string_view() << ']';
+      return {};
+    }
+
+    std::ostringstream identity;
+
+    dxgi::adapter_t adapter;
+    for (int x = 0; factory->EnumAdapters1(x, &adapter) != DXGI_ERROR_NOT_FOUND; ++x) {
+      DXGI_ADAPTER_DESC1 adapter_desc;
+      adapter->GetDesc1(&adapter_desc);
+
+      // The user mode driver version changes with every driver update
+      LARGE_INTEGER umd_version {};
+      adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &umd_version);
+
+      identity << util::hex(adapter_desc.VendorId).to_string_view() << ':'
+               << util::hex(adapter_desc.DeviceId).to_string_view() << ':'
+               << util::hex(adapter_desc.SubSysId).to_string_view() << ':'
+               << umd_version.QuadPart << ';';
+    }
+
+    return identity.str();
+  }
 }  // namespace platf
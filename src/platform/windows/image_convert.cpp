@@ -2,6 +2,8 @@
 
 #include "image_convert.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <wincodec.h>
 #include <Windows.h>
 #include <winrt/base.h>
@@ -22,33 +24,8 @@ namespace platf::img {
     }
   };
 
-  bool convert_to_png_96dpi(const std::wstring &src_path, const std::wstring &dst_path) {
-    CoInitGuard co;
-    winrt::com_ptr<IWICImagingFactory> factory;
-    if (FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(factory.put())))) {
-      return false;
-    }
-
-    winrt::com_ptr<IWICBitmapDecoder> decoder;
-    if (FAILED(factory->CreateDecoderFromFilename(src_path.c_str(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, decoder.put()))) {
-      return false;
-    }
-
-    winrt::com_ptr<IWICBitmapFrameDecode> frame;
-    if (FAILED(decoder->GetFrame(0, frame.put()))) {
-      return false;
-    }
-
-    // Convert to a well-supported pixel format if needed
-    GUID pf = GUID_WICPixelFormat32bppPBGRA;
-    winrt::com_ptr<IWICFormatConverter> converter;
-    if (FAILED(factory->CreateFormatConverter(converter.put()))) {
-      return false;
-    }
-    if (FAILED(converter->Initialize(frame.get(), pf, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom))) {
-      return false;
-    }
-
+  // Encode a bitmap as a 96 DPI PNG file
+  static bool write_png(IWICImagingFactory *factory, IWICBitmapSource *source, const std::wstring &dst_path) {
     // Create output stream and encoder
     winrt::com_ptr<IWICStream> stream;
     if (FAILED(factory->CreateStream(stream.put()))) {
@@ -81,7 +58,7 @@ namespace platf::img {
     }
 
     UINT w = 0, h = 0;
-    if (FAILED(converter->GetSize(&w, &h))) {
+    if (FAILED(source->GetSize(&w, &h))) {
       return false;
     }
     if (FAILED(fenc->SetSize(w, h))) {
@@ -96,7 +73,7 @@ namespace platf::img {
     const UINT stride = w * 4;
     const UINT bufSize = stride * h;
     std::unique_ptr<BYTE[]> buffer = std::make_unique<BYTE[]>(bufSize);
-    if (FAILED(converter->CopyPixels(nullptr, stride, bufSize, buffer.get()))) {
+    if (FAILED(source->CopyPixels(nullptr, stride, bufSize, buffer.get()))) {
       return false;
     }
     if (FAILED(fenc->WritePixels(h, stride, bufSize, buffer.get()))) {
@@ -110,4 +87,79 @@ namespace platf::img {
     }
     return true;
   }
+
+  // Decode the first frame of an image file as 32bpp PBGRA
+  static winrt::com_ptr<IWICFormatConverter> read_image(IWICImagingFactory *factory, const std::wstring &src_path) {
+    winrt::com_ptr<IWICBitmapDecoder> decoder;
+    if (FAILED(factory->CreateDecoderFromFilename(src_path.c_str(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, decoder.put()))) {
+      return nullptr;
+    }
+
+    winrt::com_ptr<IWICBitmapFrameDecode> frame;
+    if (FAILED(decoder->GetFrame(0, frame.put()))) {
+      return nullptr;
+    }
+
+    // Convert to a well-supported pixel format if needed
+    GUID pf = GUID_WICPixelFormat32bppPBGRA;
+    winrt::com_ptr<IWICFormatConverter> converter;
+    if (FAILED(factory->CreateFormatConverter(converter.put()))) {
+      return nullptr;
+    }
+    if (FAILED(converter->Initialize(frame.get(), pf, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom))) {
+      return nullptr;
+    }
+
+    return converter;
+  }
+
+  bool convert_to_png_96dpi(const std::wstring &src_path, const std::wstring &dst_path) {
+    CoInitGuard co;
+    winrt::com_ptr<IWICImagingFactory> factory;
+    if (FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(factory.put())))) {
+      return false;
+    }
+
+    auto converter = read_image(factory.get(), src_path);
+    if (!converter) {
+      return false;
+    }
+
+    return write_png(factory.get(), converter.get(), dst_path);
+  }
+
+  bool resize_to_png(const std::wstring &src_path, const std::wstring &dst_path, unsigned width) {
+    CoInitGuard co;
+    winrt::com_ptr<IWICImagingFactory> factory;
+    if (FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(factory.put())))) {
+      return false;
+    }
+
+    auto converter = read_image(factory.get(), src_path);
+    if (!converter) {
+      return false;
+    }
+
+    UINT w = 0, h = 0;
+    if (FAILED(converter->GetSize(&w, &h)) || !w || !h) {
+      return false;
+    }
+
+    // Only ever shrink, keeping the aspect ratio
+    if (width >= w) {
+      return write_png(factory.get(), converter.get(), dst_path);
+    }
+    UINT height = std::max<UINT>(1, (UINT) ((std::uint64_t) h * width / w));
+
+    winrt::com_ptr<IWICBitmapScaler> scaler;
+    if (FAILED(factory->CreateBitmapScaler(scaler.put()))) {
+      return false;
+    }
+    // Fant averages all source pixels, so downscaling by large factors doesn't alias
+    if (FAILED(scaler->Initialize(converter.get(), width, height, WICBitmapInterpolationModeFant))) {
+      return false;
+    }
+
+    return write_png(factory.get(), scaler.get(), dst_path);
+  }
 }  // namespace platf::img
@@ -7,4 +7,8 @@ namespace platf::img {
   // Convert source image to PNG at dst path. Preserves pixel dimensions and sets 96 DPI.
   // Returns true on success.
   bool convert_to_png_96dpi(const std::wstring &src_path, const std::wstring &dst_path);
+
+  // Convert source image to a PNG at dst path, scaled down to the given width while keeping the
+  // aspect ratio. Images that are already narrower keep their size. Returns true on success.
+  bool resize_to_png(const std::wstring &src_path, const std::wstring &dst_path, unsigned width);
 }  // namespace platf::img
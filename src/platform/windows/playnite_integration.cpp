@@ -8,6 +8,7 @@
 #endif
 #include "playnite_integration.h"
 
+#include "src/app_catalog.h"
 #include "src/confighttp.h"
 #include "src/config.h"
 #include "src/config_playnite.h"
@@ -366,13 +367,13 @@ namespace platf::playnite {
       using nlohmann::json;
       const std::string path = config::stream.file_apps;
       BOOST_LOG(info) << "Playnite sync: reading apps file '" << path << "'";
-      std::string content = file_handler::read_file(path.c_str());
-      BOOST_LOG(info) << "Playnite sync: apps file size=" << content.size() << " bytes";
-      json root = json::parse(content);
+      // Unchanged since the last sync or save, this reuses the parsed file
+      json root = *app_catalog::apps(path);
       if (!root.contains("apps") || !root["apps"].is_array()) {
         BOOST_LOG(warning) << "apps.json has no 'apps' array";
         return false;
       }
+      BOOST_LOG(info) << "Playnite sync: apps file has " << root["apps"].size() << " apps";
 
       // Build all games snapshot and reconcile with apps.json via helper
       std::vector<platf::playnite::Game> all;
@@ -17,13 +17,13 @@
 #include <boost/program_options/parsers.hpp>
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
-#include <openssl/evp.h>
-#include <openssl/sha.h>
 
 // local includes
+#include "app_catalog.h"
 #include "config.h"
 #include "crypto.h"
 #include "display_device.h"
+#include "events.h"
 #include "logging.h"
 #include "platform/common.h"
 #ifdef _WIN32
@@ -55,6 +55,7 @@ namespace proc {
       _app_id(other._app_id),
       _env(std::move(other._env)),
       _apps(std::move(other._apps)),
+      _apps_generation(other._apps_generation + 1),
       _app(std::move(other._app)),
       _app_launch_time(other._app_launch_time),
       placebo(other.placebo),
@@ -71,6 +72,7 @@ namespace proc {
       _app_id = other._app_id;
       _env = std::move(other._env);
       _apps = std::move(other._apps);
+      _apps_generation = std::max(_apps_generation, other._apps_generation) + 1;
       _app = std::move(other._app);
       _app_launch_time = other._app_launch_time;
       placebo = other.placebo;
@@ -361,6 +363,8 @@ namespace proc {
 
     fg.disable();
 
+    events::publish(events::event_e::app_launched);
+
     return 0;
   }
 
@@ -463,6 +467,10 @@ namespace proc {
     }
 
     _app_id = -1;
+
+    if (has_run) {
+      events::publish(events::event_e::app_exited);
+    }
   }
 
   std::vector<ctx_t> proc_t::get_apps() const {
@@ -470,6 +478,11 @@ namespace proc {
     return _apps;
   }
 
+  std::uint64_t proc_t::apps_generation() const {
+    std::scoped_lock lk(_apps_mutex);
+    return _apps_generation;
+  }
+
   // Gets application image from application list.
   // Returns image from assets directory if found there.
   // Returns default image if image configuration is not set.
@@ -610,41 +623,6 @@ namespace proc {
     return app_image_path;
   }
 
-  std::optional<std::string> calculate_sha256(const std::string &filename) {
-    crypto::md_ctx_t ctx {EVP_MD_CTX_create()};
-    if (!ctx) {
-      return std::nullopt;
-    }
-
-    if (!EVP_DigestInit_ex(ctx.get(), EVP_sha256(), nullptr)) {
-      return std::nullopt;
-    }
-
-    // Read file and update calculated SHA
-    char buf[1024 * 16];
-    std::ifstream file(filename, std::ifstream::binary);
-    while (file.good()) {
-      file.read(buf, sizeof(buf));
-      if (!EVP_DigestUpdate(ctx.get(), buf, file.gcount())) {
-        return std::nullopt;
-      }
-    }
-    file.close();
-
-    unsigned char result[SHA256_DIGEST_LENGTH];
-    if (!EVP_DigestFinal_ex(ctx.get(), result, nullptr)) {
-      return std::nullopt;
-    }
-
-    // Transform byte-array to string
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    for (const auto &byte : result) {
-      ss << std::setw(2) << (int) byte;
-    }
-    return ss.str();
-  }
-
   uint32_t calculate_crc32(const std::string &input) {
     boost::crc_32_type result;
     result.process_bytes(input.data(), input.length());
@@ -657,7 +635,8 @@ namespace proc {
     to_hash.push_back(app_name);
     auto file_path = validate_app_image_path(app_image_path);
     if (file_path != DEFAULT_APP_IMAGE_PATH) {
-      auto file_hash = calculate_sha256(file_path);
+      // Hashes are cached, large libraries would otherwise read every cover on each refresh
+      auto file_hash = app_catalog::file_sha256(file_path);
       if (file_hash) {
         to_hash.push_back(file_hash.value());
       } else {
@@ -810,6 +789,9 @@ namespace proc {
         apps.emplace_back(std::move(ctx));
       }
 
+      // Every app image was hashed above, the rest belong to removed apps
+      app_catalog::prune_hashes();
+
       return std::optional<proc::proc_t>(std::in_place, std::move(this_env), std::move(apps));
     } catch (std::exception &e) {
       BOOST_LOG(error) << e.what();
@@ -846,10 +828,13 @@ namespace proc {
       std::scoped_lock lk(_apps_mutex);
       _apps = std::move(apps);
       _env = std::move(env);
+      ++_apps_generation;
     }
   }
 
   std::vector<ctx_t> proc_t::release_apps() {
+    std::scoped_lock lk(_apps_mutex);
+    ++_apps_generation;
     return std::move(_apps);
   }
 
@@ -9,6 +9,7 @@
 #endif
 
 // standard includes
+#include <cstdint>
 #include <mutex>
 #include <optional>
 #include <unordered_map>
@@ -96,6 +97,12 @@ namespace proc {
 
     // Return a snapshot copy to avoid concurrent access races
     std::vector<ctx_t> get_apps() const;
+
+    /**
+     * @return A number that changes every time the app list is replaced.
+     */
+    std::uint64_t apps_generation() const;
+
     std::string get_app_image(int app_id);
     std::string get_last_run_app_name();
     void terminate();
@@ -112,6 +119,7 @@ namespace proc {
 
     boost::process::v1::environment _env;
     std::vector<ctx_t> _apps;
+    std::uint64_t _apps_generation {0};
     ctx_t _app;
     std::chrono::steady_clock::time_point _app_launch_time;
 
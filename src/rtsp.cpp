@@ -23,6 +23,7 @@ extern "C" {
 
 // local includes
 #include "config.h"
+#include "events.h"
 #include "globals.h"
 #include "input.h"
 #include "logging.h"
@@ -573,6 +574,7 @@ namespace rtsp_stream {
       for (auto &slot : to_cleanup) {
         stream::session::stop(*slot);
         stream::session::join(*slot);
+        events::publish(events::event_e::session_stopped);
       }
     }
 
@@ -1109,6 +1111,9 @@ namespace rtsp_stream {
       return;
     }
 
+    // Published once running, so every session_started is matched by the session_stopped of clear()
+    events::publish(events::event_e::session_started);
+
     respond(sock, session, &option, 200, "OK", req->sequenceNumber, {});
   }
 
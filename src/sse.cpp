@@ -0,0 +1,67 @@
+/**
+ * @file src/sse.cpp
+ * @brief Definitions for Server-Sent Events.
+ */
+// local includes
+#include "sse.h"
+
+namespace sse {
+  std::string event(std::string_view data, std::string_view type) {
+    std::string result;
+    result.reserve(data.size() + type.size() + 16);
+
+    if (!type.empty()) {
+      result.append("event: ").append(type).append("\n");
+    }
+
+    // Clients split fields on any of CRLF, CR and LF
+    while (true) {
+      auto pos = data.find_first_of("\r\n");
+      result.append("data: ").append(data.substr(0, pos)).append("\n");
+      if (pos == std::string_view::npos) {
+        break;
+      }
+
+      pos += data.substr(pos, 2) == "\r\n" ? 2 : 1;
+      data.remove_prefix(pos);
+    }
+    result += '\n';
+
+    return result;
+  }
+
+  std::string comment(std::string_view text) {
+    std::string result;
+    result.append(": ").append(text).append("\n\n");
+
+    return result;
+  }
+
+  void hub_t::subscribe(send_t send) {
+    std::lock_guard lg(_lock);
+    _clients.emplace_back(std::move(send));
+    _size = _clients.size();
+  }
+
+  void hub_t::publish(const std::string &chunk) {
+    if (empty()) {
+      return;
+    }
+
+    std::lock_guard lg(_lock);
+    std::erase_if(_clients, [&chunk](auto &send) {
+      return !send(chunk);
+    });
+    _size = _clients.size();
+  }
+
+  void hub_t::clear() {
+    std::lock_guard lg(_lock);
+    _clients.clear();
+    _size = 0;
+  }
+
+  bool hub_t::empty() const {
+    return _size == 0;
+  }
+}  // namespace sse
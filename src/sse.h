@@ -0,0 +1,72 @@
+/**
+ * @file src/sse.h
+ * @brief Declarations for Server-Sent Events.
+ */
+#pragma once
+
+// standard includes
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Pushes events to web clients over long-lived `text/event-stream` responses.
+ */
+namespace sse {
+  /**
+   * @brief Format a message as an event.
+   * @param data The payload, sent as one `data` field per line.
+   * @param type The event type, or empty for the default `message` type.
+   * @return The event, ready to be written to the response.
+   * @examples
+   * event("line 1\nline 2"sv, "log"sv);  // "event: log\ndata: line 1\ndata: line 2\n\n"
+   * @examples_end
+   */
+  std::string event(std::string_view data, std::string_view type = {});
+
+  /**
+   * @brief Format a comment, ignored by clients. Useful to keep an idle connection open.
+   */
+  std::string comment(std::string_view text);
+
+  /**
+   * @brief Sends the same events to every connected client.
+   */
+  class hub_t {
+  public:
+    /**
+     * @brief Queues a chunk on the connection of a client, without waiting for it to be sent.
+     * @return `false` once the client is gone or can't keep up, it is then dropped from the hub.
+     */
+    using send_t = std::function<bool(const std::string &chunk)>;
+
+    /**
+     * @brief Add a client.
+     */
+    void subscribe(send_t send);
+
+    /**
+     * @brief Send a chunk to every client.
+     * @details Clients receive chunks in the order they were published.
+     */
+    void publish(const std::string &chunk);
+
+    /**
+     * @brief Drop every client.
+     */
+    void clear();
+
+    /**
+     * @brief Check whether any client is connected, without locking.
+     */
+    bool empty() const;
+
+  private:
+    mutable std::mutex _lock;
+    std::vector<send_t> _clients;
+    std::atomic<std::size_t> _size {0};
+  };
+}  // namespace sse
@@ -2,6 +2,10 @@
  * @file src/stat_trackers.cpp
  * @brief Definitions for streaming statistic tracking.
  */
+// standard includes
+#include <algorithm>
+#include <bit>
+
 // local includes
 #include "stat_trackers.h"
 
@@ -15,4 +19,69 @@ namespace stat_trackers {
     return boost::format("%1$.2f");
   }
 
+  void latency_histogram::record(std::chrono::steady_clock::duration duration) {
+    auto us = (std::uint64_t) std::max<std::int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+
+    // Bucket x holds [2^(x-1), 2^x) microseconds, bucket 0 holds anything below 1 microsecond
+    auto bucket = std::min<std::size_t>(std::bit_width(us), BUCKETS - 1);
+
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    total_us.fetch_add(us, std::memory_order_relaxed);
+  }
+
+  std::uint64_t latency_histogram::count() const {
+    std::uint64_t count = 0;
+    for (auto &bucket : buckets) {
+      count += bucket.load(std::memory_order_relaxed);
+    }
+
+    return count;
+  }
+
+  std::chrono::microseconds latency_histogram::mean() const {
+    auto samples = count();
+    if (!samples) {
+      return {};
+    }
+
+    return std::chrono::microseconds(total_us.load(std::memory_order_relaxed) / samples);
+  }
+
+  std::chrono::microseconds latency_histogram::percentile(double p) const {
+    std::array<std::uint64_t, BUCKETS> counts;
+    std::uint64_t samples = 0;
+    for (std::size_t x = 0; x < BUCKETS; ++x) {
+      counts[x] = buckets[x].load(std::memory_order_relaxed);
+      samples += counts[x];
+    }
+
+    if (!samples) {
+      return {};
+    }
+
+    auto rank = std::clamp(p, 0.0, 100.0) / 100 * samples;
+    std::uint64_t seen = 0;
+    for (std::size_t x = 0; x < BUCKETS; ++x) {
+      if (!counts[x] || seen + counts[x] < rank) {
+        seen += counts[x];
+        continue;
+      }
+
+      double lower = x ? (double) (1ull << (x - 1)) : 0;
+      double upper = (double) (1ull << x);
+      auto fraction = (rank - seen) / counts[x];
+
+      return std::chrono::microseconds((std::int64_t) (lower + (upper - lower) * fraction));
+    }
+
+    return std::chrono::microseconds(1ll << (BUCKETS - 1));
+  }
+
+  void latency_histogram::reset() {
+    for (auto &bucket : buckets) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+    total_us.store(0, std::memory_order_relaxed);
+  }
+
 }  // namespace stat_trackers
@@ -5,7 +5,10 @@
 #pragma once
 
 // standard includes
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <limits>
 
@@ -50,4 +53,35 @@ namespace stat_trackers {
     } data;
   };
 
+  /**
+   * @brief Histogram of durations with power of two microsecond buckets.
+   * @details Recording is a few relaxed atomic increments, so latency sensitive threads can
+   *          record while another thread reads percentiles. Percentiles are interpolated
+   *          inside their bucket, so they are only accurate to the bucket's range.
+   */
+  class latency_histogram {
+  public:
+    // The last bucket collects everything from about 4 seconds up
+    static constexpr std::size_t BUCKETS = 24;
+
+    void record(std::chrono::steady_clock::duration duration);
+
+    std::uint64_t count() const;
+
+    std::chrono::microseconds mean() const;
+
+    /**
+     * @brief Estimate a percentile.
+     * @param p The percentile, between 0 and 100.
+     * @return The estimated duration, 0 if nothing was recorded.
+     */
+    std::chrono::microseconds percentile(double p) const;
+
+    void reset();
+
+  private:
+    std::array<std::atomic<std::uint64_t>, BUCKETS> buckets {};
+    std::atomic<std::uint64_t> total_us {0};
+  };
+
 }  // namespace stat_trackers
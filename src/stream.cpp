@@ -338,6 +338,9 @@ namespace stream {
     udp::socket audio_sock {io_context};
 
     control_server_t control_server;
+
+    // Origin of both the audio and the video RTP timestamps
+    std::chrono::steady_clock::time_point epoch;
   };
 
   struct session_t {
@@ -386,6 +389,11 @@ namespace stream {
 
       audio_fec_packet_t fec_packet;
       std::unique_ptr<platf::deinit_t> qos;
+
+      // Whether every packet of the current FEC block is precomputed silence
+      bool silent_fec_block;
+      std::uint64_t skipped_fec_blocks;
+      std::uint64_t skipped_fec_bytes;
     } audio;
 
     struct {
@@ -963,6 +971,7 @@ namespace stream {
     });
 
     server->map(packetTypes[IDX_INPUT_DATA], [&](session_t *session, const std::string_view &payload) {
+      auto received = std::chrono::steady_clock::now();
       BOOST_LOG(debug) << "type [IDX_INPUT_DATA]"sv;
 
       auto tagged_cipher_length = util::endian::big(*(int32_t *) payload.data());
@@ -985,10 +994,11 @@ namespace stream {
         std::copy(payload.end() - 16, payload.end(), std::begin(iv));
       }
 
-      input::passthrough(session->input, std::move(plaintext));
+      input::passthrough(session->input, std::move(plaintext), received);
     });
 
     server->map(packetTypes[IDX_ENCRYPTED], [server](session_t *session, const std::string_view &payload) {
+      auto received = std::chrono::steady_clock::now();
       BOOST_LOG(verbose) << "type [IDX_ENCRYPTED]"sv;
 
       auto header = (control_encrypted_p) (payload.data() - 2);
@@ -1048,7 +1058,7 @@ namespace stream {
       // IDX_INPUT_DATA callback will attempt to decrypt unencrypted data, therefore we need pass it directly
       if (type == packetTypes[IDX_INPUT_DATA]) {
         plaintext.erase(std::begin(plaintext), std::begin(plaintext) + 4);
-        input::passthrough(session->input, std::move(plaintext));
+        input::passthrough(session->input, std::move(plaintext), received);
       } else {
         server->call(type, session, next_payload, true);
       }
@@ -1260,10 +1270,9 @@ namespace stream {
     }
   }
 
-  void videoBroadcastThread(udp::socket &sock) {
+  void videoBroadcastThread(udp::socket &sock, std::chrono::steady_clock::time_point epoch) {
     auto shutdown_event = mail::man->event<bool>(mail::broadcast_shutdown);
     auto packets = mail::man->queue<video::packet_t>(mail::video_packets);
-    auto video_epoch = std::chrono::steady_clock::now();
 
     // Video traffic is sent on this thread
     platf::adjust_thread_priority(platf::thread_priority_e::high);
@@ -1467,7 +1476,7 @@ namespace stream {
             frame_is_dupe = true;
           }
           using rtp_tick = std::chrono::duration<uint32_t, std::ratio<1, 90000>>;
-          uint32_t timestamp = std::chrono::round<rtp_tick>(*packet->frame_timestamp - video_epoch).count();
+          uint32_t timestamp = std::chrono::round<rtp_tick>(*packet->frame_timestamp - epoch).count();
 
           // set FEC info now that we know for sure what our percentage will be for this frame
           for (auto x = 0; x < shards.size(); ++x) {
@@ -1584,7 +1593,7 @@ namespace stream {
     shutdown_event->raise(true);
   }
 
-  void audioBroadcastThread(udp::socket &sock) {
+  void audioBroadcastThread(udp::socket &sock, std::chrono::steady_clock::time_point epoch) {
     auto shutdown_event = mail::man->event<bool>(mail::broadcast_shutdown);
     auto packets = mail::man->queue<audio::packet_t>(mail::audio_packets);
 
@@ -1616,6 +1625,13 @@ namespace stream {
       auto session = (session_t *) channel_data;
 
       auto sequenceNumber = session->audio.sequenceNumber;
+
+      // Start the audio timeline where the first packet was captured on the video timeline.
+      // From then on it advances by one packet duration per packet, which the capture side
+      // keeps locked to the host clock.
+      if (sequenceNumber == 0 && packet_data.timestamp() > epoch) {
+        session->audio.timestamp = std::chrono::floor<std::chrono::milliseconds>(packet_data.timestamp() - epoch).count();
+      }
       auto timestamp = session->audio.timestamp;
 
       *(std::uint32_t *) iv.data() = util::endian::big<std::uint32_t>(session->audio.avRiKeyId + sequenceNumber);
@@ -1655,10 +1671,16 @@ namespace stream {
         if (sequenceNumber % RTPA_DATA_SHARDS == 0) {
           fec_packet.fecHeader.baseSequenceNumber = util::endian::big(sequenceNumber);
           fec_packet.fecHeader.baseTimestamp = util::endian::big(timestamp);
+          session->audio.silent_fec_block = true;
         }
-
-        // generate parity shards at the end of the FEC block
-        if ((sequenceNumber + 1) % RTPA_DATA_SHARDS == 0) {
+        session->audio.silent_fec_block = session->audio.silent_fec_block && packet_data.silent();
+
+        if ((sequenceNumber + 1) % RTPA_DATA_SHARDS == 0 && session->audio.silent_fec_block) {
+          // Parity shards are optional, recovering lost silence isn't worth sending them
+          ++session->audio.skipped_fec_blocks;
+          session->audio.skipped_fec_bytes += RTPA_FEC_SHARDS * (sizeof(fec_packet) + bytes);
+        } else if ((sequenceNumber + 1) % RTPA_DATA_SHARDS == 0) {
+          // generate parity shards at the end of the FEC block
           reed_solomon_encode(rs.get(), shards_p.begin(), RTPA_TOTAL_SHARDS, bytes);
 
           for (auto x = 0; x < RTPA_FEC_SHARDS; ++x) {
@@ -1739,8 +1761,10 @@ namespace stream {
 
     ctx.message_queue_queue = std::make_shared<message_queue_queue_t::element_type>(30);
 
-    ctx.video_thread = std::thread {videoBroadcastThread, std::ref(ctx.video_sock)};
-    ctx.audio_thread = std::thread {audioBroadcastThread, std::ref(ctx.audio_sock)};
+    ctx.epoch = std::chrono::steady_clock::now();
+
+    ctx.video_thread = std::thread {videoBroadcastThread, std::ref(ctx.video_sock), ctx.epoch};
+    ctx.audio_thread = std::thread {audioBroadcastThread, std::ref(ctx.audio_sock), ctx.epoch};
     ctx.control_thread = std::thread {controlBroadcastThread, &ctx.control_server};
 
     ctx.recv_thread = std::thread {recvThread, std::ref(ctx)};
@@ -1914,6 +1938,10 @@ namespace stream {
       session.videoThread.join();
       BOOST_LOG(debug) << "Waiting for audio to end..."sv;
       session.audioThread.join();
+      if (session.audio.skipped_fec_blocks) {
+        BOOST_LOG(info) << "Skipped "sv << session.audio.skipped_fec_blocks << " audio FEC blocks holding silence, saving "sv
+                        << session.audio.skipped_fec_bytes / 1024 << " KiB"sv;
+      }
       BOOST_LOG(debug) << "Waiting for control to end..."sv;
       session.controlEnd.view();
       // Reset input on session stop to avoid stuck repeated keys
@@ -2050,6 +2078,9 @@ namespace stream {
       session->audio.avRiKeyId = util::endian::big(*(std::uint32_t *) launch_session.iv.data());
       session->audio.sequenceNumber = 0;
       session->audio.timestamp = 0;
+      session->audio.silent_fec_block = false;
+      session->audio.skipped_fec_blocks = 0;
+      session->audio.skipped_fec_bytes = 0;
 
       session->control.peer = nullptr;
       session->state.store(state_e::STOPPED, std::memory_order_relaxed);
@@ -5,13 +5,17 @@
 #pragma once
 
 // standard includes
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <deque>
 #include <functional>
 #include <future>
 #include <mutex>
 #include <optional>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -64,57 +68,65 @@ namespace task_pool_util {
     };
 
   protected:
+    struct timer_t {
+      __time_point time_point;
+
+      // Keeps tasks due at the same time in the order they were pushed
+      std::uint64_t seq;
+
+      __task task;
+    };
+
     std::deque<__task> _tasks;
-    std::vector<std::pair<__time_point, __task>> _timer_tasks;
+
+    // 4-ary min-heap, the next timer to expire is at the front
+    std::vector<timer_t> _timer_tasks;
+
+    // Position of every timer in the heap, for cancelling and delaying without a scan
+    std::unordered_map<task_id_t, std::size_t> _timer_index;
+
+    std::uint64_t _timer_seq = 0;
     std::mutex _task_mutex;
 
+    // Expiry of the timer at the front of the heap, read without locking by pop_expired()
+    std::atomic<__time_point> _next_timer {__time_point::max()};
+
   public:
     TaskPool() = default;
 
     TaskPool(TaskPool &&other) noexcept:
         _tasks {std::move(other._tasks)},
-        _timer_tasks {std::move(other._timer_tasks)} {
+        _timer_tasks {std::move(other._timer_tasks)},
+        _timer_index {std::move(other._timer_index)},
+        _timer_seq {other._timer_seq},
+        _next_timer {other._next_timer.load()} {
     }
 
     TaskPool &operator=(TaskPool &&other) noexcept {
       std::swap(_tasks, other._tasks);
       std::swap(_timer_tasks, other._timer_tasks);
+      std::swap(_timer_index, other._timer_index);
+      std::swap(_timer_seq, other._timer_seq);
+      _next_timer = other._next_timer.exchange(_next_timer);
 
       return *this;
     }
 
     template<class Function, class... Args>
     auto push(Function &&newTask, Args &&...args) {
-      static_assert(std::is_invocable_v<Function, Args &&...>, "arguments don't match the function");
-
-      using __return = std::invoke_result_t<Function, Args &&...>;
-      using task_t = std::packaged_task<__return()>;
+      auto [task, future] = makeTask(std::forward<Function>(newTask), std::forward<Args>(args)...);
 
-      auto bind = [task = std::forward<Function>(newTask), tuple_args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
-        return std::apply(task, std::move(tuple_args));
-      };
+      pushTask(std::move(task));
 
-      task_t task(std::move(bind));
-
-      auto future = task.get_future();
-
-      std::lock_guard<std::mutex> lg(_task_mutex);
-      _tasks.emplace_back(toRunnable(std::move(task)));
-
-      return future;
+      return std::move(future);
     }
 
     void pushDelayed(std::pair<__time_point, __task> &&task) {
       std::lock_guard lg(_task_mutex);
 
-      auto it = _timer_tasks.cbegin();
-      for (; it < _timer_tasks.cend(); ++it) {
-        if (std::get<0>(*it) < task.first) {
-          break;
-        }
-      }
-
-      _timer_tasks.emplace(it, task.first, std::move(task.second));
+      _timer_index[task.second.get()] = _timer_tasks.size();
+      _timer_tasks.push_back(timer_t {task.first, _timer_seq++, std::move(task.second)});
+      sift_up(_timer_tasks.size() - 1);
     }
 
     /**
@@ -158,62 +170,47 @@ namespace task_pool_util {
     void delay(task_id_t task_id, std::chrono::duration<X, Y> duration) {
       std::lock_guard<std::mutex> lg(_task_mutex);
 
-      auto it = _timer_tasks.begin();
-      for (; it < _timer_tasks.cend(); ++it) {
-        const __task &task = std::get<1>(*it);
-
-        if (&*task == task_id) {
-          std::get<0>(*it) = std::chrono::steady_clock::now() + duration;
-
-          break;
-        }
-      }
-
-      if (it == _timer_tasks.cend()) {
+      auto it = _timer_index.find(task_id);
+      if (it == std::end(_timer_index)) {
         return;
       }
 
-      // smaller time goes to the back
-      auto prev = it - 1;
-      while (it > _timer_tasks.cbegin()) {
-        if (std::get<0>(*it) > std::get<0>(*prev)) {
-          std::swap(*it, *prev);
-        }
+      auto pos = it->second;
+      auto &timer = _timer_tasks[pos];
+      auto previous = timer.time_point;
+      timer.time_point = std::chrono::steady_clock::now() + duration;
+      timer.seq = _timer_seq++;
 
-        --prev;
-        --it;
+      if (timer.time_point < previous) {
+        sift_up(pos);
+      } else {
+        sift_down(pos);
       }
     }
 
     bool cancel(task_id_t task_id) {
       std::lock_guard lg(_task_mutex);
 
-      auto it = _timer_tasks.begin();
-      for (; it < _timer_tasks.cend(); ++it) {
-        const __task &task = std::get<1>(*it);
-
-        if (&*task == task_id) {
-          _timer_tasks.erase(it);
-
-          return true;
-        }
+      auto it = _timer_index.find(task_id);
+      if (it == std::end(_timer_index)) {
+        return false;
       }
 
-      return false;
+      remove_timer(it->second);
+
+      return true;
     }
 
     std::optional<std::pair<__time_point, __task>> pop(task_id_t task_id) {
       std::lock_guard lg(_task_mutex);
 
-      auto pos = std::find_if(std::begin(_timer_tasks), std::end(_timer_tasks), [&task_id](const auto &t) {
-        return t.second.get() == task_id;
-      });
-
-      if (pos == std::end(_timer_tasks)) {
+      auto it = _timer_index.find(task_id);
+      if (it == std::end(_timer_index)) {
         return std::nullopt;
       }
 
-      return std::move(*pos);
+      auto timer = remove_timer(it->second);
+      return std::pair {timer.time_point, std::move(timer.task)};
     }
 
     std::optional<__task> pop() {
@@ -225,10 +222,26 @@ namespace task_pool_util {
         return task;
       }
 
-      if (!_timer_tasks.empty() && std::get<0>(_timer_tasks.back()) <= std::chrono::steady_clock::now()) {
-        __task task = std::move(std::get<1>(_timer_tasks.back()));
-        _timer_tasks.pop_back();
-        return task;
+      if (!_timer_tasks.empty() && _timer_tasks.front().time_point <= std::chrono::steady_clock::now()) {
+        return remove_timer(0).task;
+      }
+
+      return std::nullopt;
+    }
+
+    /**
+     * @brief Take the first timer if it expired, ignoring the tasks queued by push().
+     * @details Only locks when a timer may have expired, so it can be checked before every task.
+     */
+    std::optional<__task> pop_expired() {
+      auto now = std::chrono::steady_clock::now();
+      if (_next_timer.load(std::memory_order_acquire) > now) {
+        return std::nullopt;
+      }
+
+      std::lock_guard lg(_task_mutex);
+      if (!_timer_tasks.empty() && _timer_tasks.front().time_point <= now) {
+        return remove_timer(0).task;
       }
 
       return std::nullopt;
@@ -237,7 +250,7 @@ namespace task_pool_util {
     bool ready() {
       std::lock_guard<std::mutex> lg(_task_mutex);
 
-      return !_tasks.empty() || (!_timer_tasks.empty() && std::get<0>(_timer_tasks.back()) <= std::chrono::steady_clock::now());
+      return !_tasks.empty() || (!_timer_tasks.empty() && _timer_tasks.front().time_point <= std::chrono::steady_clock::now());
     }
 
     std::optional<__time_point> next() {
@@ -247,13 +260,139 @@ namespace task_pool_util {
         return std::nullopt;
       }
 
-      return std::get<0>(_timer_tasks.back());
+      return _timer_tasks.front().time_point;
     }
 
-  private:
+  protected:
     template<class Function>
-    std::unique_ptr<_ImplBase> toRunnable(Function &&f) {
+    static std::unique_ptr<_ImplBase> toRunnable(Function &&f) {
       return std::make_unique<_Impl<Function>>(std::forward<Function &&>(f));
     }
+
+    /**
+     * @return The task and a future for its result.
+     */
+    template<class Function, class... Args>
+    static auto makeTask(Function &&newTask, Args &&...args) {
+      static_assert(std::is_invocable_v<Function, Args &&...>, "arguments don't match the function");
+
+      using __return = std::invoke_result_t<Function, Args &&...>;
+      using task_t = std::packaged_task<__return()>;
+
+      auto bind = [task = std::forward<Function>(newTask), tuple_args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+        return std::apply(task, std::move(tuple_args));
+      };
+
+      task_t task(std::move(bind));
+
+      auto future = task.get_future();
+      return std::pair {toRunnable(std::move(task)), std::move(future)};
+    }
+
+    /**
+     * @return A task without a future, for callers that don't need the result.
+     */
+    template<class Function, class... Args>
+    static __task makeDetachedTask(Function &&newTask, Args &&...args) {
+      static_assert(std::is_invocable_v<Function, Args &&...>, "arguments don't match the function");
+
+      return toRunnable([task = std::forward<Function>(newTask), tuple_args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+        std::apply(task, std::move(tuple_args));
+      });
+    }
+
+    void pushTask(__task &&task) {
+      std::lock_guard<std::mutex> lg(_task_mutex);
+      _tasks.emplace_back(std::move(task));
+    }
+
+  private:
+
+    static bool earlier(const timer_t &lhs, const timer_t &rhs) {
+      return lhs.time_point < rhs.time_point || (lhs.time_point == rhs.time_point && lhs.seq < rhs.seq);
+    }
+
+    void place(std::size_t pos, timer_t &&timer) {
+      if (pos == 0) {
+        _next_timer.store(timer.time_point, std::memory_order_release);
+      }
+
+      _timer_index[timer.task.get()] = pos;
+      _timer_tasks[pos] = std::move(timer);
+    }
+
+    void sift_up(std::size_t pos) {
+      auto timer = std::move(_timer_tasks[pos]);
+
+      while (pos > 0) {
+        auto parent = (pos - 1) / 4;
+        if (!earlier(timer, _timer_tasks[parent])) {
+          break;
+        }
+
+        place(pos, std::move(_timer_tasks[parent]));
+        pos = parent;
+      }
+
+      place(pos, std::move(timer));
+    }
+
+    void sift_down(std::size_t pos) {
+      auto timer = std::move(_timer_tasks[pos]);
+
+      while (true) {
+        auto first_child = pos * 4 + 1;
+        if (first_child >= _timer_tasks.size()) {
+          break;
+        }
+
+        auto last_child = std::min(first_child + 4, _timer_tasks.size());
+        auto child = first_child;
+        for (auto x = first_child + 1; x < last_child; ++x) {
+          if (earlier(_timer_tasks[x], _timer_tasks[child])) {
+            child = x;
+          }
+        }
+
+        if (!earlier(_timer_tasks[child], timer)) {
+          break;
+        }
+
+        place(pos, std::move(_timer_tasks[child]));
+        pos = child;
+      }
+
+      place(pos, std::move(timer));
+    }
+
+    /**
+     * @brief Take a timer out of the heap.
+     * @param pos The position of the timer in the heap.
+     * @return The removed timer.
+     */
+    timer_t remove_timer(std::size_t pos) {
+      auto timer = std::move(_timer_tasks[pos]);
+      _timer_index.erase(timer.task.get());
+
+      auto last = std::move(_timer_tasks.back());
+      _timer_tasks.pop_back();
+
+      if (_timer_tasks.empty()) {
+        _next_timer.store(__time_point::max(), std::memory_order_release);
+      }
+
+      if (pos < _timer_tasks.size()) {
+        auto moved_earlier = earlier(last, timer);
+        place(pos, std::move(last));
+
+        if (moved_earlier) {
+          sift_up(pos);
+        } else {
+          sift_down(pos);
+        }
+      }
+
+      return timer;
+    }
   };
 }  // namespace task_pool_util
@@ -5,26 +5,109 @@
 #pragma once
 
 // standard includes
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
 #include <thread>
 
 // local includes
 #include "task_pool.h"
 
 namespace thread_pool_util {
+  /**
+   * @brief Bounded Chase-Lev work-stealing deque of tasks.
+   * @details Only the owning thread may push, at the bottom. Any thread, the owner included,
+   *          steals the oldest task from the top, so tasks run in the order they were pushed.
+   *          None of them lock.
+   */
+  class work_deque_t {
+  public:
+    static constexpr std::int64_t CAPACITY = 1024;
+
+    /**
+     * @brief Called by the owner to add a task.
+     * @return `false` if the deque is full.
+     */
+    bool push(task_pool_util::_ImplBase *task) {
+      auto bottom = _bottom.load(std::memory_order_relaxed);
+      auto top = _top.load(std::memory_order_acquire);
+      if (bottom - top >= CAPACITY) {
+        return false;
+      }
+
+      _tasks[bottom & (CAPACITY - 1)].store(task, std::memory_order_relaxed);
+      _bottom.store(bottom + 1, std::memory_order_release);
+
+      return true;
+    }
+
+    /**
+     * @brief Called by any thread to get the oldest task.
+     * @return The task, or `nullptr` if the deque is empty or another thread won the race.
+     */
+    task_pool_util::_ImplBase *steal() {
+      auto top = _top.load(std::memory_order_seq_cst);
+      auto bottom = _bottom.load(std::memory_order_seq_cst);
+
+      if (top >= bottom) {
+        return nullptr;
+      }
+
+      auto task = _tasks[top & (CAPACITY - 1)].load(std::memory_order_relaxed);
+      if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;
+      }
+
+      return task;
+    }
+
+    bool empty() const {
+      return _top.load(std::memory_order_acquire) >= _bottom.load(std::memory_order_acquire);
+    }
+
+  private:
+    alignas(64) std::atomic<std::int64_t> _top {0};
+    alignas(64) std::atomic<std::int64_t> _bottom {0};
+    std::array<std::atomic<task_pool_util::_ImplBase *>, CAPACITY> _tasks {};
+  };
+
   /**
    * Allow threads to execute unhindered while keeping full control over the threads.
+   *
+   * Every worker owns a work-stealing deque. Tasks pushed from a worker go to its own deque,
+   * tasks pushed from other threads go to the shared queue. Idle workers steal from each
+   * other before going to sleep, so a burst of work fans out without contending on one lock.
+   * Expired timers are run before any queued task.
    */
   class ThreadPool: public task_pool_util::TaskPool {
   public:
     typedef TaskPool::__task __task;
 
   private:
+    struct worker_t {
+      ThreadPool *pool;
+      work_deque_t deque;
+
+      // Tasks pushed from other threads with an affinity hint for this worker
+      std::mutex inbox_lock;
+      std::deque<__task> inbox;
+      std::atomic<std::size_t> inbox_size {0};
+    };
+
     std::vector<std::thread> _thread;
+    std::vector<std::unique_ptr<worker_t>> _workers;
 
     std::condition_variable _cv;
     std::mutex _lock;
 
-    bool _continue;
+    // Workers about to wait on _cv, producers only take _lock when someone is sleeping
+    std::atomic<int> _sleepers {0};
+
+    std::atomic_bool _continue;
+
+    static inline thread_local worker_t *_current_worker = nullptr;
 
   public:
     ThreadPool():
@@ -32,54 +115,87 @@ namespace thread_pool_util {
     }
 
     explicit ThreadPool(int threads):
-        _thread(threads),
-        _continue {true} {
-      for (auto &t : _thread) {
-        t = std::thread(&ThreadPool::_main, this);
-      }
+        _continue {false} {
+      start(threads);
     }
 
     ~ThreadPool() noexcept {
-      if (!_continue) {
-        return;
+      if (_continue) {
+        stop();
+        join();
       }
 
-      stop();
-      join();
+      // Tasks that never got the chance to run
+      for (auto &worker : _workers) {
+        while (auto task = worker->deque.steal()) {
+          delete task;
+        }
+      }
     }
 
+    /**
+     * @return A future for the result of the task.
+     */
     template<class Function, class... Args>
     auto push(Function &&newTask, Args &&...args) {
-      std::lock_guard lg(_lock);
-      auto future = TaskPool::push(std::forward<Function>(newTask), std::forward<Args>(args)...);
+      auto [task, future] = makeTask(std::forward<Function>(newTask), std::forward<Args>(args)...);
 
-      _cv.notify_one();
-      return future;
+      submit(std::move(task), std::nullopt);
+      return std::move(future);
+    }
+
+    /**
+     * @brief Like push(), preferably running on the given worker so it finds its data in cache.
+     * @param worker Any number, tasks with the same hint run on the same worker unless it is busy.
+     */
+    template<class Function, class... Args>
+    auto pushAffine(std::size_t worker, Function &&newTask, Args &&...args) {
+      auto [task, future] = makeTask(std::forward<Function>(newTask), std::forward<Args>(args)...);
+
+      submit(std::move(task), worker);
+      return std::move(future);
+    }
+
+    /**
+     * @brief Like push(), without the cost of a future.
+     */
+    template<class Function, class... Args>
+    void post(Function &&newTask, Args &&...args) {
+      submit(makeDetachedTask(std::forward<Function>(newTask), std::forward<Args>(args)...), std::nullopt);
     }
 
     void pushDelayed(std::pair<__time_point, __task> &&task) {
       std::lock_guard lg(_lock);
+      auto previous = next();
 
       TaskPool::pushDelayed(std::move(task));
+      notify_if_earlier(previous);
     }
 
     template<class Function, class X, class Y, class... Args>
     auto pushDelayed(Function &&newTask, std::chrono::duration<X, Y> duration, Args &&...args) {
       std::lock_guard lg(_lock);
-      auto future = TaskPool::pushDelayed(std::forward<Function>(newTask), duration, std::forward<Args>(args)...);
+      auto previous = next();
 
-      // Update all timers for wait_until
-      _cv.notify_all();
+      auto future = TaskPool::pushDelayed(std::forward<Function>(newTask), duration, std::forward<Args>(args)...);
+      notify_if_earlier(previous);
       return future;
     }
 
     void start(int threads) {
       _continue = true;
 
-      _thread.resize(threads);
+      _workers.resize(threads);
+      for (auto &worker : _workers) {
+        if (!worker) {
+          worker = std::make_unique<worker_t>();
+          worker->pool = this;
+        }
+      }
 
-      for (auto &t : _thread) {
-        t = std::thread(&ThreadPool::_main, this);
+      _thread.resize(threads);
+      for (int x = 0; x < threads; ++x) {
+        _thread[x] = std::thread(&ThreadPool::_main, this, _workers[x].get());
       }
     }
 
@@ -96,20 +212,136 @@ namespace thread_pool_util {
       }
     }
 
+    std::size_t workers() const {
+      return _workers.size();
+    }
+
+  private:
+    /**
+     * @brief Wake a thread to update its wait_until if a new timer expires first.
+     * @param previous The first timer to expire before the new one was pushed.
+     */
+    void notify_if_earlier(std::optional<__time_point> previous) {
+      // Re-arming timers that expire later, like key repeat, doesn't disturb the sleeping threads
+      if (!previous || next() < previous) {
+        _cv.notify_one();
+      }
+    }
+
+    void submit(__task &&task, std::optional<std::size_t> hint) {
+      if (hint && !_workers.empty()) {
+        auto &worker = *_workers[*hint % _workers.size()];
+
+        std::lock_guard lg(worker.inbox_lock);
+        worker.inbox.emplace_back(std::move(task));
+        worker.inbox_size.fetch_add(1, std::memory_order_release);
+      } else if (_current_worker && _current_worker->pool == this && _current_worker->deque.push(task.get())) {
+        task.release();
+      } else {
+        pushTask(std::move(task));
+      }
+
+      // Pairs with the fence in _main, either the sleeper sees the task or we see the sleeper
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (_sleepers.load(std::memory_order_relaxed)) {
+        std::lock_guard lg(_lock);
+
+        // Affinity hints are best effort, all workers can take from any inbox
+        _cv.notify_one();
+      }
+    }
+
+    static std::optional<__task> pop_inbox(worker_t &worker) {
+      if (!worker.inbox_size.load(std::memory_order_acquire)) {
+        return std::nullopt;
+      }
+
+      std::lock_guard lg(worker.inbox_lock);
+      if (worker.inbox.empty()) {
+        return std::nullopt;
+      }
+
+      auto task = std::move(worker.inbox.front());
+      worker.inbox.pop_front();
+      worker.inbox_size.fetch_sub(1, std::memory_order_relaxed);
+
+      return task;
+    }
+
+    /**
+     * @brief Find the next task for a worker: expired timers, its own deque and inbox,
+     *        the shared queue, then the other workers.
+     */
+    std::optional<__task> find_task(worker_t &self, std::size_t &victim) {
+      // A steady stream of posted tasks must not hold back timers like key repeat
+      if (auto task = this->pop_expired()) {
+        return task;
+      }
+
+      // Oldest first, tasks posted by a task run in the order they were posted
+      if (auto task = self.deque.steal()) {
+        return __task {task};
+      }
+
+      if (auto task = pop_inbox(self)) {
+        return task;
+      }
+
+      if (auto task = this->pop()) {
+        return task;
+      }
+
+      // Start stealing where the last successful steal happened
+      for (std::size_t x = 0; x < _workers.size(); ++x) {
+        auto &other = *_workers[(victim + x) % _workers.size()];
+        if (&other == &self) {
+          continue;
+        }
+
+        auto task = other.deque.steal();
+        if (!task) {
+          if (auto inbox_task = pop_inbox(other)) {
+            victim = (victim + x) % _workers.size();
+            return inbox_task;
+          }
+
+          continue;
+        }
+
+        victim = (victim + x) % _workers.size();
+        return __task {task};
+      }
+
+      return std::nullopt;
+    }
+
+    bool has_work() {
+      for (auto &worker : _workers) {
+        if (!worker->deque.empty() || worker->inbox_size.load(std::memory_order_acquire)) {
+          return true;
+        }
+      }
+
+      return ready();
+    }
+
   public:
-    void _main() {
+    void _main(worker_t *self) {
+      _current_worker = self;
+      std::size_t victim = 0;
+
       while (_continue) {
-        if (auto task = this->pop()) {
+        if (auto task = find_task(*self, victim)) {
           (*task)->run();
         } else {
           std::unique_lock uniq_lock(_lock);
 
-          if (ready()) {
-            continue;
-          }
+          _sleepers.fetch_add(1, std::memory_order_relaxed);
+          std::atomic_thread_fence(std::memory_order_seq_cst);
 
-          if (!_continue) {
-            break;
+          if (has_work() || !_continue) {
+            _sleepers.fetch_sub(1, std::memory_order_relaxed);
+            continue;
           }
 
           if (auto tp = next()) {
@@ -117,13 +349,17 @@ namespace thread_pool_util {
           } else {
             _cv.wait(uniq_lock);
           }
+
+          _sleepers.fetch_sub(1, std::memory_order_relaxed);
         }
       }
 
       // Execute remaining tasks
-      while (auto task = this->pop()) {
+      while (auto task = find_task(*self, victim)) {
         (*task)->run();
       }
+
+      _current_worker = nullptr;
     }
   };
 }  // namespace thread_pool_util
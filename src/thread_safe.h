@@ -8,6 +8,8 @@
 #include <array>
 #include <atomic>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <map>
 #include <mutex>
@@ -346,6 +348,182 @@ namespace safe {
     std::vector<T> _queue;
   };
 
+  /**
+   * @brief Bounded single producer, single consumer queue of preallocated slots.
+   * @details Neither side ever blocks or allocates. The producer fills the slot returned by
+   *          `back()` and publishes it with `push()`. The consumer may look at and modify every
+   *          published slot through `peek()` until it hands the oldest one back with `pop()`.
+   */
+  template<class T>
+  class spsc_queue_t {
+  public:
+    explicit spsc_queue_t(std::size_t capacity):
+        _slots(capacity + 1) {
+    }
+
+    /**
+     * @brief Get the slot to fill with the next element.
+     * @return The slot, or `nullptr` if the queue is full.
+     */
+    T *back() {
+      auto tail = _tail.load(std::memory_order_relaxed);
+      if ((tail + 1) % _slots.size() == _head.load(std::memory_order_acquire)) {
+        return nullptr;
+      }
+
+      return &_slots[tail];
+    }
+
+    /**
+     * @brief Publish the slot returned by `back()`.
+     */
+    void push() {
+      auto tail = _tail.load(std::memory_order_relaxed);
+      _tail.store((tail + 1) % _slots.size(), std::memory_order_release);
+    }
+
+    /**
+     * @brief Get a published element.
+     * @param x The position of the element, 0 being the oldest.
+     * @return The element, or `nullptr` if fewer elements were published.
+     */
+    T *peek(std::size_t x = 0) {
+      auto head = _head.load(std::memory_order_relaxed);
+      auto size = (_tail.load(std::memory_order_acquire) + _slots.size() - head) % _slots.size();
+      if (x >= size) {
+        return nullptr;
+      }
+
+      return &_slots[(head + x) % _slots.size()];
+    }
+
+    /**
+     * @brief Hand the oldest element back to the producer.
+     */
+    void pop() {
+      auto head = _head.load(std::memory_order_relaxed);
+      _head.store((head + 1) % _slots.size(), std::memory_order_release);
+    }
+
+  private:
+    std::vector<T> _slots;
+
+    alignas(64) std::atomic<std::size_t> _head {0};
+    alignas(64) std::atomic<std::size_t> _tail {0};
+  };
+
+  /**
+   * @brief Single producer, single consumer queue that never drops an element.
+   * @details Elements go to the preallocated slots of a `spsc_queue_t` like it. When they are all
+   *          taken, elements spill to a locked list until the consumer has caught up. The consumer
+   *          sees a single queue in the order elements were pushed, slots or not.
+   */
+  template<class T>
+  class spsc_spill_queue_t {
+  public:
+    explicit spsc_spill_queue_t(std::size_t capacity):
+        _slots {capacity} {
+    }
+
+    /**
+     * @brief Get the element to fill next, a free slot if one is left.
+     * @return The element to fill, never `nullptr`.
+     */
+    T *back() {
+      // Once elements spill, the following ones spill too until the consumer has taken them
+      if (!_spilled.load(std::memory_order_acquire)) {
+        if (auto slot = _slots.back()) {
+          _back = slot;
+          return &slot->value;
+        }
+      }
+
+      _back = &_spill_back;
+      return &_spill_back.value;
+    }
+
+    /**
+     * @brief Publish the element returned by `back()`.
+     */
+    void push() {
+      _back->seq = _next_seq++;
+
+      if (_back != &_spill_back) {
+        _slots.push();
+        return;
+      }
+
+      std::lock_guard lg {_spill_lock};
+      _spill.emplace_back(std::move(_spill_back));
+      _spilled.fetch_add(1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Get a published element.
+     * @param x The position of the element, 0 being the oldest.
+     * @return The element, or `nullptr` if fewer elements were published.
+     */
+    T *peek(std::size_t x = 0) {
+      if (!_spilled.load(std::memory_order_acquire)) {
+        auto slot = _slots.peek(x);
+        return slot ? &slot->value : nullptr;
+      }
+
+      // The slots and the spilled elements are each in order, merge them.
+      // Elements of the list don't move when the producer appends to it.
+      std::lock_guard lg {_spill_lock};
+      for (std::size_t slot_x = 0, spill_x = 0;;) {
+        auto slot = _slots.peek(slot_x);
+        auto spilled = spill_x < _spill.size() ? &_spill[spill_x] : nullptr;
+
+        auto next = slot && (!spilled || slot->seq < spilled->seq) ? slot : spilled;
+        if (!next) {
+          return nullptr;
+        }
+        if (!x--) {
+          return &next->value;
+        }
+
+        ++(next == slot ? slot_x : spill_x);
+      }
+    }
+
+    /**
+     * @brief Remove the oldest element.
+     */
+    void pop() {
+      if (_spilled.load(std::memory_order_acquire)) {
+        std::lock_guard lg {_spill_lock};
+
+        auto slot = _slots.peek();
+        if (!_spill.empty() && (!slot || _spill.front().seq < slot->seq)) {
+          _spill.pop_front();
+          _spilled.fetch_sub(1, std::memory_order_release);
+          return;
+        }
+      }
+
+      _slots.pop();
+    }
+
+  private:
+    struct entry_t {
+      std::uint64_t seq;
+      T value;
+    };
+
+    spsc_queue_t<entry_t> _slots;
+
+    // Producer only
+    entry_t *_back {nullptr};
+    entry_t _spill_back {};
+    std::uint64_t _next_seq {0};
+
+    std::mutex _spill_lock;
+    std::deque<entry_t> _spill;
+    std::atomic<std::size_t> _spilled {0};
+  };
+
   template<class T>
   class shared_t {
   public:
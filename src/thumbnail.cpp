@@ -0,0 +1,207 @@
+/**
+ * @file src/thumbnail.cpp
+ * @brief Definitions for the scaled down variants of app covers.
+ */
+// standard includes
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+// local includes
+#include "logging.h"
+#include "platform/common.h"
+#include "thread_pool.h"
+#include "thumbnail.h"
+
+#ifdef _WIN32
+  #include "platform/windows/image_convert.h"
+#endif
+
+using namespace std::literals;
+
+namespace thumbnail {
+  namespace fs = std::filesystem;
+
+  namespace {
+#ifdef _WIN32
+    constexpr bool can_resize = true;
+#else
+    // There is no image codec outside of WIC, clients get the original
+    constexpr bool can_resize = false;
+#endif
+
+    std::mutex lock;
+
+    // Variants queued for generation
+    std::unordered_set<std::string> pending;
+
+    // Images that couldn't be scaled, by modification time, so they aren't retried on every request
+    std::unordered_map<std::string, fs::file_time_type> failed;
+
+    bool resize(const fs::path &image, const fs::path &variant, std::uint32_t width) {
+#ifdef _WIN32
+      return platf::img::resize_to_png(image.wstring(), variant.wstring(), width);
+#else
+      return false;
+#endif
+    }
+
+    /**
+     * @brief Decodes and scales images at low priority.
+     * @details Decoding large covers takes a while, it doesn't hold up the timers of the global task_pool.
+     */
+    thread_pool_util::ThreadPool &worker() {
+      static auto &pool = []() -> thread_pool_util::ThreadPool & {
+        static thread_pool_util::ThreadPool pool {1};
+        pool.post([]() {
+          platf::adjust_thread_priority(platf::thread_priority_e::low);
+        });
+
+        return pool;
+      }();
+
+      return pool;
+    }
+
+    /**
+     * @brief Scale an image down to one of its variants.
+     * @param mtime Modification time of the image, given to the variant to tell whether it is current.
+     */
+    void generate(const fs::path &image, std::uint32_t width, fs::file_time_type mtime) {
+      auto variant = variant_path(image, width);
+      auto tmp = fs::path {variant}.concat(".tmp");
+
+      std::error_code ec;
+      bool ok = resize(image, tmp, width);
+      if (ok) {
+        fs::last_write_time(tmp, mtime, ec);
+        if (!ec) {
+          fs::rename(tmp, variant, ec);
+        }
+        ok = !ec;
+      }
+
+      if (!ok) {
+        fs::remove(tmp, ec);
+        BOOST_LOG(debug) << "Couldn't generate "sv << width << "px cover for ["sv << image.string() << ']';
+      }
+
+      std::lock_guard lg(lock);
+      pending.erase(variant.string());
+      if (!ok) {
+        failed[image.string()] = mtime;
+      }
+    }
+
+    void schedule(const fs::path &image, std::uint32_t width, fs::file_time_type mtime) {
+      auto key = variant_path(image, width).string();
+
+      {
+        std::lock_guard lg(lock);
+
+        auto it = failed.find(image.string());
+        if (it != std::end(failed) && it->second == mtime) {
+          return;
+        }
+
+        if (!pending.emplace(key).second) {
+          return;
+        }
+      }
+
+      worker().post(generate, image, width, mtime);
+    }
+  }  // namespace
+
+  std::optional<std::pair<std::uint32_t, std::uint32_t>> png_size(const fs::path &path) {
+    static const unsigned char signature[] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+
+    // Signature, IHDR chunk length and type, then the big endian width and height
+    unsigned char header[24];
+    std::ifstream in(path, std::ios::binary);
+    if (!in.read((char *) header, sizeof(header)) ||
+        !std::equal(std::begin(signature), std::end(signature), header) ||
+        std::string_view {(char *) header + 12, 4} != "IHDR"sv) {
+      return std::nullopt;
+    }
+
+    auto be32 = [](const unsigned char *p) {
+      return (std::uint32_t) p[0] << 24 | (std::uint32_t) p[1] << 16 | (std::uint32_t) p[2] << 8 | p[3];
+    };
+
+    return std::make_pair(be32(header + 16), be32(header + 20));
+  }
+
+  std::uint32_t pick_width(std::optional<std::uint32_t> hint) {
+    if (!hint) {
+      return DEFAULT_WIDTH;
+    }
+
+    for (auto width : WIDTHS) {
+      if (width >= *hint) {
+        return width;
+      }
+    }
+
+    return 0;
+  }
+
+  fs::path variant_path(const fs::path &image, std::uint32_t width) {
+    auto variant = image;
+    variant.replace_filename(image.stem().string() + ".thumb" + std::to_string(width) + ".png");
+
+    return variant;
+  }
+
+  fs::path select(const fs::path &image, std::optional<std::uint32_t> hint) {
+    auto width = pick_width(hint);
+    if (!can_resize || !width) {
+      return image;
+    }
+
+    // Small images, like the default covers, are served as they are
+    auto size = png_size(image);
+    if (!size || size->first <= width) {
+      return image;
+    }
+
+    std::error_code ec;
+    auto mtime = fs::last_write_time(image, ec);
+    if (ec) {
+      return image;
+    }
+
+    auto variant = variant_path(image, width);
+    auto variant_mtime = fs::last_write_time(variant, ec);
+    if (!ec && variant_mtime == mtime) {
+      return variant;
+    }
+
+    schedule(image, width, mtime);
+    return image;
+  }
+
+  void refresh(const fs::path &image) {
+    if (!can_resize) {
+      return;
+    }
+
+    auto size = png_size(image);
+
+    std::error_code ec;
+    auto mtime = fs::last_write_time(image, ec);
+    if (!size || ec) {
+      return;
+    }
+
+    for (auto width : WIDTHS) {
+      if (size->first > width) {
+        schedule(image, width, mtime);
+      }
+    }
+  }
+}  // namespace thumbnail
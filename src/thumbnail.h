@@ -0,0 +1,57 @@
+/**
+ * @file src/thumbnail.h
+ * @brief Declarations for the scaled down variants of app covers.
+ */
+#pragma once
+
+// standard includes
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <utility>
+
+namespace thumbnail {
+  /**
+   * @brief Widths of the generated variants, half and full size of the box art Moonlight renders.
+   */
+  constexpr std::array<std::uint32_t, 2> WIDTHS {314, 628};
+
+  /**
+   * @brief Width served to clients that don't ask for one, which is all of them today.
+   */
+  constexpr std::uint32_t DEFAULT_WIDTH = 628;
+
+  /**
+   * @brief Read the dimensions of a PNG file from its header.
+   * @return Width and height, or `std::nullopt` if the file isn't a PNG.
+   */
+  std::optional<std::pair<std::uint32_t, std::uint32_t>> png_size(const std::filesystem::path &path);
+
+  /**
+   * @brief Choose the variant for a size hint.
+   * @param hint The width the client renders the cover at, if it said.
+   * @return The smallest variant at least as wide as the hint, or 0 for the original.
+   */
+  std::uint32_t pick_width(std::optional<std::uint32_t> hint);
+
+  /**
+   * @brief Where the variant of an image is stored, next to the image.
+   */
+  std::filesystem::path variant_path(const std::filesystem::path &image, std::uint32_t width);
+
+  /**
+   * @brief Find the file to serve for an image.
+   * @details If the variant is missing or older than the image, it is generated in the background
+   *          and the original is served meanwhile.
+   * @param image The full size PNG.
+   * @param hint The width the client renders the cover at, if it said.
+   * @return The path of the variant if it is up to date, otherwise `image`.
+   */
+  std::filesystem::path select(const std::filesystem::path &image, std::optional<std::uint32_t> hint);
+
+  /**
+   * @brief Generate all variants of an image in the background, e.g. after it was uploaded.
+   */
+  void refresh(const std::filesystem::path &image);
+}  // namespace thumbnail
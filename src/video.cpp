@@ -3,9 +3,15 @@
  * @brief Definitions for video.
  */
 // standard includes
+#include <array>
 #include <atomic>
 #include <bitset>
-#include <list>
+#include <condition_variable>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
 #include <thread>
 
 // lib includes
@@ -22,12 +28,15 @@ extern "C" {
 #include "cbs.h"
 #include "config.h"
 #include "display_device.h"
+#include "encoder_probe_cache.h"
 #include "globals.h"
+#include "image_pool.h"
 #include "input.h"
 #include "logging.h"
 #include "nvenc/nvenc_base.h"
 #include "platform/common.h"
 #include "sync.h"
+#include "thread_pool.h"
 #include "video.h"
 
 #ifdef _WIN32
@@ -126,15 +135,40 @@ namespace video {
   class avcodec_software_encode_device_t: public platf::avcodec_encode_device_t {
   public:
     int convert(platf::img_t &img) override {
+      if (convert_into(img, sw_frame.get())) {
+        return -1;
+      }
+
+      // If frame is not a software frame, it means we still need to transfer from main memory
+      // to vram memory
+      if (frame->hw_frames_ctx) {
+        auto status = av_hwframe_transfer_data(frame, sw_frame.get(), 0);
+        if (status < 0) {
+          char string[AV_ERROR_MAX_STRING_SIZE];
+          BOOST_LOG(error) << "Failed to transfer image data to hardware frame: "sv << av_make_error_string(string, AV_ERROR_MAX_STRING_SIZE, status);
+          return -1;
+        }
+      }
+
+      return 0;
+    }
+
+    /**
+     * @brief Color convert and scale an image into a software frame.
+     * @param img The captured image.
+     * @param target A writable frame with the same format and size as `sw_frame`.
+     * @return 0 on success, -1 on failure.
+     */
+    int convert_into(platf::img_t &img, AVFrame *target) {
       // If we need to add aspect ratio padding, we need to scale into an intermediate output buffer
-      bool requires_padding = (sw_frame->width != sws_output_frame->width || sw_frame->height != sws_output_frame->height);
+      bool requires_padding = (target->width != sws_output_frame->width || target->height != sws_output_frame->height);
 
       // Setup the input frame using the caller's img_t
       sws_input_frame->data[0] = img.data;
       sws_input_frame->linesize[0] = img.row_pitch;
 
       // Perform color conversion and scaling to the final size
-      auto status = sws_scale_frame(sws.get(), requires_padding ? sws_output_frame.get() : sw_frame.get(), sws_input_frame.get());
+      auto status = sws_scale_frame(sws.get(), requires_padding ? sws_output_frame.get() : target, sws_input_frame.get());
       if (status < 0) {
         char string[AV_ERROR_MAX_STRING_SIZE];
         BOOST_LOG(error) << "Couldn't scale frame: "sv << av_make_error_string(string, AV_ERROR_MAX_STRING_SIZE, status);
@@ -148,27 +182,41 @@ namespace video {
         for (int plane = 0; plane < planes; plane++) {
           auto shift_h = plane == 0 ? 0 : fmt_desc->log2_chroma_h;
           auto shift_w = plane == 0 ? 0 : fmt_desc->log2_chroma_w;
-          auto offset = ((offsetW >> shift_w) * fmt_desc->comp[plane].step) + (offsetH >> shift_h) * sw_frame->linesize[plane];
+          auto offset = ((offsetW >> shift_w) * fmt_desc->comp[plane].step) + (offsetH >> shift_h) * target->linesize[plane];
 
           // Copy line-by-line to preserve leading padding for each row
           for (int line = 0; line < sws_output_frame->height >> shift_h; line++) {
-            memcpy(sw_frame->data[plane] + offset + (line * sw_frame->linesize[plane]), sws_output_frame->data[plane] + (line * sws_output_frame->linesize[plane]), (size_t) (sws_output_frame->width >> shift_w) * fmt_desc->comp[plane].step);
+            memcpy(target->data[plane] + offset + (line * target->linesize[plane]), sws_output_frame->data[plane] + (line * sws_output_frame->linesize[plane]), (size_t) (sws_output_frame->width >> shift_w) * fmt_desc->comp[plane].step);
           }
         }
       }
 
-      // If frame is not a software frame, it means we still need to transfer from main memory
-      // to vram memory
-      if (frame->hw_frames_ctx) {
-        auto status = av_hwframe_transfer_data(frame, sw_frame.get(), 0);
-        if (status < 0) {
-          char string[AV_ERROR_MAX_STRING_SIZE];
-          BOOST_LOG(error) << "Failed to transfer image data to hardware frame: "sv << av_make_error_string(string, AV_ERROR_MAX_STRING_SIZE, status);
-          return -1;
-        }
+      return 0;
+    }
+
+    /**
+     * @brief Allocate another software frame with the same format, size and properties as `sw_frame`.
+     * @details Aspect ratio padding is filled with black, like `prefill()` does for `sw_frame`.
+     */
+    avcodec_frame_t make_output_frame() {
+      avcodec_frame_t output {av_frame_alloc()};
+      if (!output) {
+        return nullptr;
       }
 
-      return 0;
+      output->format = sw_frame->format;
+      output->width = sw_frame->width;
+      output->height = sw_frame->height;
+
+      // Carries over color properties and HDR metadata
+      if (av_frame_copy_props(output.get(), sw_frame.get()) < 0 || av_frame_get_buffer(output.get(), 0) < 0) {
+        return nullptr;
+      }
+
+      ptrdiff_t linesize[4] = {output->linesize[0], output->linesize[1], output->linesize[2], output->linesize[3]};
+      av_image_fill_black(output->data, linesize, (AVPixelFormat) output->format, output->color_range, output->width, output->height);
+
+      return output;
     }
 
     int set_frame(AVFrame *frame, AVBufferRef *hw_frames_ctx) override {
@@ -441,6 +489,9 @@ namespace video {
   struct sync_session_t {
     sync_session_ctx_t *ctx;
     std::unique_ptr<encode_session_t> session;
+
+    // Convert + encode time of this session, excluding time spent waiting on other sessions
+    std::unique_ptr<logging::time_delta_periodic_logger> encode_latency_logger;
   };
 
   using encode_session_ctx_queue_t = safe::queue_t<sync_session_ctx_t>;
@@ -1041,7 +1092,16 @@ namespace video {
     &software
   };
 
+  // Held while probing an encoder, streams only take it to register themselves
+  static std::mutex encoder_probe_mutex;
+  // Number of running streams, guarded by encoder_probe_mutex
+  static int active_streams = 0;
+  // Signaled when a stream ends
+  static std::condition_variable_any streams_ended;
+
   static encoder_t *chosen_encoder;
+  // Set when the chosen encoder was picked from cached probe results that turned out to be outdated
+  static bool chosen_encoder_outdated = false;
   int active_hevc_mode;
   int active_av1_mode;
   bool last_encoder_probe_supported_ref_frames_invalidation = false;
@@ -1156,97 +1216,30 @@ namespace video {
     display_wp = disp;
 
     constexpr auto capture_buffer_size = 12;
-    std::list<std::shared_ptr<platf::img_t>> imgs(capture_buffer_size);
-
-    std::vector<std::optional<std::chrono::steady_clock::time_point>> imgs_used_timestamps;
-    const std::chrono::seconds trim_timeot = 3s;
-    auto trim_imgs = [&]() {
-      // count allocated and used within current pool
-      size_t allocated_count = 0;
-      size_t used_count = 0;
-      for (const auto &img : imgs) {
-        if (img) {
-          allocated_count += 1;
-          if (img.use_count() > 1) {
-            used_count += 1;
-          }
-        }
-      }
-
-      // remember the timestamp of currently used count
-      const auto now = std::chrono::steady_clock::now();
-      if (imgs_used_timestamps.size() <= used_count) {
-        imgs_used_timestamps.resize(used_count + 1);
-      }
-      imgs_used_timestamps[used_count] = now;
+    auto image_pool = image_pool_t::make(capture_buffer_size, [&disp]() {
+      return disp->alloc_img();
+    });
 
-      // decide whether to trim allocated unused above the currently used count
-      // based on last used timestamp and universal timeout
-      size_t trim_target = used_count;
-      for (size_t i = used_count; i < imgs_used_timestamps.size(); i++) {
-        if (imgs_used_timestamps[i] && now - *imgs_used_timestamps[i] < trim_timeot) {
-          trim_target = i;
-        }
-      }
+    logging::time_delta_periodic_logger pool_wait_logger {debug, "Capture: image pool wait"};
 
-      // trim allocated unused above the newly decided trim target
-      if (allocated_count > trim_target) {
-        size_t to_trim = allocated_count - trim_target;
-        // prioritize trimming least recently used
-        for (auto it = imgs.rbegin(); it != imgs.rend(); it++) {
-          auto &img = *it;
-          if (img && img.use_count() == 1) {
-            img.reset();
-            to_trim -= 1;
-            if (to_trim == 0) {
-              break;
-            }
-          }
-        }
-        // forget timestamps that no longer relevant
-        imgs_used_timestamps.resize(trim_target + 1);
+    // Capture waiting on the encoders to hand images back means frames were captured late
+    auto image_pool_stats_fg = util::fail_guard([&image_pool]() {
+      if (auto stalls = image_pool->stall_count()) {
+        BOOST_LOG(info) << "Capture waited "sv << std::chrono::duration_cast<std::chrono::milliseconds>(image_pool->total_wait()).count()
+                        << "ms in total for the encoders to return an image, "sv << stalls << " times"sv;
       }
-    };
+    });
 
     auto pull_free_image_callback = [&](std::shared_ptr<platf::img_t> &img_out) -> bool {
+      pool_wait_logger.first_point_now();
+
       img_out.reset();
       while (capture_ctx_queue->running()) {
-        // pick first allocated but unused
-        for (auto it = imgs.begin(); it != imgs.end(); it++) {
-          if (*it && it->use_count() == 1) {
-            img_out = *it;
-            if (it != imgs.begin()) {
-              // move image to the front of the list to prioritize its reusal
-              imgs.erase(it);
-              imgs.push_front(img_out);
-            }
-            break;
-          }
-        }
-        // otherwise pick first unallocated
-        if (!img_out) {
-          for (auto it = imgs.begin(); it != imgs.end(); it++) {
-            if (!*it) {
-              // allocate image
-              *it = disp->alloc_img();
-              img_out = *it;
-              if (it != imgs.begin()) {
-                // move image to the front of the list to prioritize its reusal
-                imgs.erase(it);
-                imgs.push_front(img_out);
-              }
-              break;
-            }
-          }
-        }
+        // Blocks until an encoder returns an image, periodically checking whether capture should stop
+        img_out = image_pool->acquire(100ms);
         if (img_out) {
-          // trim allocated but unused portion of the pool based on timeouts
-          trim_imgs();
-          img_out->frame_timestamp.reset();
+          pool_wait_logger.second_point_now_and_log();
           return true;
-        } else {
-          // sleep and retry if image pool is full
-          std::this_thread::sleep_for(1ms);
         }
       }
       return false;
@@ -1303,9 +1296,7 @@ namespace video {
             reinit_event.raise(true);
 
             // Some classes of images contain references to the display --> display won't delete unless img is deleted
-            for (auto &img : imgs) {
-              img.reset();
-            }
+            image_pool->clear();
 
             // display_wp is modified in this thread only
             // Wait for the other shared_ptr's of display to be destroyed.
@@ -1868,6 +1859,219 @@ namespace video {
     return nullptr;
   }
 
+  /**
+   * @brief Overlaps software color conversion with encoding.
+   * @details A helper thread converts the latest captured image into a small ring of frames
+   *          while the encoding thread is busy with the previous one. The encoding thread always
+   *          switches to the most recently converted frame, so frame numbers are still assigned
+   *          in order by the caller, and IDR requests made on the current frame carry over.
+   */
+  class convert_pipeline_t {
+  public:
+    /**
+     * @brief Start pipelined conversion for a session.
+     * @return The pipeline, or `nullptr` if the session doesn't use software conversion into a software frame.
+     */
+    static std::unique_ptr<convert_pipeline_t> make(encode_session_t &session, img_event_t images) {
+      auto avcodec_session = dynamic_cast<avcodec_encode_session_t *>(&session);
+      if (!avcodec_session) {
+        return nullptr;
+      }
+
+      // Frames uploaded to VRAM are transferred by the device itself, that isn't pipelined
+      auto device = dynamic_cast<avcodec_software_encode_device_t *>(avcodec_session->device.get());
+      if (!device || device->frame->hw_frames_ctx) {
+        return nullptr;
+      }
+
+      auto pipeline = std::make_unique<convert_pipeline_t>(*device, std::move(images));
+      for (auto &slot : pipeline->slots) {
+        slot.frame = device->make_output_frame();
+        if (!slot.frame) {
+          BOOST_LOG(warning) << "Couldn't allocate frames for pipelined conversion"sv;
+          return nullptr;
+        }
+      }
+
+      pipeline->thread = std::thread {&convert_pipeline_t::run, pipeline.get()};
+
+      return pipeline;
+    }
+
+    convert_pipeline_t(avcodec_software_encode_device_t &device, img_event_t images):
+        device {device},
+        images {std::move(images)} {
+    }
+
+    ~convert_pipeline_t() {
+      {
+        std::lock_guard lg {lock};
+        stopped = true;
+      }
+
+      if (thread.joinable()) {
+        thread.join();
+      }
+
+      // The ring is about to be freed, hand the device its own frame back
+      device.frame = device.sw_frame.get();
+    }
+
+    /**
+     * @brief Switch the encoder over to the most recently converted frame.
+     * @param timeout How long to wait for a new frame.
+     * @param frame_timestamp Set to the capture timestamp of the new frame.
+     * @return 1 if a new frame was switched to, 0 if the timeout expired, -1 if conversion failed.
+     */
+    int pop(std::chrono::duration<double, std::milli> timeout, std::optional<std::chrono::steady_clock::time_point> &frame_timestamp) {
+      std::unique_lock ul {lock};
+
+      cv.wait_for(ul, timeout, [this]() {
+        return failed || done || std::ranges::any_of(slots, [](auto &slot) {
+                 return slot.state == slot_e::ready;
+               });
+      });
+
+      if (failed) {
+        return -1;
+      }
+
+      slot_t *newest = nullptr;
+      for (auto &slot : slots) {
+        if (slot.state == slot_e::ready && (!newest || slot.sequence > newest->sequence)) {
+          newest = &slot;
+        }
+      }
+
+      if (!newest) {
+        return 0;
+      }
+
+      // Like the image event, only the latest frame matters
+      for (auto &slot : slots) {
+        if (slot.state == slot_e::ready || slot.state == slot_e::held) {
+          slot.state = slot_e::free;
+        }
+      }
+      newest->state = slot_e::held;
+
+      // Keep any IDR request made on the previous frame
+      auto previous = device.frame;
+      newest->frame->pict_type = previous->pict_type;
+      newest->frame->flags = (newest->frame->flags & ~AV_FRAME_FLAG_KEY) | (previous->flags & AV_FRAME_FLAG_KEY);
+
+      device.frame = newest->frame.get();
+      frame_timestamp = newest->frame_timestamp;
+
+      return 1;
+    }
+
+  private:
+    enum class slot_e {
+      free,  ///< Available for conversion
+      converting,  ///< Being written by the helper thread
+      ready,  ///< Converted, waiting for the encoder
+      held,  ///< Currently referenced by the encoder
+    };
+
+    struct slot_t {
+      avcodec_frame_t frame;
+      slot_e state = slot_e::free;
+      std::uint64_t sequence = 0;
+      std::optional<std::chrono::steady_clock::time_point> frame_timestamp;
+    };
+
+    void run() {
+      platf::adjust_thread_priority(platf::thread_priority_e::high);
+
+      logging::time_delta_periodic_logger convert_logger {debug, "Pipelined convert"};
+
+      std::uint64_t sequence = 0;
+      while (true) {
+        {
+          std::lock_guard lg {lock};
+          if (stopped) {
+            break;
+          }
+        }
+
+        // Time out regularly to notice the pipeline being stopped
+        auto img = images->pop(100ms);
+        if (!img) {
+          if (!images->running()) {
+            break;
+          }
+          continue;
+        }
+
+        slot_t *target = nullptr;
+        {
+          std::lock_guard lg {lock};
+
+          // With one frame held by the encoder and one converted at a time, there is always
+          // either a free slot or a stale ready one that would be dropped anyway
+          for (auto &slot : slots) {
+            if (slot.state == slot_e::free) {
+              target = &slot;
+              break;
+            }
+            if (slot.state == slot_e::ready && (!target || slot.sequence < target->sequence)) {
+              target = &slot;
+            }
+          }
+          target->state = slot_e::converting;
+        }
+
+        convert_logger.first_point_now();
+
+        // The encoder may still reference the buffer from when this frame was last sent
+        auto status = av_frame_make_writable(target->frame.get());
+        if (status >= 0) {
+          status = device.convert_into(*img, target->frame.get());
+        }
+
+        convert_logger.second_point_now_and_log();
+
+        {
+          std::lock_guard lg {lock};
+          if (status < 0) {
+            target->state = slot_e::free;
+            failed = true;
+          } else {
+            target->state = slot_e::ready;
+            target->sequence = ++sequence;
+            target->frame_timestamp = img->frame_timestamp;
+          }
+        }
+        cv.notify_one();
+
+        if (status < 0) {
+          return;
+        }
+      }
+
+      {
+        std::lock_guard lg {lock};
+        done = true;
+      }
+      cv.notify_one();
+    }
+
+    avcodec_software_encode_device_t &device;
+    img_event_t images;
+
+    // One held by the encoder, one being converted and one ready to be picked up
+    std::array<slot_t, 3> slots;
+
+    std::mutex lock;
+    std::condition_variable cv;
+    bool stopped = false;
+    bool done = false;
+    bool failed = false;
+
+    std::thread thread;
+  };
+
   void encode_run(
     int &frame_nr,  // Store progress of the frame number
     safe::mail_t mail,
@@ -1922,6 +2126,15 @@ namespace video {
       }
     }
 
+    // Declared after the fail guard, so the helper thread is gone before the session is torn down
+    std::unique_ptr<convert_pipeline_t> convert_pipeline;
+    if (config::video.sw.pipelined_convert) {
+      convert_pipeline = convert_pipeline_t::make(*session, images);
+      if (convert_pipeline) {
+        BOOST_LOG(info) << "Pipelined color conversion enabled"sv;
+      }
+    }
+
     while (true) {
       // Break out of the encoding loop if any of the following are true:
       // a) The stream is ending
@@ -1954,7 +2167,16 @@ namespace video {
       std::optional<std::chrono::steady_clock::time_point> frame_timestamp;
 
       // Encode at a minimum FPS to avoid image quality issues with static content
-      if (!requested_idr_frame || images->peek()) {
+      if (convert_pipeline) {
+        // Don't hold up a requested IDR frame waiting for a new image
+        auto status = convert_pipeline->pop(requested_idr_frame ? decltype(max_frametime)::zero() : max_frametime, frame_timestamp);
+        if (status < 0) {
+          BOOST_LOG(error) << "Could not convert image"sv;
+          return;
+        } else if (status == 0 && !images->running()) {
+          break;
+        }
+      } else if (!requested_idr_frame || images->peek()) {
         if (auto img = images->pop(max_frametime)) {
           frame_timestamp = img->frame_timestamp;
           if (session->convert(*img)) {
@@ -2092,10 +2314,48 @@ namespace video {
     }
 
     encode_session.session = std::move(session);
+    // Numbered so the output of concurrent sessions can be told apart
+    static std::atomic<int> next_session_nr = 1;
+    auto label = std::format("Sync encode [session {}, {}x{}]: per-session convert+encode latency", next_session_nr++, ctx.config.width, ctx.config.height);
+    encode_session.encode_latency_logger = std::make_unique<logging::time_delta_periodic_logger>(debug, label);
 
     return encode_session;
   }
 
+  /**
+   * @brief Convert and encode the captured image for a single synchronized session.
+   * @return `false` if the session failed and has been asked to shut down.
+   */
+  bool encode_synced_session(sync_session_t &synced_session, platf::img_t *img, bool frame_captured) {
+    auto ctx = synced_session.ctx;
+
+    synced_session.encode_latency_logger->first_point_now();
+
+    if (frame_captured && synced_session.session->convert(*img)) {
+      BOOST_LOG(error) << "Could not convert image"sv;
+      ctx->shutdown_event->raise(true);
+
+      return false;
+    }
+
+    std::optional<std::chrono::steady_clock::time_point> frame_timestamp;
+    if (img) {
+      frame_timestamp = img->frame_timestamp;
+    }
+
+    if (encode(ctx->frame_nr++, *synced_session.session, ctx->packets, ctx->channel_data, frame_timestamp)) {
+      BOOST_LOG(error) << "Could not encode video packet"sv;
+      ctx->shutdown_event->raise(true);
+
+      return false;
+    }
+
+    synced_session.session->request_normal_frame();
+
+    synced_session.encode_latency_logger->second_point_now_and_log();
+    return true;
+  }
+
   encode_e encode_run_sync(
     std::vector<std::unique_ptr<sync_session_ctx_t>> &synced_session_ctxs,
     encode_session_ctx_queue_t &encode_session_ctx_queue,
@@ -2152,6 +2412,9 @@ namespace video {
       synced_sessions.emplace_back(std::move(*synced_session));
     }
 
+    // Helpers for encoding multiple sessions concurrently, the capture thread encodes one session itself
+    thread_pool_util::ThreadPool encode_pool {(int) std::clamp(std::thread::hardware_concurrency(), 2u, 4u) - 1};
+
     auto ec = platf::capture_e::ok;
     while (encode_session_ctx_queue.running()) {
       auto push_captured_image_callback = [&](std::shared_ptr<platf::img_t> &&img, bool frame_captured) -> bool {
@@ -2195,29 +2458,33 @@ namespace video {
             ctx->idr_events->pop();
           }
 
-          if (frame_captured && pos->session->convert(*img)) {
-            BOOST_LOG(error) << "Could not convert image"sv;
-            ctx->shutdown_event->raise(true);
-
-            continue;
-          }
-
-          std::optional<std::chrono::steady_clock::time_point> frame_timestamp;
-          if (img) {
-            frame_timestamp = img->frame_timestamp;
-          }
+          ++pos;
+        })
 
-          if (encode(ctx->frame_nr++, *pos->session, ctx->packets, ctx->channel_data, frame_timestamp)) {
-            BOOST_LOG(error) << "Could not encode video packet"sv;
-            ctx->shutdown_event->raise(true);
+        // Sessions are independent of each other, so all but the first one are encoded on the
+        // worker pool while this thread handles the first. Everything must be done before
+        // returning, since the next capture overwrites the shared image.
+        std::vector<std::future<bool>> pending;
+        pending.reserve(synced_sessions.size() - 1);
+        for (auto it = std::next(std::begin(synced_sessions)); it != std::end(synced_sessions); ++it) {
+          // Keep each session on the same helper, so its encoder state stays in that core's cache
+          auto helper = (std::size_t) std::distance(std::next(std::begin(synced_sessions)), it);
+          pending.emplace_back(encode_pool.pushAffine(helper, [&synced_session = *it, img = img.get(), frame_captured]() {
+            thread_local bool priority_set = false;
+            if (!priority_set) {
+              platf::adjust_thread_priority(platf::thread_priority_e::high);
+              priority_set = true;
+            }
 
-            continue;
-          }
+            return encode_synced_session(synced_session, img, frame_captured);
+          }));
+        }
 
-          pos->session->request_normal_frame();
+        encode_synced_session(synced_sessions.front(), img.get(), frame_captured);
 
-          ++pos;
-        })
+        for (auto &result : pending) {
+          result.wait();
+        }
 
         if (switch_display_event->peek()) {
           ec = platf::capture_e::reinit;
@@ -2364,6 +2631,19 @@ namespace video {
     config_t config,
     void *channel_data
   ) {
+    // Background revalidation of cached probe results must not run while streaming
+    {
+      std::lock_guard lg {encoder_probe_mutex};
+      ++active_streams;
+    }
+    auto stream_guard = util::fail_guard([]() {
+      {
+        std::lock_guard lg {encoder_probe_mutex};
+        --active_streams;
+      }
+      streams_ended.notify_all();
+    });
+
     auto idr_events = mail->event<bool>(mail::idr);
 
     idr_events->raise(true);
@@ -2445,7 +2725,16 @@ namespace video {
     return flag;
   }
 
-  bool validate_encoder(encoder_t &encoder, bool expect_failure) {
+  /**
+   * @brief Probe the capabilities of an encoder by running test encode sessions.
+   * @param encoder The encoder to probe, its capabilities are updated in place.
+   * @param hevc_mode The HEVC mode to probe for, like `active_hevc_mode`.
+   * @param av1_mode The AV1 mode to probe for, like `active_av1_mode`.
+   * @param expect_failure Order the probes to eliminate a failing encoder quickly.
+   * @param display_available Set to `false` if no display could be opened, in which case the result says nothing about the encoder.
+   * @return `true` if the encoder is usable.
+   */
+  bool probe_encoder(encoder_t &encoder, int hevc_mode, int av1_mode, bool expect_failure, bool &display_available) {
     const auto output_name {display_device::map_output_name(config::video.output_name)};
     std::shared_ptr<platf::display_t> disp;
 
@@ -2454,8 +2743,8 @@ namespace video {
       BOOST_LOG(info) << "Encoder ["sv << encoder.name << "] failed"sv;
     });
 
-    auto test_hevc = active_hevc_mode >= 2 || (active_hevc_mode == 0 && !(encoder.flags & H264_ONLY));
-    auto test_av1 = active_av1_mode >= 2 || (active_av1_mode == 0 && !(encoder.flags & H264_ONLY));
+    auto test_hevc = hevc_mode >= 2 || (hevc_mode == 0 && !(encoder.flags & H264_ONLY));
+    auto test_av1 = av1_mode >= 2 || (av1_mode == 0 && !(encoder.flags & H264_ONLY));
 
     encoder.h264.capabilities.set();
     encoder.hevc.capabilities.set();
@@ -2468,6 +2757,7 @@ namespace video {
     // If the encoder isn't supported at all (not even H.264), bail early
     reset_display(disp, encoder.platform_formats->dev_type, output_name, config_autoselect);
     if (!disp) {
+      display_available = false;
       return false;
     }
     if (!disp->is_codec_supported(encoder.h264.name, config_autoselect)) {
@@ -2570,6 +2860,7 @@ namespace video {
       // Reset the display since we're switching from SDR to HDR
       reset_display(disp, encoder.platform_formats->dev_type, output_name, generic_hdr_config);
       if (!disp) {
+        display_available = false;
         return false;
       }
 
@@ -2626,7 +2917,224 @@ namespace video {
     return true;
   }
 
+  namespace {
+    // Bump when the probing logic changes in a way that invalidates previous results within the same Sunshine build
+    constexpr auto probe_cache_version = "1"sv;
+
+    // Everything influencing probe results that isn't specific to an encoder, refreshed by each probe_encoders()
+    std::string probe_cache_context;
+
+    struct unvalidated_encoder_t {
+      encoder_t *encoder;
+      int hevc_mode;
+      int av1_mode;
+      std::string key;
+      encoder_probe_cache_t::entry_t cached;
+    };
+
+    // Encoders whose cached results were used, still to be revalidated
+    std::vector<unvalidated_encoder_t> unvalidated_encoders;
+    std::set<std::string> revalidated_keys;
+    bool revalidation_running = false;
+
+    std::mutex revalidation_thread_mutex;
+    std::jthread revalidation_thread;
+
+    encoder_probe_cache_t &probe_cache() {
+      static encoder_probe_cache_t cache {platf::appdata() / "encoder_probe_cache.json"};
+      return cache;
+    }
+
+    std::string make_probe_cache_context() {
+      std::ostringstream config_contents;
+      config_contents << std::ifstream {config::sunshine.config_file}.rdbuf();
+
+      return encoder_probe_cache_t::make_key({
+        probe_cache_version,
+        PROJECT_VERSION,
+        PROJECT_VERSION_COMMIT,
+        av_version_info(),
+        std::to_string(avcodec_version()),
+        platf::encoder_identity(),
+        std::to_string(std::hash<std::string> {}(config_contents.str())),
+        config::sunshine.flags[config::flag::FORCE_VIDEO_HEADER_REPLACE] ? "1"sv : "0"sv,
+      });
+    }
+
+    std::string probe_cache_key(const encoder_t &encoder, int hevc_mode, int av1_mode) {
+      return encoder_probe_cache_t::make_key({
+        probe_cache_context,
+        encoder.name,
+        std::to_string((int) encoder.platform_formats->dev_type),
+        display_device::map_output_name(config::video.output_name),
+        std::to_string(hevc_mode),
+        std::to_string(av1_mode),
+      });
+    }
+
+    encoder_probe_cache_t::entry_t make_probe_cache_entry(const encoder_t &encoder, bool passed) {
+      return {
+        passed,
+        encoder.h264.capabilities.to_string(),
+        encoder.hevc.capabilities.to_string(),
+        encoder.av1.capabilities.to_string(),
+      };
+    }
+
+    bool apply_probe_cache_entry(encoder_t &encoder, const encoder_probe_cache_t::entry_t &entry) {
+      // Entries written by a build with a different set of flags are unusable
+      for (auto caps : {&entry.h264, &entry.hevc, &entry.av1}) {
+        if (caps->size() != encoder_t::MAX_FLAGS || caps->find_first_not_of("01"sv) != std::string::npos) {
+          return false;
+        }
+      }
+
+      encoder.h264.capabilities = std::bitset<encoder_t::MAX_FLAGS> {entry.h264};
+      encoder.hevc.capabilities = std::bitset<encoder_t::MAX_FLAGS> {entry.hevc};
+      encoder.av1.capabilities = std::bitset<encoder_t::MAX_FLAGS> {entry.av1};
+
+      return true;
+    }
+
+    /**
+     * @brief Take the encoders whose cached results still need to be revalidated.
+     * @note Must be called with `encoder_probe_mutex` held.
+     */
+    auto take_unvalidated_encoders() {
+      std::vector<unvalidated_encoder_t> encoders;
+      if (revalidation_running) {
+        return encoders;
+      }
+
+      // Each set of cached results is only revalidated once per run
+      for (auto &pending : unvalidated_encoders) {
+        if (revalidated_keys.insert(pending.key).second) {
+          encoders.emplace_back(std::move(pending));
+        }
+      }
+      unvalidated_encoders.clear();
+
+      revalidation_running = !encoders.empty();
+      return encoders;
+    }
+
+    /**
+     * @brief Probe encoders whose cached results were used again, in the background.
+     * @details Updated results are written to the cache. If they differ from what is in use,
+     *          the next call to probe_encoders() picks an encoder from the updated results.
+     */
+    void revalidate_cached_encoders(std::vector<unvalidated_encoder_t> &&encoders) {
+      if (encoders.empty()) {
+        return;
+      }
+
+      std::lock_guard thread_lg {revalidation_thread_mutex};
+      revalidation_thread = std::jthread {[encoders = std::move(encoders)](std::stop_token stop_token) {
+        auto running_guard = util::fail_guard([]() {
+          std::lock_guard lg {encoder_probe_mutex};
+          revalidation_running = false;
+        });
+
+        BOOST_LOG(info) << "Revalidating cached encoder probe results"sv;
+        for (auto &[encoder, hevc_mode, av1_mode, key, cached] : encoders) {
+          // The lock is only held for one encoder at a time, so streams and probe_encoders()
+          // never wait for more than a single test session
+          std::unique_lock lock {encoder_probe_mutex};
+          if (!streams_ended.wait(lock, stop_token, []() {
+                return active_streams == 0;
+              })) {
+            BOOST_LOG(info) << "Revalidation of cached encoder probe results stopped"sv;
+            return;
+          }
+
+          // Capabilities in use stay untouched until the next probe
+          auto h264 = encoder->h264.capabilities;
+          auto hevc = encoder->hevc.capabilities;
+          auto av1 = encoder->av1.capabilities;
+
+          bool display_available = true;
+          auto passed = probe_encoder(*encoder, hevc_mode, av1_mode, !cached.passed, display_available);
+          auto fresh = make_probe_cache_entry(*encoder, passed);
+
+          encoder->h264.capabilities = h264;
+          encoder->hevc.capabilities = hevc;
+          encoder->av1.capabilities = av1;
+
+          if (!display_available || stop_token.stop_requested()) {
+            continue;
+          }
+
+          probe_cache().put(key, fresh);
+          if (fresh != cached) {
+            BOOST_LOG(warning) << "Cached probe results for encoder ["sv << encoder->name << "] were outdated, encoders will be probed again before the next stream"sv;
+            chosen_encoder_outdated = true;
+          }
+        }
+        BOOST_LOG(info) << "Finished revalidating cached encoder probe results"sv;
+      }};
+    }
+
+    /**
+     * @brief Stop and wait for the background revalidation, if any.
+     */
+    void stop_revalidation() {
+      std::lock_guard thread_lg {revalidation_thread_mutex};
+      if (revalidation_thread.joinable()) {
+        revalidation_thread.request_stop();
+        revalidation_thread.join();
+      }
+    }
+
+    class deinit_t: public platf::deinit_t {
+    public:
+      ~deinit_t() override {
+        stop_revalidation();
+      }
+    };
+  }  // namespace
+
+  std::unique_ptr<platf::deinit_t> init() {
+    return std::make_unique<deinit_t>();
+  }
+
+  bool validate_encoder(encoder_t &encoder, bool expect_failure) {
+    bool display_available = true;
+    return probe_encoder(encoder, active_hevc_mode, active_av1_mode, expect_failure, display_available);
+  }
+
+  /**
+   * @brief Validate an encoder, reusing cached probe results when possible.
+   */
+  static bool validate_encoder_cached(encoder_t &encoder, bool expect_failure) {
+    auto key = probe_cache_key(encoder, active_hevc_mode, active_av1_mode);
+
+    if (auto cached = probe_cache().get(key); cached && apply_probe_cache_entry(encoder, *cached)) {
+      BOOST_LOG(info) << "Using cached probe results for encoder ["sv << encoder.name << ']';
+      unvalidated_encoders.emplace_back(unvalidated_encoder_t {&encoder, active_hevc_mode, active_av1_mode, std::move(key), *cached});
+      return cached->passed;
+    }
+
+    bool display_available = true;
+    auto passed = probe_encoder(encoder, active_hevc_mode, active_av1_mode, expect_failure, display_available);
+
+    // Not being able to open a display is a transient failure that says nothing about the encoder
+    if (display_available) {
+      probe_cache().put(key, make_probe_cache_entry(encoder, passed));
+    }
+
+    return passed;
+  }
+
   int probe_encoders() {
+    std::unique_lock probe_lock {encoder_probe_mutex};
+
+    // Revalidate any cached results we used once we're done
+    auto revalidate_guard = util::fail_guard([&probe_lock]() {
+      auto encoders = take_unvalidated_encoders();
+      probe_lock.unlock();
+      revalidate_cached_encoders(std::move(encoders));
+    });
+
     if (!allow_encoder_probing()) {
       // Error already logged
       return -1;
@@ -2635,16 +3143,18 @@ namespace video {
     auto encoder_list = encoders;
 
     // If we already have a good encoder, check to see if another probe is required
-    if (chosen_encoder && !(chosen_encoder->flags & ALWAYS_REPROBE) && !platf::needs_encoder_reenumeration()) {
+    if (chosen_encoder && !chosen_encoder_outdated && !(chosen_encoder->flags & ALWAYS_REPROBE) && !platf::needs_encoder_reenumeration()) {
       return 0;
     }
 
     // Restart encoder selection
     auto previous_encoder = chosen_encoder;
     chosen_encoder = nullptr;
+    chosen_encoder_outdated = false;
     active_hevc_mode = config::video.hevc_mode;
     active_av1_mode = config::video.av1_mode;
     last_encoder_probe_supported_ref_frames_invalidation = false;
+    probe_cache_context = make_probe_cache_context();
 
     auto adjust_encoder_constraints = [&](encoder_t *encoder) {
       // If we can't satisfy both the encoder and codec requirement, prefer the encoder over codec support
@@ -2672,7 +3182,7 @@ namespace video {
 
         if (encoder->name == config::video.encoder) {
           // Remove the encoder from the list entirely if it fails validation
-          if (!validate_encoder(*encoder, previous_encoder && previous_encoder != encoder)) {
+          if (!validate_encoder_cached(*encoder, previous_encoder && previous_encoder != encoder)) {
             pos = encoder_list.erase(pos);
             break;
           }
@@ -2700,7 +3210,7 @@ namespace video {
         auto encoder = *pos;
 
         // Remove the encoder from the list entirely if it fails validation
-        if (!validate_encoder(*encoder, previous_encoder && previous_encoder != encoder)) {
+        if (!validate_encoder_cached(*encoder, previous_encoder && previous_encoder != encoder)) {
           pos = encoder_list.erase(pos);
           continue;
         }
@@ -2737,7 +3247,7 @@ namespace video {
         // If we've used a previous encoder and it's not this one, we expect this encoder to
         // fail to validate. It will use a slightly different order of checks to more quickly
         // eliminate failing encoders.
-        if (!validate_encoder(*encoder, previous_encoder && previous_encoder != encoder)) {
+        if (!validate_encoder_cached(*encoder, previous_encoder && previous_encoder != encoder)) {
           pos = encoder_list.erase(pos);
           continue;
         }
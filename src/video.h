@@ -343,6 +343,12 @@ namespace video {
 
   bool validate_encoder(encoder_t &encoder, bool expect_failure);
 
+  /**
+   * @brief Initialize the video module.
+   * @return A guard that stops background encoder revalidation when destroyed.
+   */
+  [[nodiscard]] std::unique_ptr<platf::deinit_t> init();
+
   /**
    * @brief Probe encoders and select the preferred encoder.
    * This is called once at startup and each time a stream is launched to
@@ -56,6 +56,7 @@ const defaultGroups = [
       audio_sink: '',
       virtual_sink: '',
       install_steam_audio_drivers: 'enabled',
+      audio_silence_detection: 'enabled',
       adapter_name: '',
       output_name: '',
       dd_configuration_option: 'disabled',
@@ -187,6 +188,7 @@ const defaultGroups = [
     options: {
       sw_preset: 'superfast',
       sw_tune: 'zerolatency',
+      sw_pipelined_convert: 'disabled',
     },
   },
 ];
@@ -0,0 +1,75 @@
+import { defineStore } from 'pinia';
+import { ref, Ref } from 'vue';
+
+export interface StatusEvent {
+  event: string;
+  activeSessions: number;
+  appRunning: boolean;
+  paused: boolean;
+}
+
+type StatusListener = (status: StatusEvent) => void;
+
+// Server state pushed over /api/events instead of polling for it.
+// The stream is opened by the first subscriber and closed after the last one leaves.
+export const useStatusStore = defineStore('status', () => {
+  const activeSessions: Ref<number> = ref(0);
+  const appRunning: Ref<boolean> = ref(false);
+  const paused: Ref<boolean> = ref(false);
+  const connected: Ref<boolean> = ref(false);
+  const _listeners = new Set<StatusListener>();
+  let source: EventSource | null = null;
+
+  function open(): void {
+    if (source) return;
+
+    source = new EventSource('./api/events');
+    source.addEventListener('status', (e) => {
+      let status: StatusEvent;
+      try {
+        status = JSON.parse((e as MessageEvent).data);
+      } catch {
+        return;
+      }
+
+      activeSessions.value = status.activeSessions;
+      appRunning.value = status.appRunning;
+      paused.value = status.paused;
+      for (const cb of _listeners) {
+        try {
+          cb(status);
+        } catch (err) {
+          console.error('status listener error', err);
+        }
+      }
+    });
+    // EventSource reconnects by itself after network errors
+    source.onopen = () => (connected.value = true);
+    source.onerror = () => (connected.value = false);
+  }
+
+  function close(): void {
+    source?.close();
+    source = null;
+    connected.value = false;
+  }
+
+  function subscribe(cb?: StatusListener): () => void {
+    const listener: StatusListener = cb ?? (() => {});
+    _listeners.add(listener);
+    open();
+
+    return () => {
+      _listeners.delete(listener);
+      if (_listeners.size === 0) close();
+    };
+  }
+
+  return {
+    activeSessions,
+    appRunning,
+    paused,
+    connected,
+    subscribe,
+  };
+});
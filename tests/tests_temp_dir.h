@@ -0,0 +1,49 @@
+/**
+ * @file tests/tests_temp_dir.h
+ * @brief Test fixture owning a unique temporary directory.
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <system_error>
+
+#ifdef _WIN32
+  #include <process.h>
+#else
+  #include <unistd.h>
+#endif
+
+#include "tests_common.h"
+
+/**
+ * @brief Fixture creating a fresh directory for each test and removing it afterwards.
+ *
+ * The name combines the process id with a random suffix,
+ * so concurrent test runs never share or delete each other's files.
+ */
+struct TempDirTest: testing::Test {
+  void SetUp() override {
+#ifdef _WIN32
+    const auto pid = _getpid();
+#else
+    const auto pid = getpid();
+#endif
+    std::random_device rd;
+    std::uniform_int_distribution<std::uint32_t> suffix;
+
+    // create_directory() reports false when the name is taken, so retry with another suffix
+    do {
+      dir = std::filesystem::temp_directory_path() / ("sunshine_test_" + std::to_string(pid) + "_" + std::to_string(suffix(rd)));
+    } while (!std::filesystem::create_directory(dir));
+  }
+
+  void TearDown() override {
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+  }
+
+  std::filesystem::path dir;
+};
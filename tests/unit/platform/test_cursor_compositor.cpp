@@ -0,0 +1,107 @@
+/**
+ * @file tests/unit/platform/test_cursor_compositor.cpp
+ * @brief Test src/platform/linux/cursor_compositor.*.
+ */
+#ifdef __linux__
+  #include "../../tests_common.h"
+
+  #include <random>
+  #include <src/platform/linux/cursor_compositor.h>
+
+namespace {
+  struct test_img_t: platf::img_t {
+    test_img_t(int width, int height, std::uint32_t fill):
+        buffer(width * height, fill) {
+      this->width = width;
+      this->height = height;
+      pixel_pitch = 4;
+      row_pitch = width * 4;
+      data = (std::uint8_t *) buffer.data();
+    }
+
+    std::uint32_t at(int x, int y) const {
+      return buffer[y * width + x];
+    }
+
+    std::vector<std::uint32_t> buffer;
+  };
+
+  std::uint32_t premultiplied(std::uint32_t alpha, std::uint32_t r, std::uint32_t g, std::uint32_t b) {
+    return alpha << 24 | (r * alpha / 255) << 16 | (g * alpha / 255) << 8 | (b * alpha / 255);
+  }
+}  // namespace
+
+TEST(CursorCompositorTest, SimdMatchesScalar) {
+  std::mt19937 rng {42};
+
+  // Odd lengths exercise the vector tails
+  for (int count : {1, 3, 4, 7, 8, 15, 16, 33, 64}) {
+    std::vector<std::uint32_t> src(count);
+    std::vector<std::uint32_t> dst(count);
+    for (int i = 0; i < count; ++i) {
+      src[i] = premultiplied(rng() % 256, rng() % 256, rng() % 256, rng() % 256);
+      dst[i] = rng();
+    }
+    src[0] = 0;
+
+    auto expected = dst;
+    platf::cursor_compositor_t::blend_row_scalar(expected.data(), src.data(), count);
+    platf::cursor_compositor_t::blend_row(dst.data(), src.data(), count);
+
+    EXPECT_EQ(dst, expected) << "count " << count;
+  }
+}
+
+TEST(CursorCompositorTest, BlendsPremultipliedPixels) {
+  std::uint32_t opaque = 0xFF102030;
+  std::uint32_t half = premultiplied(128, 255, 255, 255);
+  std::uint32_t clear = 0;
+
+  std::uint32_t dst[] = {0xFF000000, 0xFF000000, 0xFF404040};
+  std::uint32_t src[] = {opaque, half, clear};
+  platf::cursor_compositor_t::blend_row_scalar(dst, src, 3);
+
+  EXPECT_EQ(dst[0], opaque);
+  EXPECT_EQ(dst[1] & 0xFFFFFF, 0x808080u);
+  EXPECT_EQ(dst[2], 0xFF404040u);
+}
+
+TEST(CursorCompositorTest, ClipsCursorAtImageEdges) {
+  test_img_t img {8, 8, 0xFF000000};
+
+  std::vector<std::uint32_t> cursor(4 * 4, 0xFFFFFFFF);
+  platf::cursor_compositor_t compositor;
+  ASSERT_TRUE(compositor.needs_image(1));
+  compositor.set_image(1, 4, 4, cursor.data(), 4);
+  ASSERT_FALSE(compositor.needs_image(1));
+  ASSERT_TRUE(compositor.needs_image(2));
+
+  // Top left corner hangs off the image, only the bottom right 2x2 quadrant is visible
+  compositor.set_position(8, 8);
+  compositor.blend(img, 10, 10);
+
+  for (int y = 0; y < 8; ++y) {
+    for (int x = 0; x < 8; ++x) {
+      EXPECT_EQ(img.at(x, y), x < 2 && y < 2 ? 0xFFFFFFFFu : 0xFF000000u) << x << ',' << y;
+    }
+  }
+
+  // Completely off screen
+  test_img_t untouched {8, 8, 0xFF000000};
+  compositor.set_position(100, 100);
+  compositor.blend(untouched, 0, 0);
+  EXPECT_EQ(untouched.buffer, std::vector<std::uint32_t>(64, 0xFF000000));
+}
+
+TEST(CursorCompositorTest, HiddenCursorIsNotBlended) {
+  test_img_t img {4, 4, 0xFF000000};
+
+  std::vector<std::uint32_t> cursor(4, 0xFFFFFFFF);
+  platf::cursor_compositor_t compositor;
+  compositor.set_image(1, 2, 2, cursor.data(), 2);
+  compositor.set_visible(false);
+  compositor.blend(img, 0, 0);
+
+  EXPECT_EQ(img.buffer, std::vector<std::uint32_t>(16, 0xFF000000));
+}
+#endif
@@ -0,0 +1,84 @@
+/**
+ * @file tests/unit/platform/test_inputtino_batch.cpp
+ * @brief Test src/platform/linux/input/inputtino_batch.h.
+ */
+#ifdef __linux__
+  #include "../../tests_common.h"
+
+  #include <src/platform/linux/input/inputtino_batch.h>
+
+namespace {
+  /**
+   * @brief Stands in for an inputtino joypad, counting the uinput writes it would make.
+   */
+  struct fake_joypad_t {
+    enum STICK_POSITION {
+      RS,
+      LS
+    };
+
+    void set_pressed_buttons(unsigned int flags) {
+      buttons = flags;
+      ++syn_reports;
+    }
+
+    void set_stick(STICK_POSITION stick, short x, short y) {
+      (stick == LS ? ls : rs) = {x, y};
+      ++syn_reports;
+    }
+
+    void set_triggers(std::int16_t left, std::int16_t right) {
+      triggers = {left, right};
+      ++syn_reports;
+    }
+
+    unsigned int buttons = 0;
+    std::pair<short, short> ls;
+    std::pair<short, short> rs;
+    std::pair<std::int16_t, std::int16_t> triggers;
+    int syn_reports = 0;
+  };
+}  // namespace
+
+TEST(InputtinoBatchTest, NewDeviceGetsTheWholeState) {
+  fake_joypad_t joypad;
+  std::optional<platf::gamepad_state_t> last;
+
+  platf::gamepad_state_t state {0x1000, 10, 20, 100, -100, 200, -200};
+  EXPECT_EQ(platf::gamepad::apply_state(joypad, last, state), 4);
+  EXPECT_EQ(joypad.syn_reports, 4);
+
+  EXPECT_EQ(joypad.buttons, 0x1000);
+  EXPECT_EQ(joypad.ls, (std::pair<short, short> {100, -100}));
+  EXPECT_EQ(joypad.rs, (std::pair<short, short> {200, -200}));
+  EXPECT_EQ(joypad.triggers, (std::pair<std::int16_t, std::int16_t> {10, 20}));
+}
+
+TEST(InputtinoBatchTest, OnlyChangedComponentsAreWritten) {
+  fake_joypad_t joypad;
+  std::optional<platf::gamepad_state_t> last;
+
+  platf::gamepad_state_t state {};
+  platf::gamepad::apply_state(joypad, last, state);
+  joypad.syn_reports = 0;
+
+  // A stick sweep, the most common burst, is one report per state
+  for (short x = 0; x < 100; ++x) {
+    state.lsX = x * 100;
+    platf::gamepad::apply_state(joypad, last, state);
+  }
+  EXPECT_EQ(joypad.syn_reports, 99);
+
+  // Repeated identical states cost nothing
+  joypad.syn_reports = 0;
+  for (int x = 0; x < 10; ++x) {
+    EXPECT_EQ(platf::gamepad::apply_state(joypad, last, state), 0);
+  }
+  EXPECT_EQ(joypad.syn_reports, 0);
+
+  state.buttonFlags = 0x1;
+  state.rt = 255;
+  EXPECT_EQ(platf::gamepad::apply_state(joypad, last, state), 2);
+  EXPECT_EQ(joypad.ls.first, 9900);
+}
+#endif
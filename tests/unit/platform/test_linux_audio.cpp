@@ -0,0 +1,111 @@
+/**
+ * @file tests/unit/platform/test_linux_audio.cpp
+ * @brief Test src/platform/linux/audio.cpp against a local null sink.
+ */
+#ifdef __linux__
+  #include "../../tests_common.h"
+
+  #include <atomic>
+  #include <pulse/error.h>
+  #include <pulse/simple.h>
+  #include <src/config.h>
+  #include <thread>
+
+using namespace std::literals;
+
+struct LinuxAudioTest: PlatformTestSuite {};
+
+TEST_F(LinuxAudioTest, NullSinkToPacketLatency) {
+  constexpr std::uint32_t sample_rate = 48000;
+  constexpr std::uint32_t frame_size = 240;
+  constexpr int channels = 2;
+
+  auto control = platf::audio_control();
+  if (!control) {
+    GTEST_SKIP() << "PulseAudio isn't available";
+  }
+
+  auto sink = control->sink_info();
+  if (!sink || !sink->null) {
+    GTEST_SKIP() << "Couldn't create the virtual sinks";
+  }
+
+  auto previous_sink = config::audio.sink;
+  config::audio.sink = sink->null->stereo;
+  auto fg = util::fail_guard([&previous_sink]() {
+    config::audio.sink = previous_sink;
+  });
+
+  auto mic = control->microphone(platf::speaker::map_stereo, channels, sample_rate, frame_size);
+  ASSERT_TRUE(mic);
+
+  pa_sample_spec ss {PA_SAMPLE_FLOAT32, sample_rate, channels};
+  pa_buffer_attr attr {
+    .maxlength = uint32_t(-1),
+    .tlength = uint32_t(frame_size * channels * sizeof(float) * 2),
+    .prebuf = uint32_t(-1),
+    .minreq = uint32_t(-1),
+    .fragsize = uint32_t(-1),
+  };
+
+  int status;
+  util::safe_ptr<pa_simple, pa_simple_free> player {
+    pa_simple_new(nullptr, "sunshine-tests", PA_STREAM_PLAYBACK, sink->null->stereo.c_str(), "latency-probe", &ss, nullptr, &attr, &status)
+  };
+  ASSERT_TRUE(player) << pa_strerror(status);
+
+  // Play silence for a while, then a single loud frame
+  std::atomic_bool done {false};
+  std::atomic<std::chrono::steady_clock::time_point> pulse_sent {};
+  std::thread playback {[&]() {
+    std::vector<float> silence(frame_size * channels);
+    std::vector<float> pulse(frame_size * channels, 0.5f);
+
+    for (int x = 0; !done; ++x) {
+      auto &frame = x == 40 ? pulse : silence;
+      if (x == 40) {
+        pulse_sent = std::chrono::steady_clock::now();
+      }
+
+      if (pa_simple_write(player.get(), frame.data(), frame.size() * sizeof(float), &status)) {
+        break;
+      }
+    }
+  }};
+
+  std::vector<float> frame(frame_size * channels);
+  std::optional<std::chrono::steady_clock::time_point> pulse_captured;
+  std::chrono::steady_clock::time_point pulse_packet;
+
+  // Give up after 2 seconds worth of audio
+  for (int x = 0; x < 400 && !pulse_captured; ++x) {
+    ASSERT_EQ(mic->sample(frame), platf::capture_e::ok);
+
+    auto capture_time = mic->capture_time();
+    ASSERT_TRUE(capture_time);
+
+    auto loud = std::ranges::find_if(frame, [](float sample) {
+      return sample > 0.25f;
+    });
+
+    if (loud != std::end(frame)) {
+      auto offset = std::chrono::duration<double>((double) (loud - std::begin(frame)) / channels / sample_rate);
+
+      pulse_packet = std::chrono::steady_clock::now();
+      pulse_captured = *capture_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset);
+    }
+  }
+
+  done = true;
+  playback.join();
+
+  ASSERT_TRUE(pulse_captured) << "The pulse never made it through the null sink";
+
+  auto sink_to_capture = std::chrono::duration<double, std::milli>(*pulse_captured - pulse_sent.load());
+  auto capture_to_packet = std::chrono::duration<double, std::milli>(pulse_packet - *pulse_captured);
+  BOOST_LOG(tests) << "Null sink latency: sink to capture "sv << sink_to_capture.count() << "ms, capture to packet "sv << capture_to_packet.count() << "ms"sv;
+
+  EXPECT_GE(capture_to_packet.count(), 0);
+  EXPECT_LT(std::chrono::duration<double, std::milli>(pulse_packet - pulse_sent.load()).count(), 500);
+}
+#endif
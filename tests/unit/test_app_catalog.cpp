@@ -0,0 +1,111 @@
+/**
+ * @file tests/unit/test_app_catalog.cpp
+ * @brief Test src/app_catalog.*.
+ */
+#include "../tests_temp_dir.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <src/app_catalog.h>
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+  class AppCatalogTest: public TempDirTest {
+  protected:
+    std::string write(const std::string &name, const std::string &data) {
+      auto path = dir / name;
+      std::ofstream(path, std::ios::binary) << data;
+      return path.string();
+    }
+  };
+}  // namespace
+
+TEST_F(AppCatalogTest, HashesFiles) {
+  auto path = write("cover.png", "abc");
+
+  // App ids are derived from the lowercase hex digest
+  EXPECT_EQ(app_catalog::file_sha256(path), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+}
+
+TEST_F(AppCatalogTest, HashesAreCachedUntilTheFileChanges) {
+  auto path = write("cover.png", "abc");
+  auto first = app_catalog::file_sha256(path);
+
+  auto hits = app_catalog::hash_hits();
+  auto misses = app_catalog::hash_misses();
+  EXPECT_EQ(app_catalog::file_sha256(path), first);
+  EXPECT_EQ(app_catalog::hash_hits(), hits + 1);
+
+  write("cover.png", "abcd");
+  EXPECT_NE(app_catalog::file_sha256(path), first);
+  EXPECT_EQ(app_catalog::hash_misses(), misses + 1);
+}
+
+TEST_F(AppCatalogTest, PruneForgetsUnusedHashes) {
+  auto kept = write("kept.png", "abc");
+  auto removed = write("removed.png", "def");
+  app_catalog::file_sha256(kept);
+  app_catalog::file_sha256(removed);
+  app_catalog::prune_hashes();
+
+  // Only the image of the remaining app is requested by the next refresh
+  app_catalog::file_sha256(kept);
+  app_catalog::prune_hashes();
+
+  auto hits = app_catalog::hash_hits();
+  auto misses = app_catalog::hash_misses();
+  app_catalog::file_sha256(kept);
+  app_catalog::file_sha256(removed);
+  EXPECT_EQ(app_catalog::hash_hits(), hits + 1);
+  EXPECT_EQ(app_catalog::hash_misses(), misses + 1);
+}
+
+TEST_F(AppCatalogTest, ReusesParsedAppsUntilTheFileChanges) {
+  auto path = write("apps.json", R"({"env": {}, "apps": [{"name": "Desktop"}]})");
+
+  auto first = app_catalog::apps(path);
+  EXPECT_EQ((*first)["apps"][0]["name"], "Desktop");
+  EXPECT_EQ(app_catalog::apps(path), first);
+
+  write("apps.json", R"({"env": {}, "apps": [{"name": "Steam"}]})");
+  auto second = app_catalog::apps(path);
+  EXPECT_NE(second, first);
+  EXPECT_EQ((*second)["apps"][0]["name"], "Steam");
+
+  // Callers holding the previous version still see it
+  EXPECT_EQ((*first)["apps"][0]["name"], "Desktop");
+}
+
+TEST_F(AppCatalogTest, InvalidAppsThrow) {
+  auto path = write("apps.json", "{ not json");
+
+  EXPECT_ANY_THROW(app_catalog::apps(path));
+}
+
+TEST_F(AppCatalogTest, RefreshBenchmark) {
+  constexpr int apps = 200;
+
+  std::vector<std::string> covers;
+  for (int x = 0; x < apps; ++x) {
+    covers.emplace_back(write(std::to_string(x) + ".png", std::string(256 * 1024, (char) x)));
+  }
+
+  // Every refresh computes the id of every app from its cover
+  auto refresh = [&]() {
+    auto start = std::chrono::steady_clock::now();
+    for (auto &cover : covers) {
+      EXPECT_TRUE(app_catalog::file_sha256(cover));
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+  };
+
+  auto first = refresh();
+  auto misses = app_catalog::hash_misses();
+  auto cached = refresh();
+  EXPECT_EQ(app_catalog::hash_misses(), misses);
+
+  BOOST_LOG(tests) << "Hashing "sv << apps << " covers: "sv << first.count() << "ms, from the cache: "sv << cached.count() << "ms"sv;
+}
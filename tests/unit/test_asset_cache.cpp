@@ -0,0 +1,174 @@
+/**
+ * @file tests/unit/test_asset_cache.cpp
+ * @brief Test src/asset_cache.*.
+ */
+#include "../tests_temp_dir.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <src/asset_cache.h>
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+  class AssetCacheTest: public TempDirTest {
+  protected:
+    fs::path write(const std::string &name, const std::string &data) {
+      auto path = dir / name;
+      std::ofstream(path, std::ios::binary) << data;
+      return path;
+    }
+  };
+}  // namespace
+
+TEST_F(AssetCacheTest, ServesRepeatedRequestsFromMemory) {
+  http::asset_cache_t cache {1024};
+  auto path = write("cover.png", "png data");
+
+  auto first = cache.get(path);
+  ASSERT_TRUE(first);
+  EXPECT_EQ(first->data, "png data");
+  EXPECT_TRUE(first->etag.starts_with('"') && first->etag.ends_with('"'));
+
+  auto second = cache.get(path);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.misses(), 1);
+  EXPECT_EQ(cache.bytes(), 8);
+}
+
+TEST_F(AssetCacheTest, ReloadsChangedFiles) {
+  http::asset_cache_t cache {1024};
+  auto path = write("cover.png", "old");
+  auto old_asset = cache.get(path);
+
+  write("cover.png", "new cover");
+  auto new_asset = cache.get(path);
+  ASSERT_TRUE(new_asset);
+  EXPECT_EQ(new_asset->data, "new cover");
+  EXPECT_NE(new_asset->etag, old_asset->etag);
+
+  // Same size, only the modification time tells the files apart
+  write("cover.png", "new COVER");
+  fs::last_write_time(path, new_asset->mtime + std::chrono::seconds(1));
+  auto touched = cache.get(path);
+  EXPECT_EQ(touched->data, "new COVER");
+  EXPECT_EQ(cache.misses(), 3);
+  EXPECT_EQ(cache.bytes(), 9);
+}
+
+TEST_F(AssetCacheTest, MissingFile) {
+  http::asset_cache_t cache {1024};
+
+  EXPECT_FALSE(cache.get(dir / "missing.png"));
+}
+
+TEST_F(AssetCacheTest, EvictsLeastRecentlyUsed) {
+  http::asset_cache_t cache {100};
+  auto a = write("a.png", std::string(25, 'a'));
+  auto b = write("b.png", std::string(25, 'b'));
+  auto c = write("c.png", std::string(25, 'c'));
+  auto d = write("d.png", std::string(25, 'd'));
+  auto e = write("e.png", std::string(25, 'e'));
+
+  cache.get(a);
+  cache.get(b);
+  cache.get(c);
+  cache.get(d);
+  cache.get(a);
+  cache.get(e);
+  EXPECT_EQ(cache.bytes(), 100);
+
+  // b was the least recently used
+  auto misses = cache.misses();
+  cache.get(a);
+  cache.get(c);
+  EXPECT_EQ(cache.misses(), misses);
+  cache.get(b);
+  EXPECT_EQ(cache.misses(), misses + 1);
+}
+
+TEST_F(AssetCacheTest, LargeFilesAreNotCached) {
+  http::asset_cache_t cache {100};
+  auto path = write("large.png", std::string(50, 'x'));
+
+  EXPECT_EQ(cache.get(path)->data.size(), 50);
+  EXPECT_EQ(cache.bytes(), 0);
+}
+
+TEST(EtagMatchesTest, ParsesIfNoneMatch) {
+  EXPECT_TRUE(http::etag_matches(R"("abc")", R"("abc")"));
+  EXPECT_TRUE(http::etag_matches(R"("x", "abc")", R"("abc")"));
+  EXPECT_TRUE(http::etag_matches(R"(W/"abc")", R"("abc")"));
+  EXPECT_TRUE(http::etag_matches("*", R"("abc")"));
+  EXPECT_FALSE(http::etag_matches(R"("abcd")", R"("abc")"));
+  EXPECT_FALSE(http::etag_matches("abc", R"("abc")"));
+  EXPECT_FALSE(http::etag_matches("", R"("abc")"));
+}
+
+TEST(AcceptsEncodingTest, ParsesAcceptEncoding) {
+  EXPECT_TRUE(http::accepts_encoding("gzip, deflate, br", "br"));
+  EXPECT_TRUE(http::accepts_encoding("gzip, deflate, br", "gzip"));
+  EXPECT_TRUE(http::accepts_encoding("GZIP;q=0.5", "gzip"));
+  EXPECT_FALSE(http::accepts_encoding("gzip, deflate", "br"));
+  EXPECT_FALSE(http::accepts_encoding("", "gzip"));
+
+  // Refused codings
+  EXPECT_FALSE(http::accepts_encoding("br;q=0, gzip", "br"));
+  EXPECT_FALSE(http::accepts_encoding("br; q=0.000", "br"));
+
+  // Anything not listed
+  EXPECT_TRUE(http::accepts_encoding("*", "br"));
+  EXPECT_FALSE(http::accepts_encoding("*;q=0", "br"));
+  EXPECT_FALSE(http::accepts_encoding("br;q=0, *", "br"));
+}
+
+TEST(IsHashedNameTest, RecognizesBuildOutput) {
+  EXPECT_TRUE(http::is_hashed_name("index-BdQq_4o1.js"));
+  EXPECT_TRUE(http::is_hashed_name("Troubleshooting-9f1c2d3e.css"));
+  EXPECT_TRUE(http::is_hashed_name("_plugin-vue_export-helper-DlAUqK2U.js"));
+
+  EXPECT_FALSE(http::is_hashed_name("index.html"));
+  EXPECT_FALSE(http::is_hashed_name("fa-solid-900.woff2"));
+  EXPECT_FALSE(http::is_hashed_name("logo-sunshine-45.png"));
+  EXPECT_FALSE(http::is_hashed_name("password-settings.js"));
+}
+
+TEST_F(AssetCacheTest, CoverRefreshBenchmark) {
+  constexpr int covers = 20;
+  constexpr int refreshes = 10;
+  http::asset_cache_t cache {64 * 1024 * 1024};
+
+  std::vector<fs::path> paths;
+  for (int x = 0; x < covers; ++x) {
+    paths.emplace_back(write(std::to_string(x) + ".png", std::string(100 * 1024, (char) x)));
+  }
+
+  // Every refresh of the app list fetches all covers again
+  std::size_t sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int x = 0; x < refreshes; ++x) {
+    for (auto &path : paths) {
+      std::ifstream in(path, std::ios::binary);
+      std::string data {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+      sum += data.size();
+    }
+  }
+  auto uncached = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for (int x = 0; x < refreshes; ++x) {
+    for (auto &path : paths) {
+      sum += cache.get(path)->data.size();
+    }
+  }
+  auto cached = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(sum, 2ull * covers * refreshes * 100 * 1024);
+  EXPECT_EQ(cache.misses(), covers);
+
+  BOOST_LOG(tests) << "Reading covers: "sv << std::chrono::duration_cast<std::chrono::milliseconds>(uncached).count()
+                   << "ms, from the cache: "sv << std::chrono::duration_cast<std::chrono::milliseconds>(cached).count() << "ms"sv;
+}
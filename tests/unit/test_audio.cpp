@@ -4,6 +4,7 @@
  */
 #include "../tests_common.h"
 
+#include <map>
 #include <src/audio.h>
 
 using namespace audio;
@@ -67,3 +68,54 @@ TEST_P(AudioTest, TestEncode) {
   timer.join();
   capture.join();
 }
+
+TEST_P(AudioTest, TestSharedEncode) {
+  // A second session with the same configuration
+  auto other_mail = std::make_shared<safe::mail_raw_t>();
+  int channels[2];
+
+  // Keep the queue alive after capture stops
+  auto packets = mail::man->queue<packet_t>(mail::audio_packets);
+
+  std::thread timer([&] {
+    // Terminate both audio captures after 2 seconds.
+    std::this_thread::sleep_for(2s);
+    m_mail->event<bool>(mail::shutdown)->raise(true);
+    other_mail->event<bool>(mail::shutdown)->raise(true);
+  });
+
+  std::thread other_capture([&] {
+    audio::capture(other_mail, m_config, &channels[1]);
+  });
+  audio::capture(m_mail, m_config, &channels[0]);
+
+  timer.join();
+  other_capture.join();
+
+  // Both sessions received the very same encoded packets
+  std::map<const std::uint8_t *, int> sessions_per_packet;
+  while (packets->peek()) {
+    auto packet = packets->pop();
+    sessions_per_packet[std::begin(packet->second)] |= packet->first == &channels[0] ? 1 : 2;
+  }
+
+  if (sessions_per_packet.empty()) {
+    GTEST_SKIP() << "No audio was captured";
+  }
+
+  EXPECT_TRUE(std::ranges::any_of(sessions_per_packet, [](auto &pair) {
+    return pair.second == 3;
+  }));
+}
+
+TEST(AudioSilenceTest, DetectsDigitalSilence) {
+  std::vector<float> samples(480);
+  EXPECT_TRUE(is_silent(samples));
+
+  // Dither below the least significant bit of 16 bit audio
+  samples[10] = -1.0f / 65536;
+  EXPECT_TRUE(is_silent(samples));
+
+  samples[479] = 1.0f / 8192;
+  EXPECT_FALSE(is_silent(samples));
+}
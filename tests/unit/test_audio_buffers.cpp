@@ -0,0 +1,198 @@
+/**
+ * @file tests/unit/test_audio_buffers.cpp
+ * @brief Test src/audio_buffers.*.
+ */
+#include "../tests_common.h"
+
+#include <cstdlib>
+#include <new>
+#include <src/audio.h>
+#include <thread>
+
+namespace {
+  // Only the allocations of the thread running the test count, other threads of the test binary
+  // (the log sink, pools of other tests) allocate whenever they please
+  thread_local bool count_allocations = false;
+  thread_local std::size_t allocations = 0;
+}  // namespace
+
+// Count heap allocations made by this thread while count_allocations is set
+void *operator new(std::size_t size) {
+  if (count_allocations) {
+    ++allocations;
+  }
+
+  if (auto p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc {};
+}
+
+void operator delete(void *p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+  std::free(p);
+}
+
+TEST(SampleRingTest, DeliversFramesInOrder) {
+  audio::sample_ring_t ring {3, 2};
+
+  for (float x = 0; x < 3; ++x) {
+    auto &frame = ring.write_frame();
+    frame[0] = x;
+    ring.commit();
+  }
+
+  for (float x = 0; x < 3; ++x) {
+    auto frame = ring.read_frame();
+    ASSERT_TRUE(frame);
+    EXPECT_EQ((*frame)[0], x);
+    ring.release();
+  }
+  EXPECT_EQ(ring.overruns(), 0);
+}
+
+TEST(SampleRingTest, DropsFramesWhenFull) {
+  audio::sample_ring_t ring {2, 2};
+
+  for (float x = 0; x < 4; ++x) {
+    ring.write_frame()[0] = x;
+    ring.commit();
+  }
+  EXPECT_EQ(ring.overruns(), 2);
+
+  // The frames that made it into the ring are untouched
+  EXPECT_EQ((*ring.read_frame())[0], 0);
+  ring.release();
+  EXPECT_EQ((*ring.read_frame())[0], 1);
+  ring.release();
+}
+
+TEST(SampleRingTest, KeepsCaptureTimes) {
+  audio::sample_ring_t ring {2, 2};
+  auto now = std::chrono::steady_clock::now();
+
+  ring.write_frame();
+  ring.commit(now);
+  ring.write_frame();
+  ring.commit();
+
+  ring.read_frame();
+  EXPECT_EQ(ring.read_time(), now);
+  ring.release();
+
+  ring.read_frame();
+  EXPECT_EQ(ring.read_time(), std::chrono::steady_clock::time_point {});
+  ring.release();
+}
+
+TEST(SampleRingTest, StopWakesReader) {
+  audio::sample_ring_t ring {2, 2};
+
+  std::thread stopper {[&ring]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ring.stop();
+  }};
+
+  EXPECT_FALSE(ring.read_frame());
+  stopper.join();
+}
+
+TEST(PacketPoolTest, RecyclesSlotsOnceAllCopiesAreGone) {
+  auto pool = audio::packet_pool_t::make(2, 16);
+
+  auto packet = pool->acquire();
+  ASSERT_TRUE(packet);
+  EXPECT_EQ(packet.size(), 16);
+  packet.resize(4);
+  EXPECT_EQ(packet.size(), 4);
+
+  auto copy = packet;
+  auto raw = copy.begin();
+  packet = {};
+  EXPECT_EQ(pool->free_count(), 1);
+
+  copy = {};
+  EXPECT_EQ(pool->free_count(), 2);
+
+  // Reused slots are handed out at full size again
+  auto reused = pool->acquire();
+  EXPECT_EQ(reused.begin(), raw);
+  EXPECT_EQ(reused.size(), 16);
+}
+
+TEST(PacketPoolTest, ExhaustedPoolReturnsEmptyHandle) {
+  auto pool = audio::packet_pool_t::make(1, 16);
+
+  auto packet = pool->acquire();
+  EXPECT_FALSE(pool->acquire());
+}
+
+TEST(PacketPoolTest, PacketsOutliveThePool) {
+  auto pool = audio::packet_pool_t::make(1, 16);
+
+  auto packet = pool->acquire();
+  pool.reset();
+
+  packet.begin()[0] = 42;
+  EXPECT_EQ(packet.begin()[0], 42);
+}
+
+TEST(AudioBuffersTest, SteadyStateDoesNotAllocate) {
+  constexpr int packet_duration = 5;
+  auto stream = audio::stream_configs[audio::STEREO];
+  auto frame_size = packet_duration * stream.sampleRate / 1000;
+
+  // The encoder of a capture pipeline, handing packets to two sessions like it does
+  audio::sample_ring_t ring {4, (std::size_t) (frame_size * stream.channelCount)};
+  audio::packet_encoder_t encoder {stream, frame_size, packet_duration};
+  safe::queue_t<audio::packet_t> packets {32};
+  int sessions[2];
+
+  // Tone then digital silence, so both encoded and recycled silent packets are sent
+  auto stream_frame = [&](int n) {
+    auto &frame = ring.write_frame();
+    for (auto &sample : frame) {
+      sample = (n / 100) % 2 ? 0.0f : (n % 100) / 100.0f;
+    }
+    ring.commit(std::chrono::steady_clock::now());
+
+    auto packet = encoder.encode(ring);
+    if (!packet || !*packet) {
+      return false;
+    }
+
+    for (auto &session : sessions) {
+      packets.raise(&session, *packet);
+    }
+    packet.reset();
+
+    // The broadcast thread takes the packets of both sessions
+    for (auto &session : sessions) {
+      auto sent = packets.pop();
+      if (!sent || sent->first != &session || !sent->second.size()) {
+        return false;
+      }
+    }
+
+    return true;
+  };
+
+  // Let containers reach their steady state capacity
+  for (int x = 0; x < 200; ++x) {
+    ASSERT_TRUE(stream_frame(x));
+  }
+
+  count_allocations = true;
+  bool ok = true;
+  for (int x = 0; x < 1000; ++x) {
+    ok = stream_frame(x) && ok;
+  }
+  count_allocations = false;
+
+  EXPECT_TRUE(ok);
+  EXPECT_FALSE(encoder.failed());
+  EXPECT_EQ(allocations, 0);
+}
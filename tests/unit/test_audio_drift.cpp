@@ -0,0 +1,112 @@
+/**
+ * @file tests/unit/test_audio_drift.cpp
+ * @brief Test src/audio_drift.*.
+ */
+#include "../tests_common.h"
+
+#include <cmath>
+#include <numbers>
+#include <src/audio_drift.h>
+
+using namespace std::literals;
+
+namespace {
+  constexpr std::uint32_t sample_rate = 48000;
+  constexpr std::size_t frame_size = 240;
+
+  /**
+   * @brief Feed the tracker a device running `ppm` fast, with some timestamp jitter.
+   */
+  void feed(audio::drift_tracker_t &drift, double ppm, double seconds) {
+    auto start = std::chrono::steady_clock::time_point {} + 1h;
+    auto frame_duration = (double) frame_size / sample_rate / (1 + ppm / 1e6);
+
+    for (int x = 0; x < seconds / frame_duration; ++x) {
+      auto jitter = std::chrono::microseconds((x * 7919) % 500);
+      auto capture_time = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(x * frame_duration)) + jitter;
+
+      drift.update(capture_time, frame_size);
+    }
+  }
+}  // namespace
+
+TEST(DriftTrackerTest, MeasuresDeviceDrift) {
+  audio::drift_tracker_t drift {sample_rate};
+  feed(drift, 150, 60);
+
+  EXPECT_NEAR(drift.drift_ppm(), 150, 10);
+
+  // A fast device needs fewer output samples per captured sample
+  EXPECT_LT(drift.ratio(), 1);
+  EXPECT_NEAR(drift.ratio(), 1 / (1 + 150e-6), 50e-6);
+}
+
+TEST(DriftTrackerTest, NoCorrectionDuringWarmup) {
+  audio::drift_tracker_t drift {sample_rate};
+  feed(drift, 150, 1);
+
+  EXPECT_EQ(drift.ratio(), 1);
+}
+
+TEST(DriftTrackerTest, ResetsOnDiscontinuity) {
+  audio::drift_tracker_t drift {sample_rate};
+  feed(drift, -200, 10);
+  EXPECT_GT(drift.ratio(), 1);
+
+  // A capture gap of a few seconds must not be mistaken for drift
+  auto later = std::chrono::steady_clock::time_point {} + 2h;
+  drift.update(later, frame_size);
+  EXPECT_EQ(drift.drift_ppm(), 0);
+  EXPECT_EQ(drift.ratio(), 1);
+}
+
+TEST(ResamplerTest, PassesSamplesThroughAtUnityRatio) {
+  audio::resampler_t resampler {2, frame_size};
+
+  std::vector<float> in(frame_size * 2);
+  std::vector<float> out(frame_size * 2);
+  for (int x = 0; x < 3; ++x) {
+    for (std::size_t y = 0; y < in.size(); ++y) {
+      in[y] = x * 1000 + y;
+    }
+
+    resampler.push(in);
+    ASSERT_TRUE(resampler.pop(out));
+    EXPECT_EQ(in, out);
+    EXPECT_FALSE(resampler.pop(out));
+  }
+}
+
+TEST(ResamplerTest, FollowsTheRatio) {
+  constexpr int frames_in = 2000;
+  audio::resampler_t resampler {1, frame_size};
+  resampler.set_ratio(0.999);
+
+  std::vector<float> in(frame_size);
+  std::vector<float> out(frame_size);
+  int frames_out = 0;
+  float previous = 0;
+  double phase = 0;
+  float max_jump = 0;
+
+  for (int x = 0; x < frames_in; ++x) {
+    for (auto &sample : in) {
+      sample = std::sin(phase);
+      phase += 2 * std::numbers::pi * 440 / sample_rate;
+    }
+
+    resampler.push(in);
+    while (resampler.pop(out)) {
+      ++frames_out;
+      for (auto sample : out) {
+        max_jump = std::max(max_jump, std::abs(sample - previous));
+        previous = sample;
+      }
+    }
+  }
+
+  EXPECT_NEAR(frames_out, frames_in * 0.999, 2);
+
+  // A 440Hz sine moves at most ~0.058 between samples, anything larger is a glitch
+  EXPECT_LT(max_jump, 0.06f);
+}
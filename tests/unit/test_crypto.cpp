@@ -0,0 +1,146 @@
+/**
+ * @file tests/unit/test_crypto.cpp
+ * @brief Test src/crypto.*.
+ */
+#include "../tests_common.h"
+
+#include <atomic>
+#include <chrono>
+#include <src/crypto.h>
+#include <thread>
+
+using namespace std::literals;
+
+namespace {
+  /**
+   * @brief Client certificates, like the ones Moonlight generates, with small keys to keep the test fast.
+   */
+  const std::vector<crypto::creds_t> &client_creds() {
+    static const auto creds = []() {
+      std::vector<crypto::creds_t> creds;
+      for (int x = 0; x < 1001; ++x) {
+        creds.emplace_back(crypto::gen_creds("NVIDIA GameStream Client"sv, 512));
+      }
+      return creds;
+    }();
+
+    return creds;
+  }
+
+  void pair(crypto::cert_chain_t &chain, std::size_t clients) {
+    for (std::size_t x = 0; x < clients; ++x) {
+      chain.add(crypto::x509(client_creds()[x].x509));
+    }
+  }
+}  // namespace
+
+TEST(CertChainTest, VerifiesPairedClients) {
+  crypto::cert_chain_t chain;
+  pair(chain, 3);
+
+  for (std::size_t x = 0; x < 3; ++x) {
+    auto cert = crypto::x509(client_creds()[x].x509);
+    EXPECT_EQ(chain.verify(cert.get()), nullptr);
+  }
+}
+
+TEST(CertChainTest, RejectsUnpairedClients) {
+  crypto::cert_chain_t chain;
+
+  auto cert = crypto::x509(client_creds()[3].x509);
+  EXPECT_NE(chain.verify(cert.get()), nullptr);
+
+  pair(chain, 3);
+  EXPECT_NE(chain.verify(cert.get()), nullptr);
+
+  chain.clear();
+  auto paired = crypto::x509(client_creds()[0].x509);
+  EXPECT_NE(chain.verify(paired.get()), nullptr);
+}
+
+TEST(CertChainTest, AssignReplacesAllClients) {
+  crypto::cert_chain_t chain;
+  pair(chain, 2);
+
+  std::vector<crypto::x509_t> certs;
+  certs.emplace_back(crypto::x509(client_creds()[1].x509));
+  certs.emplace_back(crypto::x509(client_creds()[2].x509));
+  chain.assign(std::move(certs));
+
+  auto unpaired = crypto::x509(client_creds()[0].x509);
+  auto kept = crypto::x509(client_creds()[1].x509);
+  auto added = crypto::x509(client_creds()[2].x509);
+  EXPECT_NE(chain.verify(unpaired.get()), nullptr);
+  EXPECT_EQ(chain.verify(kept.get()), nullptr);
+  EXPECT_EQ(chain.verify(added.get()), nullptr);
+}
+
+TEST(CertChainTest, VerifiesWhileClientsChange) {
+  crypto::cert_chain_t chain;
+  pair(chain, 4);
+
+  // Clients are paired and unpaired from the web UI while requests are verified
+  std::atomic_bool done {false};
+  std::thread changes {[&]() {
+    for (int x = 0; x < 200; ++x) {
+      chain.clear();
+      pair(chain, 4);
+
+      std::vector<crypto::x509_t> certs;
+      certs.emplace_back(crypto::x509(client_creds()[0].x509));
+      chain.assign(std::move(certs));
+    }
+    done = true;
+  }};
+
+  // The first client stays paired, except for the moment between clear() and add()
+  auto cert = crypto::x509(client_creds()[0].x509);
+  auto unpaired = crypto::x509(client_creds()[5].x509);
+  while (!done) {
+    chain.verify(cert.get());
+    EXPECT_NE(chain.verify(unpaired.get()), nullptr);
+  }
+  changes.join();
+
+  EXPECT_EQ(chain.verify(cert.get()), nullptr);
+}
+
+TEST(CertChainTest, FingerprintIdentifiesCertificate) {
+  auto cert = crypto::x509(client_creds()[0].x509);
+  auto same = crypto::x509(client_creds()[0].x509);
+  auto other = crypto::x509(client_creds()[1].x509);
+
+  EXPECT_EQ(crypto::fingerprint(cert.get()), crypto::fingerprint(same.get()));
+  EXPECT_NE(crypto::fingerprint(cert.get()), crypto::fingerprint(other.get()));
+}
+
+TEST(CertChainTest, VerificationBenchmark) {
+  constexpr int rounds = 200;
+
+  for (std::size_t clients : {1, 100, 1000}) {
+    crypto::cert_chain_t chain;
+    pair(chain, clients);
+
+    // The most recently paired client is the worst case for a linear search
+    auto paired = crypto::x509(client_creds()[clients - 1].x509);
+    auto unpaired = crypto::x509(client_creds()[1000].x509);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int x = 0; x < rounds; ++x) {
+      ASSERT_EQ(chain.verify(paired.get()), nullptr);
+      ASSERT_NE(chain.verify(unpaired.get()), nullptr);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    BOOST_LOG(tests) << clients << " paired clients: "sv
+                     << std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() / (2 * rounds) << "us per verification"sv;
+  }
+}
+
+TEST(ConstantTimeEqualTest, ComparesContentAndLength) {
+  EXPECT_TRUE(crypto::constant_time_equal("secret"sv, "secret"sv));
+  EXPECT_TRUE(crypto::constant_time_equal(""sv, ""sv));
+  EXPECT_FALSE(crypto::constant_time_equal("secret"sv, "secreT"sv));
+  EXPECT_FALSE(crypto::constant_time_equal("secret"sv, "secret2"sv));
+  EXPECT_FALSE(crypto::constant_time_equal("secret"sv, ""sv));
+}
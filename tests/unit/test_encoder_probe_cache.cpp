@@ -0,0 +1,87 @@
+/**
+ * @file tests/unit/test_encoder_probe_cache.cpp
+ * @brief Test src/encoder_probe_cache.*.
+ */
+#include "../tests_common.h"
+
+#include <fstream>
+#include <thread>
+#include <src/encoder_probe_cache.h>
+
+namespace {
+  struct EncoderProbeCacheTest: testing::Test {
+    void SetUp() override {
+      file = std::filesystem::temp_directory_path() / ("encoder_probe_cache_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()) + ".json");
+      std::filesystem::remove(file);
+    }
+
+    void TearDown() override {
+      std::filesystem::remove(file);
+    }
+
+    std::filesystem::path file;
+  };
+
+  const video::encoder_probe_cache_t::entry_t nvenc_entry {true, "10011", "10111", "00000"};
+}  // namespace
+
+TEST_F(EncoderProbeCacheTest, PersistsEntries) {
+  auto key = video::encoder_probe_cache_t::make_key({"nvenc", "driver 1"});
+
+  {
+    video::encoder_probe_cache_t cache {file};
+    EXPECT_FALSE(cache.get(key));
+    cache.put(key, nvenc_entry);
+  }
+
+  video::encoder_probe_cache_t cache {file};
+  auto entry = cache.get(key);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(*entry, nvenc_entry);
+
+  // A different driver doesn't reuse the entry
+  EXPECT_FALSE(cache.get(video::encoder_probe_cache_t::make_key({"nvenc", "driver 2"})));
+}
+
+TEST_F(EncoderProbeCacheTest, KeysDontCollide) {
+  EXPECT_NE(video::encoder_probe_cache_t::make_key({"a;b", "c"}), video::encoder_probe_cache_t::make_key({"a", "b;c"}));
+  EXPECT_NE(video::encoder_probe_cache_t::make_key({"ab", ""}), video::encoder_probe_cache_t::make_key({"a", "b"}));
+}
+
+TEST_F(EncoderProbeCacheTest, DropsOldestEntries) {
+  video::encoder_probe_cache_t cache {file, 2};
+
+  cache.put("a", nvenc_entry);
+  cache.put("b", nvenc_entry);
+
+  // Make sure "a" is strictly older than the refreshed "b"
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  cache.put("b", nvenc_entry);
+  cache.put("c", nvenc_entry);
+
+  EXPECT_FALSE(cache.get("a"));
+  EXPECT_TRUE(cache.get("b"));
+  EXPECT_TRUE(cache.get("c"));
+}
+
+TEST_F(EncoderProbeCacheTest, IgnoresCorruptFile) {
+  std::ofstream {file} << "{ not json";
+
+  video::encoder_probe_cache_t cache {file};
+  EXPECT_FALSE(cache.get("nvenc"));
+
+  // Overwrites the corrupt file
+  cache.put("nvenc", nvenc_entry);
+  video::encoder_probe_cache_t reloaded {file};
+  EXPECT_TRUE(reloaded.get("nvenc"));
+}
+
+TEST_F(EncoderProbeCacheTest, ClearRemovesFile) {
+  video::encoder_probe_cache_t cache {file};
+  cache.put("nvenc", nvenc_entry);
+  ASSERT_TRUE(std::filesystem::exists(file));
+
+  cache.clear();
+  EXPECT_FALSE(cache.get("nvenc"));
+  EXPECT_FALSE(std::filesystem::exists(file));
+}
@@ -0,0 +1,42 @@
+/**
+ * @file tests/unit/test_events.cpp
+ * @brief Test src/events.*.
+ */
+#include "../tests_common.h"
+
+#include <src/events.h>
+
+TEST(EventsTest, DeliversToEverySubscriber) {
+  std::vector<events::event_e> first, second;
+  auto first_subscription = events::subscribe([&first](events::event_e event) {
+    first.emplace_back(event);
+  });
+  auto second_subscription = events::subscribe([&second](events::event_e event) {
+    second.emplace_back(event);
+  });
+
+  events::publish(events::event_e::session_started);
+  events::publish(events::event_e::app_exited);
+
+  std::vector expected {events::event_e::session_started, events::event_e::app_exited};
+  EXPECT_EQ(first, expected);
+  EXPECT_EQ(second, expected);
+}
+
+TEST(EventsTest, StopsWhenSubscriptionIsDestroyed) {
+  int received = 0;
+  auto subscription = events::subscribe([&received](events::event_e) {
+    ++received;
+  });
+
+  events::publish(events::event_e::client_paired);
+  subscription.reset();
+  events::publish(events::event_e::client_unpaired);
+
+  EXPECT_EQ(received, 1);
+}
+
+TEST(EventsTest, NamesEvents) {
+  EXPECT_EQ(events::to_string(events::event_e::session_stopped), "session_stopped");
+  EXPECT_EQ(events::to_string(events::event_e::config_reloaded), "config_reloaded");
+}
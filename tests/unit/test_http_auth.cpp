@@ -1,15 +1,19 @@
 #include "src/http_auth.h"
 #include "src/httpcommon.h"
+#include "src/logging.h"
 
+#include <atomic>
 #include <boost/property_tree/ptree.hpp>
 #include <chrono>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <nlohmann/json.hpp>
 #include <sstream>
+#include <thread>
 
 using namespace confighttp;
 using namespace testing;
+using namespace std::literals;
 namespace pt = boost::property_tree;
 
 class MockApiTokenManagerDependencies {
@@ -763,3 +767,172 @@ TEST_F(ApiTokenManagerTest, given_scopes_with_empty_methods_array_when_creating_
   EXPECT_TRUE(token_info.path_methods.contains("/api/data"));
   EXPECT_TRUE(token_info.path_methods.at("/api/data").empty());
 }
+
+TEST_F(ApiTokenManagerTest, given_verified_token_when_authenticating_again_then_should_not_hash_it_again) {
+  // Given: A token that was just verified
+  EXPECT_CALL(*mock_deps, hash("valid_token"))
+    .Times(1)
+    .WillRepeatedly(Return("token_hash_123"));
+
+  std::map<std::string, std::set<std::string, std::less<>>, std::less<>> path_methods;
+  path_methods["/api/data"] = {"GET"};
+  ApiTokenInfo token_info {"token_hash_123", path_methods, "test_user", test_time};
+  InjectToken(token_info);
+  EXPECT_TRUE(manager->authenticate_token("valid_token", "/api/data", "GET"));
+
+  // When & Then: Repeated requests are answered from the verified credentials, scopes still apply
+  EXPECT_TRUE(manager->authenticate_token("valid_token", "/api/data", "GET"));
+  EXPECT_FALSE(manager->authenticate_token("valid_token", "/api/data", "POST"));
+  EXPECT_FALSE(manager->authenticate_token("valid_token", "/api/other", "GET"));
+}
+
+TEST_F(ApiTokenManagerTest, given_verified_token_when_revoked_then_should_be_rejected_immediately) {
+  // Given: A token that was just verified
+  EXPECT_CALL(*mock_deps, hash("valid_token"))
+    .WillRepeatedly(Return("token_hash_123"));
+
+  std::map<std::string, std::set<std::string, std::less<>>, std::less<>> path_methods;
+  path_methods["/api/data"] = {"GET"};
+  ApiTokenInfo token_info {"token_hash_123", path_methods, "test_user", test_time};
+  InjectToken(token_info);
+  EXPECT_TRUE(manager->authenticate_token("valid_token", "/api/data", "GET"));
+
+  EXPECT_CALL(*mock_deps, file_exists(_))
+    .WillOnce(Return(false));
+  EXPECT_CALL(*mock_deps, write_json(_, _))
+    .Times(1);
+
+  // When: Revoking it
+  EXPECT_TRUE(manager->revoke_api_token_by_hash("token_hash_123"));
+
+  // Then: It is no longer accepted
+  EXPECT_FALSE(manager->authenticate_token("valid_token", "/api/data", "GET"));
+}
+
+TEST_F(ApiTokenManagerTest, given_token_with_invalid_regex_when_authenticating_then_should_ignore_that_scope) {
+  // Given: Token with one invalid and one valid scope
+  EXPECT_CALL(*mock_deps, hash("valid_token"))
+    .WillRepeatedly(Return("token_hash_123"));
+
+  std::map<std::string, std::set<std::string, std::less<>>, std::less<>> path_methods;
+  path_methods["/api/(data"] = {"GET"};
+  path_methods["/api/apps"] = {"GET"};
+  ApiTokenInfo token_info {"token_hash_123", path_methods, "test_user", test_time};
+  InjectToken(token_info);
+
+  // When & Then: The valid scope still works
+  EXPECT_TRUE(manager->authenticate_token("valid_token", "/api/apps", "GET"));
+  EXPECT_FALSE(manager->authenticate_token("valid_token", "/api/(data", "GET"));
+}
+
+TEST_F(ApiTokenManagerTest, given_concurrent_requests_when_authenticating_then_should_authorize_all_of_them) {
+  // Given: A manager with real hashing and a token covering a few scopes
+  auto bench_deps = ApiTokenManager::make_default_dependencies();
+  bench_deps.file_exists = [](const std::string &) {
+    return false;
+  };
+  bench_deps.write_json = [](const std::string &, const pt::ptree &) {};
+  ApiTokenManager bench_manager(bench_deps);
+
+  nlohmann::json scopes = nlohmann::json::array();
+  for (const auto *path : {"/api/apps", "/api/clients/list", "/api/logs", "/api/config", "/api/apps/[0-9]+"}) {
+    scopes.push_back({{"path", path}, {"methods", {"GET", "POST"}}});
+  }
+  auto token = bench_manager.create_api_token(scopes, "test_user");
+  ASSERT_TRUE(token.has_value());
+  auto header = "Bearer " + *token;
+
+  constexpr int rounds = 20000;
+  for (int threads : {1, 2, 4, 8}) {
+    std::atomic<int> authorized = 0;
+
+    // When: Every thread hammers the API with the same token
+    auto start = std::chrono::steady_clock::now();
+    {
+      std::vector<std::jthread> workers;
+      for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+          int count = 0;
+          for (int x = 0; x < rounds; ++x) {
+            count += bench_manager.authenticate_bearer(header, "/api/apps/42", "GET");
+          }
+          authorized += count;
+        });
+      }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // Then: Every request is authorized
+    EXPECT_EQ(authorized, threads * rounds);
+
+    BOOST_LOG(tests) << threads << " threads: "sv
+                     << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / (threads * rounds) << "ns per request, "sv
+                     << (std::int64_t) (threads * rounds / std::chrono::duration<double>(elapsed).count()) << " requests/s"sv;
+  }
+}
+
+class SessionTokenManagerTest: public Test {
+protected:
+  void SetUp() override {
+    now = std::chrono::system_clock::now();
+
+    SessionTokenManagerDependencies deps;
+    deps.now = [this]() {
+      return now;
+    };
+    deps.rand_alphabet = [this](std::size_t length) {
+      return std::string(length, (char) ('a' + next_token++));
+    };
+    deps.hash = [this](const std::string &input) {
+      ++hashes;
+      return "hash_" + input;
+    };
+    manager = std::make_unique<SessionTokenManager>(deps);
+  }
+
+  std::chrono::system_clock::time_point now;
+  int next_token = 0;
+  int hashes = 0;
+  std::unique_ptr<SessionTokenManager> manager;
+};
+
+TEST_F(SessionTokenManagerTest, given_new_session_when_validating_then_should_be_valid) {
+  auto token = manager->generate_session_token("test_user");
+
+  EXPECT_TRUE(manager->validate_session_token(token));
+  EXPECT_EQ(manager->get_username_for_token(token), "test_user");
+  EXPECT_EQ(manager->session_count(), 1);
+  EXPECT_FALSE(manager->validate_session_token("unknown"));
+}
+
+TEST_F(SessionTokenManagerTest, given_verified_session_when_validating_again_then_should_not_hash_it_again) {
+  auto token = manager->generate_session_token("test_user");
+  EXPECT_TRUE(manager->validate_session_token(token));
+
+  auto hashed = hashes;
+  EXPECT_TRUE(manager->validate_session_token(token));
+  EXPECT_EQ(hashes, hashed);
+}
+
+TEST_F(SessionTokenManagerTest, given_verified_session_when_revoked_then_should_be_invalid) {
+  auto token = manager->generate_session_token("test_user");
+  auto other = manager->generate_session_token("test_user");
+  EXPECT_TRUE(manager->validate_session_token(token));
+
+  manager->revoke_session_token(token);
+
+  EXPECT_FALSE(manager->validate_session_token(token));
+  EXPECT_TRUE(manager->validate_session_token(other));
+  EXPECT_EQ(manager->session_count(), 1);
+}
+
+TEST_F(SessionTokenManagerTest, given_expired_session_when_validating_then_should_be_invalid_and_removed) {
+  auto token = manager->generate_session_token("test_user");
+  EXPECT_TRUE(manager->validate_session_token(token));
+
+  now += config::sunshine.session_token_ttl + std::chrono::seconds(1);
+
+  EXPECT_FALSE(manager->validate_session_token(token));
+  EXPECT_FALSE(manager->get_username_for_token(token));
+  EXPECT_EQ(manager->session_count(), 0);
+}
@@ -106,3 +106,38 @@ INSTANTIATE_TEST_SUITE_P(
     std::make_tuple("symbols&=%\"", "symbols%26%3D%25%22")
   )
 );
+
+struct ParseRangeTest: testing::TestWithParam<std::tuple<std::string, std::uintmax_t, std::optional<std::tuple<std::uintmax_t, std::uintmax_t, bool>>>> {};
+
+TEST_P(ParseRangeTest, Parse) {
+  const auto &[header, size, expected] = GetParam();
+  auto range = http::parse_range(header, size);
+
+  ASSERT_EQ(range.has_value(), expected.has_value());
+  if (range) {
+    EXPECT_EQ(std::make_tuple(range->first, range->last, range->satisfiable), *expected);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+  ParseRangeTests,
+  ParseRangeTest,
+  testing::Values(
+    std::make_tuple("bytes=0-", 100, std::make_tuple(0, 99, true)),
+    std::make_tuple("bytes=40-", 100, std::make_tuple(40, 99, true)),
+    std::make_tuple("bytes=40-59", 100, std::make_tuple(40, 59, true)),
+    std::make_tuple("bytes=40-500", 100, std::make_tuple(40, 99, true)),
+    std::make_tuple("bytes=-10", 100, std::make_tuple(90, 99, true)),
+    std::make_tuple("bytes=-500", 100, std::make_tuple(0, 99, true)),
+    // Nothing new past the end of the resource
+    std::make_tuple("bytes=100-", 100, std::make_tuple(0, 0, false)),
+    std::make_tuple("bytes=0-", 0, std::make_tuple(0, 0, false)),
+    std::make_tuple("bytes=-0", 100, std::make_tuple(0, 0, false)),
+    // Ignored, the whole resource is sent
+    std::make_tuple("bytes=59-40", 100, std::nullopt),
+    std::make_tuple("bytes=0-10,20-30", 100, std::nullopt),
+    std::make_tuple("bytes=a-", 100, std::nullopt),
+    std::make_tuple("bytes=-", 100, std::nullopt),
+    std::make_tuple("items=0-", 100, std::nullopt)
+  )
+);
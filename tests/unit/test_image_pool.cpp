@@ -0,0 +1,133 @@
+/**
+ * @file tests/unit/test_image_pool.cpp
+ * @brief Test src/image_pool.*.
+ */
+#include "../tests_common.h"
+
+#include <src/image_pool.h>
+#include <thread>
+
+using namespace std::literals;
+
+namespace {
+  std::shared_ptr<video::image_pool_t> make_pool(std::size_t capacity, int &allocations, std::chrono::milliseconds trim_timeout = 3s) {
+    return video::image_pool_t::make(capacity, [&allocations]() {
+      ++allocations;
+      return std::make_shared<platf::img_t>();
+    }, trim_timeout);
+  }
+}  // namespace
+
+TEST(ImagePoolTest, ReusesReleasedImages) {
+  int allocations = 0;
+  auto pool = make_pool(2, allocations);
+
+  auto img = pool->acquire(0ms);
+  ASSERT_TRUE(img);
+  auto raw = img.get();
+  img.reset();
+
+  EXPECT_EQ(pool->free_count(), 1);
+
+  img = pool->acquire(0ms);
+  EXPECT_EQ(img.get(), raw);
+  EXPECT_EQ(allocations, 1);
+}
+
+TEST(ImagePoolTest, TimesOutWhenExhausted) {
+  int allocations = 0;
+  auto pool = make_pool(2, allocations);
+
+  auto img1 = pool->acquire(0ms);
+  auto img2 = pool->acquire(0ms);
+  ASSERT_TRUE(img1 && img2);
+
+  EXPECT_FALSE(pool->acquire(5ms));
+  EXPECT_EQ(pool->stall_count(), 1);
+  EXPECT_GE(pool->total_wait(), 5ms);
+  EXPECT_EQ(allocations, 2);
+}
+
+TEST(ImagePoolTest, WakesUpWhenImageIsReturned) {
+  int allocations = 0;
+  auto pool = make_pool(1, allocations);
+
+  auto img = pool->acquire(0ms);
+  auto raw = img.get();
+
+  std::thread consumer {[img = std::move(img)]() mutable {
+    std::this_thread::sleep_for(10ms);
+    img.reset();
+  }};
+
+  auto next = pool->acquire(10s);
+  consumer.join();
+
+  ASSERT_TRUE(next);
+  EXPECT_EQ(next.get(), raw);
+  EXPECT_LT(pool->total_wait(), 5s);
+}
+
+TEST(ImagePoolTest, ClearDropsImagesInFlight) {
+  int allocations = 0;
+  auto pool = make_pool(1, allocations);
+
+  auto img = pool->acquire(0ms);
+  pool->clear();
+
+  // The image from before clear() must not come back
+  img.reset();
+  EXPECT_EQ(pool->free_count(), 0);
+
+  EXPECT_TRUE(pool->acquire(0ms));
+  EXPECT_EQ(allocations, 2);
+}
+
+TEST(ImagePoolTest, WaitsBeforeFailingWhenAllocationFails) {
+  int attempts = 0;
+  auto pool = video::image_pool_t::make(2, [&attempts]() {
+    ++attempts;
+    return std::shared_ptr<platf::img_t> {};
+  });
+
+  // The caller retries in a loop, it must not spin while allocation keeps failing
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(pool->acquire(20ms));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 20ms);
+  EXPECT_EQ(attempts, 1);
+  EXPECT_EQ(pool->allocated(), 0);
+}
+
+TEST(ImagePoolTest, TrimsUnusedImagesAfterTimeout) {
+  int allocations = 0;
+  auto pool = make_pool(4, allocations, 20ms);
+
+  {
+    auto img1 = pool->acquire(0ms);
+    auto img2 = pool->acquire(0ms);
+    auto img3 = pool->acquire(0ms);
+  }
+  EXPECT_EQ(pool->allocated(), 3);
+
+  // Still within the timeout, the burst of three images is retained
+  pool->acquire(0ms);
+  EXPECT_EQ(pool->allocated(), 3);
+
+  std::this_thread::sleep_for(30ms);
+
+  // Only a single image has been needed since
+  pool->acquire(0ms);
+  EXPECT_EQ(pool->allocated(), 1);
+}
+
+TEST(ImagePoolTest, ImagesOutliveThePool) {
+  int allocations = 0;
+  auto pool = make_pool(1, allocations);
+
+  auto img = pool->acquire(0ms);
+  pool.reset();
+
+  // Releasing after the pool is gone must not touch it
+  img.reset();
+  SUCCEED();
+}
@@ -45,3 +45,25 @@ TEST_P(LogLevelsTest, PutMessage) {
 
   ASSERT_TRUE(log_checker::line_contains(log_file, test_message));
 }
+
+TEST(LogListenerTest, ReceivesFormattedLines) {
+  std::vector<std::string> lines;
+  auto listener = logging::listen([&lines](std::string_view line) {
+    lines.emplace_back(line);
+  });
+
+  BOOST_LOG(info) << "first line";
+  BOOST_LOG(info) << "second line";
+  logging::log_flush();
+
+  ASSERT_EQ(lines.size(), 2);
+  EXPECT_TRUE(lines[0].ends_with("Info: first line"));
+  EXPECT_TRUE(lines[1].ends_with("Info: second line"));
+
+  // Lines are only delivered while the listener is alive
+  listener.reset();
+  BOOST_LOG(info) << "third line";
+  logging::log_flush();
+
+  EXPECT_EQ(lines.size(), 2);
+}
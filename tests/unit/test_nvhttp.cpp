@@ -0,0 +1,151 @@
+/**
+ * @file tests/unit/test_nvhttp.cpp
+ * @brief Test the cached src/nvhttp.cpp responses.
+ */
+#include "../tests_common.h"
+
+#include <src/config.h>
+#include <src/crypto.h>
+#include <src/nvhttp.h>
+#include <src/process.h>
+#include <src/video.h>
+
+using namespace std::literals;
+
+struct NvhttpCacheTest: testing::Test {
+  void SetUp() override {
+    previous_apps = proc::proc.get_apps();
+    previous_hevc_mode = video::active_hevc_mode;
+  }
+
+  void TearDown() override {
+    proc::proc.update_apps(std::move(previous_apps), boost::process::v1::environment {});
+    video::active_hevc_mode = previous_hevc_mode;
+  }
+
+  static void set_apps(std::initializer_list<std::string> names) {
+    std::vector<proc::ctx_t> apps;
+    for (auto &name : names) {
+      proc::ctx_t app {};
+      app.name = name;
+      app.id = std::to_string(apps.size() + 1);
+      apps.emplace_back(std::move(app));
+    }
+
+    proc::proc.update_apps(std::move(apps), boost::process::v1::environment {});
+  }
+
+  std::vector<proc::ctx_t> previous_apps;
+  int previous_hevc_mode;
+};
+
+TEST_F(NvhttpCacheTest, ApplistIsReusedUntilAppsChange) {
+  set_apps({"Desktop"});
+
+  auto first = nvhttp::applist_xml();
+  EXPECT_EQ(nvhttp::applist_xml(), first);
+  EXPECT_NE(first->find("<AppTitle>Desktop</AppTitle>"), std::string::npos);
+
+  set_apps({"Desktop", "Steam Big Picture"});
+  auto second = nvhttp::applist_xml();
+  EXPECT_NE(second, first);
+  EXPECT_NE(second->find("<AppTitle>Steam Big Picture</AppTitle>"), std::string::npos);
+
+  // HDR support is part of every app
+  video::active_hevc_mode = video::active_hevc_mode == 3 ? 1 : 3;
+  EXPECT_NE(nvhttp::applist_xml(), second);
+}
+
+TEST_F(NvhttpCacheTest, ServerinfoPatchesRequestValues) {
+  auto https = nvhttp::serverinfo_xml("01:23:45:67:89:ab", "192.168.1.20", 1);
+  EXPECT_NE(https.find("<mac>01:23:45:67:89:ab</mac>"), std::string::npos);
+  EXPECT_NE(https.find("<LocalIP>192.168.1.20</LocalIP>"), std::string::npos);
+  EXPECT_NE(https.find("<PairStatus>1</PairStatus>"), std::string::npos);
+
+  auto http = nvhttp::serverinfo_xml("00:00:00:00:00:00", "127.0.0.1", 0);
+  EXPECT_NE(http.find("<LocalIP>127.0.0.1</LocalIP>"), std::string::npos);
+  EXPECT_NE(http.find("<PairStatus>0</PairStatus>"), std::string::npos);
+  EXPECT_EQ(http.find("@@"), std::string::npos);
+}
+
+TEST_F(NvhttpCacheTest, ServerinfoIgnoresPlaceholdersInHostName) {
+  auto previous_name = config::nvhttp.sunshine_name;
+  config::nvhttp.sunshine_name = "@@mac@@ @@LocalIP@@ @@PairStatus@@";
+
+  auto xml = nvhttp::serverinfo_xml("01:23:45:67:89:ab", "192.168.1.20", 1);
+  config::nvhttp.sunshine_name = previous_name;
+
+  EXPECT_NE(xml.find("<hostname>@@mac@@ @@LocalIP@@ @@PairStatus@@</hostname>"), std::string::npos);
+  EXPECT_NE(xml.find("<mac>01:23:45:67:89:ab</mac>"), std::string::npos);
+  EXPECT_NE(xml.find("<LocalIP>192.168.1.20</LocalIP>"), std::string::npos);
+  EXPECT_NE(xml.find("<PairStatus>1</PairStatus>"), std::string::npos);
+}
+
+TEST_F(NvhttpCacheTest, CachedResponsesServeMoreRequests) {
+  constexpr int requests = 2000;
+  set_apps({"Desktop", "Steam Big Picture", "Game 1", "Game 2", "Game 3"});
+
+  auto requests_per_second = [](auto &&request) {
+    auto start = std::chrono::steady_clock::now();
+    for (int x = 0; x < requests; ++x) {
+      request(x);
+    }
+    return requests / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  // Changing the encoder capabilities on every request renders from scratch, like before caching
+  auto rendered = requests_per_second([](int x) {
+    video::active_hevc_mode = x % 2 ? 3 : 1;
+    nvhttp::serverinfo_xml("01:23:45:67:89:ab", "192.168.1.20", 1);
+    nvhttp::applist_xml();
+  });
+  auto cached = requests_per_second([](int) {
+    nvhttp::serverinfo_xml("01:23:45:67:89:ab", "192.168.1.20", 1);
+    nvhttp::applist_xml();
+  });
+
+  BOOST_LOG(tests) << "/serverinfo + /applist: "sv << (int) rendered << " requests/s rendered, "sv << (int) cached << " requests/s cached"sv;
+  EXPECT_GT(cached, rendered);
+}
+
+TEST(VerifiedPeersTest, UnpairingRejectsNextRequestOnOpenConnection) {
+  auto creds = crypto::gen_creds("NVIDIA GameStream Client"sv, 512);
+  crypto::cert_chain_t chain;
+  chain.add(crypto::x509(creds.x509));
+
+  nvhttp::verified_peers_t peers;
+  boost::asio::ip::tcp::endpoint endpoint {boost::asio::ip::make_address("192.168.1.20"), 50000};
+  int connection;
+  peers.add(endpoint, &connection, crypto::x509(creds.x509));
+
+  // Requests on the connection pass while the client is paired
+  EXPECT_EQ(peers.verify(endpoint, chain), nullptr);
+
+  // Unpairing rebuilds the chain without the client
+  chain.clear();
+  EXPECT_NE(peers.verify(endpoint, chain), nullptr);
+}
+
+TEST(VerifiedPeersTest, RejectsUnknownAndClosedConnections) {
+  auto creds = crypto::gen_creds("NVIDIA GameStream Client"sv, 512);
+  crypto::cert_chain_t chain;
+  chain.add(crypto::x509(creds.x509));
+
+  nvhttp::verified_peers_t peers;
+  boost::asio::ip::tcp::endpoint endpoint {boost::asio::ip::make_address("192.168.1.20"), 50000};
+  boost::asio::ip::tcp::endpoint other {boost::asio::ip::make_address("192.168.1.20"), 50001};
+  EXPECT_NE(peers.verify(endpoint, chain), nullptr);
+
+  int first;
+  int second;
+  peers.add(endpoint, &first, crypto::x509(creds.x509));
+  peers.add(endpoint, &second, crypto::x509(creds.x509));
+  EXPECT_NE(peers.verify(other, chain), nullptr);
+
+  // The first connection closing late doesn't remove the one that replaced it
+  peers.remove(endpoint, &first);
+  EXPECT_EQ(peers.verify(endpoint, chain), nullptr);
+
+  peers.remove(endpoint, &second);
+  EXPECT_NE(peers.verify(endpoint, chain), nullptr);
+}
@@ -0,0 +1,66 @@
+/**
+ * @file tests/unit/test_sse.cpp
+ * @brief Test src/sse.*.
+ */
+#include "../tests_common.h"
+
+#include <src/sse.h>
+
+using namespace std::literals;
+
+TEST(SseTest, FormatsEvents) {
+  EXPECT_EQ(sse::event("hello"sv), "data: hello\n\n");
+  EXPECT_EQ(sse::event("hello"sv, "log"sv), "event: log\ndata: hello\n\n");
+  EXPECT_EQ(sse::event(""sv), "data: \n\n");
+}
+
+TEST(SseTest, SplitsLinesIntoFields) {
+  // A line break inside the data must not end the event early
+  EXPECT_EQ(sse::event("a\nb\r\nc\rd"sv), "data: a\ndata: b\ndata: c\ndata: d\n\n");
+  EXPECT_EQ(sse::event("a\n"sv), "data: a\ndata: \n\n");
+}
+
+TEST(SseTest, FormatsComments) {
+  EXPECT_EQ(sse::comment("keep-alive"sv), ": keep-alive\n\n");
+}
+
+TEST(SseHubTest, PublishesToEveryClient) {
+  sse::hub_t hub;
+  EXPECT_TRUE(hub.empty());
+
+  std::string first, second;
+  hub.subscribe([&first](const std::string &chunk) {
+    first += chunk;
+    return true;
+  });
+  hub.subscribe([&second](const std::string &chunk) {
+    second += chunk;
+    return true;
+  });
+  EXPECT_FALSE(hub.empty());
+
+  hub.publish("a");
+  hub.publish("b");
+
+  EXPECT_EQ(first, "ab");
+  EXPECT_EQ(second, "ab");
+
+  hub.clear();
+  EXPECT_TRUE(hub.empty());
+}
+
+TEST(SseHubTest, DropsClientsThatAreGone) {
+  sse::hub_t hub;
+
+  int sent = 0;
+  hub.subscribe([&sent](const std::string &) {
+    return ++sent < 2;
+  });
+
+  hub.publish("a");
+  hub.publish("b");
+  EXPECT_TRUE(hub.empty());
+
+  hub.publish("c");
+  EXPECT_EQ(sent, 2);
+}
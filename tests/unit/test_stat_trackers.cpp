@@ -0,0 +1,51 @@
+/**
+ * @file tests/unit/test_stat_trackers.cpp
+ * @brief Test src/stat_trackers.*.
+ */
+#include "../tests_common.h"
+
+#include <src/stat_trackers.h>
+
+using namespace std::literals;
+
+TEST(LatencyHistogramTest, EmptyHistogramReportsZero) {
+  stat_trackers::latency_histogram histogram;
+
+  EXPECT_EQ(histogram.count(), 0);
+  EXPECT_EQ(histogram.mean(), 0us);
+  EXPECT_EQ(histogram.percentile(99), 0us);
+}
+
+TEST(LatencyHistogramTest, PercentilesStayWithinTheirBucket) {
+  stat_trackers::latency_histogram histogram;
+
+  for (int x = 0; x < 90; ++x) {
+    histogram.record(100us);
+  }
+  for (int x = 0; x < 10; ++x) {
+    histogram.record(5ms);
+  }
+
+  EXPECT_EQ(histogram.count(), 100);
+  EXPECT_EQ(histogram.mean(), 590us);
+
+  // 100us lands in [64, 128), 5ms in [4096, 8192)
+  EXPECT_GE(histogram.percentile(50), 64us);
+  EXPECT_LT(histogram.percentile(50), 128us);
+  EXPECT_GE(histogram.percentile(99), 4096us);
+  EXPECT_LE(histogram.percentile(99), 8192us);
+}
+
+TEST(LatencyHistogramTest, ClampsOutOfRangeDurations) {
+  stat_trackers::latency_histogram histogram;
+
+  histogram.record(-5us);
+  histogram.record(1h);
+
+  EXPECT_EQ(histogram.count(), 2);
+  EXPECT_EQ(histogram.percentile(0), 0us);
+  EXPECT_GE(histogram.percentile(100), 4s);
+
+  histogram.reset();
+  EXPECT_EQ(histogram.count(), 0);
+}
@@ -0,0 +1,222 @@
+/**
+ * @file tests/unit/test_task_pool.cpp
+ * @brief Test src/task_pool.h and src/thread_pool.h.
+ */
+#include "../tests_common.h"
+
+#include <atomic>
+#include <future>
+#include <numeric>
+#include <src/thread_pool.h>
+#include <vector>
+
+using namespace std::literals;
+
+TEST(TaskPoolTest, RunsTimersInDeadlineOrder) {
+  task_pool_util::TaskPool pool;
+  std::vector<int> order;
+
+  pool.pushDelayed([&order]() { order.push_back(3); }, -1ms);
+  pool.pushDelayed([&order]() { order.push_back(1); }, -3ms);
+  pool.pushDelayed([&order]() { order.push_back(2); }, -2ms);
+  pool.pushDelayed([&order]() { order.push_back(4); }, 1h);
+
+  while (auto task = pool.pop()) {
+    (*task)->run();
+  }
+
+  EXPECT_EQ(order, (std::vector<int> {1, 2, 3}));
+  EXPECT_TRUE(pool.next());
+  EXPECT_FALSE(pool.ready());
+}
+
+TEST(TaskPoolTest, CancelAndDelayFindTheirTimer) {
+  task_pool_util::TaskPool pool;
+  std::vector<int> order;
+
+  std::vector<task_pool_util::TaskPool::task_id_t> ids;
+  for (int x = 0; x < 100; ++x) {
+    ids.push_back(pool.pushDelayed([&order, x]() { order.push_back(x); }, -1ms * (100 - x)).task_id);
+  }
+
+  // Everything except 10 and 20 got cancelled, 20 now runs after 10
+  for (int x = 0; x < 100; ++x) {
+    if (x != 10 && x != 20) {
+      EXPECT_TRUE(pool.cancel(ids[x]));
+    }
+  }
+  EXPECT_FALSE(pool.cancel(ids[0]));
+
+  pool.delay(ids[10], -200ms);
+  pool.delay(ids[20], -300ms);
+
+  while (auto task = pool.pop()) {
+    (*task)->run();
+  }
+
+  EXPECT_EQ(order, (std::vector<int> {20, 10}));
+  EXPECT_FALSE(pool.next());
+}
+
+TEST(TaskPoolTest, RearmsManyTimers) {
+  constexpr int timers = 10000;
+  constexpr int rounds = 30;
+
+  task_pool_util::TaskPool pool;
+
+  std::vector<task_pool_util::TaskPool::task_id_t> ids;
+  for (int x = 0; x < timers; ++x) {
+    ids.push_back(pool.pushDelayed([]() {}, 1h + 1ms * x).task_id);
+  }
+
+  // Every round re-arms each timer like key repeat does: cancel, then push a new one
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < rounds; ++round) {
+    for (auto &id : ids) {
+      ASSERT_TRUE(pool.cancel(id));
+      id = pool.pushDelayed([]() {}, 1h + 33ms * round).task_id;
+    }
+  }
+  auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+  BOOST_LOG(tests) << "Re-armed "sv << timers << " timers "sv << rounds << " times in "sv << elapsed.count() << "ms"sv;
+}
+
+TEST(ThreadPoolTest, WakesUpForEarlierTimer) {
+  thread_pool_util::ThreadPool pool {1};
+  std::atomic_bool ran {false};
+
+  pool.pushDelayed([]() {}, 1h);
+  std::this_thread::sleep_for(10ms);
+
+  auto start = std::chrono::steady_clock::now();
+  auto timer = pool.pushDelayed([&ran]() { ran = true; }, 20ms);
+  timer.future.wait();
+
+  EXPECT_TRUE(ran);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 500ms);
+
+  pool.stop();
+  pool.join();
+}
+
+TEST(ThreadPoolTest, RunsTasksPushedFromWorkers) {
+  constexpr int tasks = 5000;
+  thread_pool_util::ThreadPool pool {4};
+  std::atomic<int> done {0};
+  std::promise<void> all_done;
+
+  // Everything is pushed from a worker, so it lands in its deque and the others must steal it
+  pool.post([&]() {
+    for (int x = 0; x < tasks; ++x) {
+      pool.post([&]() {
+        if (++done == tasks) {
+          all_done.set_value();
+        }
+      });
+    }
+  });
+
+  EXPECT_EQ(all_done.get_future().wait_for(10s), std::future_status::ready);
+  EXPECT_EQ(done, tasks);
+}
+
+TEST(ThreadPoolTest, RunsNestedPostsInOrder) {
+  thread_pool_util::ThreadPool pool {1};
+  std::vector<int> order;
+  std::promise<void> all_done;
+
+  pool.post([&]() {
+    for (int x = 0; x < 100; ++x) {
+      pool.post([&, x]() {
+        order.push_back(x);
+      });
+    }
+    pool.post([&]() {
+      all_done.set_value();
+    });
+  });
+
+  ASSERT_EQ(all_done.get_future().wait_for(10s), std::future_status::ready);
+
+  std::vector<int> expected(100);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(order, expected);
+}
+
+TEST(ThreadPoolTest, RunsExpiredTimersBeforeQueuedTasks) {
+  thread_pool_util::ThreadPool pool {1};
+  std::vector<int> order;
+  std::promise<void> all_done;
+
+  pool.post([&]() {
+    for (int x = 1; x <= 3; ++x) {
+      pool.post([&, x]() {
+        order.push_back(x);
+      });
+    }
+    pool.post([&]() {
+      all_done.set_value();
+    });
+
+    // Already expired when the task returns, so it runs before the tasks posted above
+    pool.pushDelayed([&order]() { order.push_back(0); }, -1ms);
+  });
+
+  ASSERT_EQ(all_done.get_future().wait_for(10s), std::future_status::ready);
+  EXPECT_EQ(order, (std::vector<int> {0, 1, 2, 3}));
+}
+
+TEST(ThreadPoolTest, AffinityHintsReturnResults) {
+  thread_pool_util::ThreadPool pool {3};
+
+  std::vector<std::future<int>> results;
+  for (int x = 0; x < 100; ++x) {
+    results.emplace_back(pool.pushAffine(x, [x]() { return x * 2; }));
+  }
+
+  for (int x = 0; x < 100; ++x) {
+    EXPECT_EQ(results[x].get(), x * 2);
+  }
+}
+
+TEST(ThreadPoolTest, ScalesWithWorkers) {
+  constexpr int tasks = 2000;
+  auto cores = std::thread::hardware_concurrency();
+  if (cores < 2) {
+    GTEST_SKIP() << "Needs at least two cores";
+  }
+
+  std::chrono::duration<double, std::milli> single_worker {};
+  for (unsigned threads = 1; threads <= cores; threads *= 2) {
+    thread_pool_util::ThreadPool pool {(int) threads};
+    std::atomic<int> done {0};
+    std::promise<void> all_done;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int x = 0; x < tasks; ++x) {
+      pool.post([&]() {
+        // Roughly 50us of work, about the size of an FEC block
+        volatile std::uint64_t sum = 0;
+        for (int y = 0; y < 20000; ++y) {
+          sum = sum + y;
+        }
+
+        if (++done == tasks) {
+          all_done.set_value();
+        }
+      });
+    }
+    ASSERT_EQ(all_done.get_future().wait_for(60s), std::future_status::ready);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+    BOOST_LOG(tests) << threads << " workers ran "sv << tasks << " tasks in "sv << elapsed.count() << "ms"sv;
+
+    if (threads == 1) {
+      single_worker = elapsed;
+    } else {
+      // Loose bound, two workers ideally take half the time
+      EXPECT_LT(elapsed, single_worker * 0.75) << threads << " workers";
+    }
+  }
+}
@@ -0,0 +1,133 @@
+/**
+ * @file tests/unit/test_thread_safe.cpp
+ * @brief Test src/thread_safe.h.
+ */
+#include "../tests_common.h"
+
+#include <src/thread_safe.h>
+#include <thread>
+
+TEST(SpscQueueTest, DeliversInOrderUntilFull) {
+  safe::spsc_queue_t<int> queue {2};
+
+  EXPECT_FALSE(queue.peek());
+
+  for (int x = 0; x < 2; ++x) {
+    auto slot = queue.back();
+    ASSERT_TRUE(slot);
+    *slot = x;
+    queue.push();
+  }
+  EXPECT_FALSE(queue.back());
+
+  EXPECT_EQ(*queue.peek(0), 0);
+  EXPECT_EQ(*queue.peek(1), 1);
+  EXPECT_FALSE(queue.peek(2));
+
+  queue.pop();
+  EXPECT_EQ(*queue.peek(), 1);
+  EXPECT_TRUE(queue.back());
+}
+
+TEST(SpscQueueTest, HandsOverAcrossThreads) {
+  constexpr int count = 10000;
+  safe::spsc_queue_t<int> queue {16};
+
+  std::thread producer {[&queue]() {
+    for (int x = 0; x < count;) {
+      if (auto slot = queue.back()) {
+        *slot = x++;
+        queue.push();
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }};
+
+  int expected = 0;
+  while (expected < count) {
+    if (auto element = queue.peek()) {
+      ASSERT_EQ(*element, expected++);
+      queue.pop();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  producer.join();
+}
+
+TEST(SpscSpillQueueTest, DeliversEveryElementInOrderWhenFull) {
+  constexpr int count = 100;
+  safe::spsc_spill_queue_t<int> queue {4};
+
+  for (int x = 0; x < count; ++x) {
+    *queue.back() = x;
+    queue.push();
+  }
+
+  for (int x = 0; x < count; ++x) {
+    ASSERT_TRUE(queue.peek(count - 1 - x));
+    EXPECT_FALSE(queue.peek(count - x));
+
+    auto element = queue.peek();
+    ASSERT_TRUE(element);
+    EXPECT_EQ(*element, x);
+    queue.pop();
+  }
+  EXPECT_FALSE(queue.peek());
+}
+
+TEST(SpscSpillQueueTest, KeepsOrderWhileSlotsFreeUp) {
+  safe::spsc_spill_queue_t<int> queue {2};
+
+  int next = 0;
+  auto push = [&]() {
+    *queue.back() = next++;
+    queue.push();
+  };
+
+  // Fill the slots and spill one, then free a slot while elements are still spilled
+  push();
+  push();
+  push();
+  EXPECT_EQ(*queue.peek(), 0);
+  queue.pop();
+  push();
+
+  // Then take them all and use the slots again
+  for (int x = 1; x < next; ++x) {
+    EXPECT_EQ(*queue.peek(next - 1 - x), next - 1);
+    EXPECT_EQ(*queue.peek(), x);
+    queue.pop();
+  }
+  push();
+  EXPECT_EQ(*queue.peek(), next - 1);
+  queue.pop();
+  EXPECT_FALSE(queue.peek());
+}
+
+TEST(SpscSpillQueueTest, HandsOverEveryElementAcrossThreads) {
+  constexpr int count = 100000;
+  safe::spsc_spill_queue_t<int> queue {16};
+
+  // The producer never waits, so elements spill whenever the consumer falls behind
+  std::thread producer {[&queue]() {
+    for (int x = 0; x < count; ++x) {
+      *queue.back() = x;
+      queue.push();
+    }
+  }};
+
+  int expected = 0;
+  while (expected < count) {
+    if (auto element = queue.peek()) {
+      ASSERT_EQ(*element, expected++);
+      queue.pop();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  producer.join();
+}
@@ -0,0 +1,102 @@
+/**
+ * @file tests/unit/test_thumbnail.cpp
+ * @brief Test src/thumbnail.*.
+ */
+#include "../tests_temp_dir.h"
+
+#include <filesystem>
+#include <fstream>
+#include <src/thumbnail.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+  class ThumbnailTest: public TempDirTest {
+  protected:
+    /**
+     * @brief Write the start of a PNG file, enough for its header to be read.
+     */
+    fs::path write_png(const std::string &name, std::uint32_t width, std::uint32_t height) {
+      auto path = dir / name;
+      std::ofstream out(path, std::ios::binary);
+
+      out.write("\x89PNG\r\n\x1a\n", 8);
+      out.write("\0\0\0\x0dIHDR", 8);
+      for (auto value : {width, height}) {
+        char be[] = {(char) (value >> 24), (char) (value >> 16), (char) (value >> 8), (char) value};
+        out.write(be, 4);
+      }
+
+      return path;
+    }
+  };
+}  // namespace
+
+TEST_F(ThumbnailTest, ReadsPngSize) {
+  auto size = thumbnail::png_size(write_png("cover.png", 1200, 1800));
+
+  ASSERT_TRUE(size);
+  EXPECT_EQ(size->first, 1200);
+  EXPECT_EQ(size->second, 1800);
+}
+
+TEST_F(ThumbnailTest, RejectsOtherFiles) {
+  auto path = dir / "cover.jpg";
+  std::ofstream(path, std::ios::binary) << "\xff\xd8\xff\xe0 not a png at all";
+
+  EXPECT_FALSE(thumbnail::png_size(path));
+  EXPECT_FALSE(thumbnail::png_size(dir / "missing.png"));
+}
+
+TEST(ThumbnailWidthTest, PicksSmallestVariantForHint) {
+  EXPECT_EQ(thumbnail::pick_width(std::nullopt), thumbnail::DEFAULT_WIDTH);
+  EXPECT_EQ(thumbnail::pick_width(100), 314);
+  EXPECT_EQ(thumbnail::pick_width(314), 314);
+  EXPECT_EQ(thumbnail::pick_width(315), 628);
+
+  // Larger than any variant, only the original will do
+  EXPECT_EQ(thumbnail::pick_width(2000), 0);
+}
+
+TEST_F(ThumbnailTest, StoresVariantsNextToImage) {
+  EXPECT_EQ(thumbnail::variant_path(dir / "igdb_1.png", 314), dir / "igdb_1.thumb314.png");
+}
+
+TEST_F(ThumbnailTest, ServesSmallImagesAsTheyAre) {
+  auto path = write_png("box.png", 130, 180);
+
+  EXPECT_EQ(thumbnail::select(path, std::nullopt), path);
+  EXPECT_EQ(thumbnail::select(path, 100), path);
+}
+
+#ifdef _WIN32
+TEST_F(ThumbnailTest, ServesCurrentVariant) {
+  auto path = write_png("cover.png", 1200, 1800);
+  auto variant = write_png("cover.thumb628.png", 628, 942);
+  fs::last_write_time(variant, fs::last_write_time(path));
+
+  EXPECT_EQ(thumbnail::select(path, std::nullopt), variant);
+
+  // Nothing was generated for other sizes yet
+  EXPECT_EQ(thumbnail::select(path, 300), path);
+  EXPECT_EQ(thumbnail::select(path, 1000), path);
+}
+
+TEST_F(ThumbnailTest, IgnoresStaleVariant) {
+  auto path = write_png("cover.png", 1200, 1800);
+  auto variant = write_png("cover.thumb628.png", 628, 942);
+  fs::last_write_time(variant, fs::last_write_time(path) - std::chrono::hours(1));
+
+  // The cover was replaced since the variant was generated
+  EXPECT_EQ(thumbnail::select(path, std::nullopt), path);
+}
+#else
+TEST_F(ThumbnailTest, ServesOriginalWithoutImageCodec) {
+  auto path = write_png("cover.png", 1200, 1800);
+  auto variant = write_png("cover.thumb628.png", 628, 942);
+  fs::last_write_time(variant, fs::last_write_time(path));
+
+  // Nothing can generate variants here, so they aren't even looked for
+  EXPECT_EQ(thumbnail::select(path, std::nullopt), path);
+}
+#endif
@@ -1,6 +1,7 @@
 import fs from 'fs';
 import { resolve } from 'path';
-import { defineConfig } from 'vite';
+import zlib from 'zlib';
+import { defineConfig, type Plugin } from 'vite';
 import vue from '@vitejs/plugin-vue';
 import { ViteEjsPlugin } from 'vite-plugin-ejs';
 
@@ -22,6 +23,45 @@ if (!process.env.SUNSHINE_BUILD_HOMEBREW) {
 
 const header = fs.readFileSync(resolve(assetsSrcPath, 'template_header.html'), 'utf-8');
 
+/**
+ * Write gzip and brotli variants next to the built files. Sunshine sends them to browsers that
+ * accept them, instead of the full files, without compressing anything at runtime.
+ */
+function precompress(): Plugin {
+  const compressible = /\.(html|js|css|json|svg|ico|txt)$/;
+
+  return {
+    name: 'sunshine-precompress',
+    apply: 'build',
+    writeBundle(options, bundle) {
+      if (!options.dir) return;
+
+      for (const fileName of Object.keys(bundle)) {
+        if (!compressible.test(fileName)) continue;
+
+        const file = resolve(options.dir, fileName);
+        const data = fs.readFileSync(file);
+        if (data.length < 1024) continue;
+
+        const variants: [string, Buffer][] = [
+          ['.gz', zlib.gzipSync(data, { level: 9 })],
+          [
+            '.br',
+            zlib.brotliCompressSync(data, {
+              params: { [zlib.constants.BROTLI_PARAM_QUALITY]: zlib.constants.BROTLI_MAX_QUALITY },
+            }),
+          ],
+        ];
+        for (const [extension, compressed] of variants) {
+          if (compressed.length < data.length) {
+            fs.writeFileSync(file + extension, compressed);
+          }
+        }
+      }
+    },
+  };
+}
+
 export default defineConfig(({ mode }) => {
   const isDebug = mode === 'debug';
 
@@ -40,7 +80,7 @@ export default defineConfig(({ mode }) => {
     resolve: {
       alias: { '@': resolve(assetsSrcPath) },
     },
-    plugins: [vue(), ViteEjsPlugin({ header })],
+    plugins: [vue(), ViteEjsPlugin({ header }), precompress()],
     css: {
       // Include CSS sources in sourcemaps during debug
       devSourcemap: isDebug,